@@ -0,0 +1,137 @@
+/* MIT License
+ *
+ * Copyright (c) 2018 Jean-Sebastien Fauteux, Michel Rioux, Raphaël Massabot
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "baseline.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+#include <vector>
+
+namespace {
+
+  const std::uint64_t FnvOffset = 14695981039346656037ull;
+  const std::uint64_t FnvPrime = 1099511628211ull;
+
+  void addByte(std::uint64_t& hash, unsigned char byte) {
+    hash ^= byte;
+    hash *= FnvPrime;
+  }
+
+  const std::string Magic = "SIFTBASELINE";
+
+}
+
+namespace Core {
+
+  std::uint64_t Baseline::hashText(const std::string& text) {
+    std::uint64_t hash = FnvOffset;
+    for(const auto c : text) {
+      if(c != ' ' && c != '\t' && c != '\r' && c != '\n') {
+        addByte(hash, static_cast<unsigned char>(c));
+      }
+    }
+    return hash;
+  }
+
+  std::uint64_t Baseline::fingerprint(std::uint64_t ruleType, std::uint64_t file, std::uint64_t scopeName, std::uint64_t line) {
+    std::uint64_t hash = FnvOffset;
+    for(const std::uint64_t value : {ruleType, file, scopeName, line}) {
+      for(unsigned int shift = 0; shift < 64; shift += 8) {
+        addByte(hash, static_cast<unsigned char>(value >> shift));
+      }
+    }
+    return hash;
+  }
+
+  bool Baseline::load(const std::string& filename) {
+    std::ifstream file(filename);
+    std::string magic;
+    std::uint32_t version = 0;
+    if(!(file >> magic >> version) || magic != Magic || version != Version) {
+      return false;
+    }
+
+    // A line that is not a fingerprint means the file was corrupted or hand edited, none of it is trusted
+    std::string fingerprint;
+    while(file >> fingerprint) {
+      char* end = nullptr;
+      errno = 0;
+      const unsigned long long value = std::strtoull(fingerprint.c_str(), &end, 16);
+      if(errno != 0 || end != fingerprint.c_str() + fingerprint.size() || fingerprint.front() == '-') {
+        m_fingerprints.clear();
+        return false;
+      }
+      m_fingerprints.insert(value);
+    }
+    return true;
+  }
+
+  bool Baseline::save(const std::string& filename) const {
+    std::vector<std::uint64_t> fingerprints(m_fingerprints.begin(), m_fingerprints.end());
+    std::sort(fingerprints.begin(), fingerprints.end());
+
+    std::ostringstream text;
+    text << Magic << " " << Version << "\n" << std::hex << std::setfill('0');
+    for(const auto fingerprint : fingerprints) {
+      text << std::setw(16) << fingerprint << "\n";
+    }
+
+    std::ofstream file(filename, std::ios::trunc);
+    file << text.str();
+    return static_cast<bool>(file);
+  }
+
+  bool Baseline::contains(std::uint64_t fingerprint) const {
+    if(m_fingerprints.count(fingerprint) == 0) {
+      return false;
+    }
+    m_matches.fetch_add(1, std::memory_order_relaxed);
+    return true;
+  }
+
+  BaselineFilter::BaselineFilter(const Baseline* baseline, const std::unordered_map<RuleId, std::uint64_t>& ruleTypes, const File& file)
+    : m_baseline(baseline)
+    , m_ruleTypes(ruleTypes)
+    , m_file(file)
+    , m_fileHash(Baseline::hashText(file.filename)) {}
+
+  std::uint64_t BaselineFilter::fingerprint(RuleId ruleId, const Message& message, const std::string* argument) const {
+    const auto ruleTypeIt = m_ruleTypes.find(ruleId);
+    const std::uint64_t ruleType = ruleTypeIt != m_ruleTypes.end() ? ruleTypeIt->second : static_cast<std::uint64_t>(ruleId);
+    const std::uint64_t scopeName = argument ? Baseline::hashText(*argument) : 0;
+    // Messages taken from a source line point at the offending line, the others at the start of their scope
+    const bool atScopeStart = argument || message.text == MessageText::SourceLines;
+    const std::size_t lineIndex = atScopeStart ? static_cast<std::size_t>(message.line) : message.sourceLine;
+    const std::uint64_t line = lineIndex < m_file.lines.size() ? Baseline::hashText(m_file.lines[lineIndex]) : 0;
+    return Baseline::fingerprint(ruleType, m_fileHash, scopeName, line);
+  }
+
+  bool BaselineFilter::isKnown(RuleId ruleId, const Message& message, const std::string* argument) const {
+    return m_baseline && m_baseline->contains(fingerprint(ruleId, message, argument));
+  }
+
+}
@@ -0,0 +1,82 @@
+/* MIT License
+ *
+ * Copyright (c) 2018 Jean-Sebastien Fauteux, Michel Rioux, Raphaël Massabot
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+
+#include "constants.hpp"
+#include "file.hpp"
+#include "message.hpp"
+
+namespace Core {
+
+  // Fingerprints of known violations. A fingerprint hashes the rule type, the file, the scope name
+  // the message carries and the content of the offending line, whitespace left out, but not the
+  // line number, so a violation keeps its fingerprint when the code around it moves.
+  // Stored as one hexadecimal fingerprint per line, sorted, after a version line.
+  class Baseline {
+  public:
+    static const std::uint32_t Version = 1; /* Bump whenever what goes into a fingerprint changes */
+
+    // FNV-1a of text without its whitespace
+    static std::uint64_t hashText(const std::string& text);
+    static std::uint64_t fingerprint(std::uint64_t ruleType, std::uint64_t file, std::uint64_t scopeName, std::uint64_t line);
+
+    // False when filename could not be read or is not a baseline
+    bool load(const std::string& filename);
+    bool save(const std::string& filename) const;
+
+    void add(std::uint64_t fingerprint) { m_fingerprints.insert(fingerprint); }
+    // Counts the matches, safe to call from any thread once loaded
+    bool contains(std::uint64_t fingerprint) const;
+    std::size_t size() const { return m_fingerprints.size(); }
+    std::size_t getMatchCount() const { return m_matches; }
+
+  private:
+    std::unordered_set<std::uint64_t> m_fingerprints;
+    mutable std::atomic<std::size_t> m_matches{0};
+  };
+
+  // Fingerprints the messages of one file, MessageStack drops the ones of its baseline as they are pushed
+  class BaselineFilter {
+  public:
+    // ruleTypes holds hashText of the type of every rule, baseline may be null to only fingerprint
+    BaselineFilter(const Baseline* baseline, const std::unordered_map<RuleId, std::uint64_t>& ruleTypes, const File& file);
+
+    // argument is the argument text of message, null for messages taken from the source
+    std::uint64_t fingerprint(RuleId ruleId, const Message& message, const std::string* argument) const;
+    bool isKnown(RuleId ruleId, const Message& message, const std::string* argument) const;
+
+  private:
+    const Baseline* m_baseline;
+    const std::unordered_map<RuleId, std::uint64_t>& m_ruleTypes;
+    const File& m_file;
+    std::uint64_t m_fileHash;
+  };
+
+}
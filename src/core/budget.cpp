@@ -0,0 +1,98 @@
+/* MIT License
+ *
+ * Copyright (c) 2018 Jean-Sebastien Fauteux, Michel Rioux, Raphaël Massabot
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "budget.hpp"
+
+#include "message_stack.hpp"
+
+namespace Core {
+
+  FileBudget::FileBudget(std::chrono::milliseconds time, std::size_t messages)
+  : m_time(time)
+  , m_maxMessages(messages) {
+  }
+
+  void FileBudget::start() {
+    std::call_once(m_started, [this]() {
+      m_deadline = std::chrono::steady_clock::now() + m_time;
+    });
+  }
+
+  void FileBudget::addMessages(std::size_t messages) {
+    m_messages += messages;
+  }
+
+  void FileBudget::check() {
+    if(m_exceeded) {
+      throw BudgetExceeded(m_reason);
+    }
+    if(m_maxMessages > 0 && m_messages > m_maxMessages) {
+      exceed("more than " + std::to_string(m_maxMessages) + " messages");
+    }
+    if(m_time.count() > 0 && std::chrono::steady_clock::now() > m_deadline) {
+      exceed("more than " + std::to_string(m_time.count()) + "ms");
+    }
+  }
+
+  void FileBudget::exceed(const std::string& reason) {
+    std::call_once(m_reasonSet, [this, &reason]() {
+      m_reason = reason;
+      m_exceeded = true;
+    });
+    throw BudgetExceeded(m_reason);
+  }
+
+  namespace Budgeting {
+
+    Guard::Guard(FileBudget* budget, const MessageStack* messageStack)
+    : m_budget(budget && budget->isLimited() ? budget : nullptr)
+    , m_messageStack(messageStack) {
+      if(m_budget) {
+        m_budget->start();
+        m_countedMessages = m_messageStack ? m_messageStack->countMessages() : 0;
+        m_previous = currentGuard();
+        currentGuard() = this;
+      }
+    }
+
+    Guard::~Guard() {
+      if(m_budget) {
+        currentGuard() = m_previous;
+      }
+    }
+
+    void Guard::check() {
+      if(!m_budget) {
+        return;
+      }
+      if(m_messageStack) {
+        const std::size_t messages = m_messageStack->countMessages();
+        m_budget->addMessages(messages - m_countedMessages);
+        m_countedMessages = messages;
+      }
+      m_budget->check();
+    }
+
+  }
+
+}
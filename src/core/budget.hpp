@@ -0,0 +1,120 @@
+/* MIT License
+ *
+ * Copyright (c) 2018 Jean-Sebastien Fauteux, Michel Rioux, Raphaël Massabot
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+
+namespace Core {
+
+  class MessageStack;
+
+  // Limits on the work spent on a single file, zero meaning unlimited
+  struct FileBudgetLimits {
+    std::chrono::milliseconds extractionTime{0};
+    std::chrono::milliseconds ruleTime{0};
+    std::size_t messages = 0;
+  };
+
+  // Thrown at a checkpoint once the budget of the file being worked on is spent
+  class BudgetExceeded : public std::runtime_error {
+  public:
+    using std::runtime_error::runtime_error;
+  };
+
+  // Time and messages left for one file, shared by every task working on it. The clock starts
+  // with the first task, so split files are held to the same deadline as the others.
+  class FileBudget {
+  public:
+    FileBudget(std::chrono::milliseconds time, std::size_t messages);
+
+    FileBudget(const FileBudget&) = delete;
+    FileBudget& operator=(const FileBudget&) = delete;
+
+    bool isLimited() const { return m_time.count() > 0 || m_maxMessages > 0; }
+    void start();
+    void addMessages(std::size_t messages);
+    // Throws BudgetExceeded when the file ran out of time or messages, or another task already found it did
+    void check();
+
+    bool isExceeded() const { return m_exceeded; }
+    // Why the budget ran out, only valid once isExceeded
+    const std::string& getReason() const { return m_reason; }
+
+  private:
+    [[noreturn]] void exceed(const std::string& reason);
+
+    std::chrono::milliseconds m_time;
+    std::size_t m_maxMessages;
+    std::once_flag m_started;
+    std::chrono::steady_clock::time_point m_deadline;
+    std::atomic<std::size_t> m_messages{0};
+    std::atomic<bool> m_exceeded{false};
+    std::once_flag m_reasonSet;
+    std::string m_reason;
+  };
+
+  namespace Budgeting {
+
+    class Guard;
+
+    // Guard of the code running on this thread, null while nothing is budgeted
+    inline Guard*& currentGuard() {
+      static thread_local Guard* guard = nullptr;
+      return guard;
+    }
+
+    // Charges the work of this thread to budget until it goes out of scope. Messages pushed to
+    // messageStack in the meantime count against the budget. Does nothing for a null budget.
+    class Guard {
+    public:
+      Guard(FileBudget* budget, const MessageStack* messageStack = nullptr);
+      ~Guard();
+
+      Guard(const Guard&) = delete;
+      Guard& operator=(const Guard&) = delete;
+
+      void check();
+
+    private:
+      FileBudget* m_budget;
+      const MessageStack* m_messageStack;
+      std::size_t m_countedMessages = 0;
+      Guard* m_previous = nullptr;
+    };
+
+    // Cooperative abort point, cheap when nothing is budgeted
+    inline void checkpoint() {
+      if(Guard* guard = currentGuard()) {
+        guard->check();
+      }
+    }
+
+  }
+
+}
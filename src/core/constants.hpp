@@ -24,4 +24,6 @@
 #pragma once
 
 const unsigned int BRACKET_STACK_GIVEUP = 5000; /* If we have 5000+ brackets on the stack, chances are we're in trouble */
+const unsigned int RULE_TASK_SPLIT_LINES = 2000; /* Files this long get one rule application task per rule */
+const unsigned int PROFILE_TOP_COUNT = 10; /* Slowest files and rules listed by the profile report */
 using RuleId = long long int;
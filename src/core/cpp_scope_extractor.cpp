@@ -25,9 +25,12 @@
 #include <stack>
 #include <muflihun/easylogging++.h>
 
+#include "budget.hpp"
 #include "constants.hpp"
 #include "cpp_scope_extractor.hpp"
+#include "profiler.hpp"
 #include "scope.hpp"
+#include "scope_index.hpp"
 
 namespace Core {
 
@@ -68,7 +71,11 @@ namespace Core {
       //This allows us to not have much recursion and handle pretty much all edge case of scope within scopes.
       extractDefines(file, rootScope);
       
-      m_defineScopes[file.filename] = rootScope.getAllChildrenOfType(Core::ScopeType::GlobalDefine);
+      auto& defineScopes = getFileScopes(m_defineScopes, file.filename);
+      defineScopes.clear();
+      rootScope.forEachChildOfType(Core::ScopeType::GlobalDefine, [&defineScopes](const Scope& define) {
+        defineScopes.push_back(define.clone());
+      });
       
       extractNamespaces(file, rootScope);
       extractEnums(file, rootScope);
@@ -92,7 +99,7 @@ namespace Core {
 
       LOG(TRACE) << "\n" << rootScope.getTree();
 
-      outScope = rootScope;
+      outScope = std::move(rootScope);
     }catch(std::overflow_error& e){
       LOG(ERROR) << e.what();
       return false;
@@ -110,7 +117,7 @@ namespace Core {
         // Should match "     #define" and "   /* some comment */   #define"
         std::regex defineRegex(R"(^(\s*|\s*\/\*.*\*\/\s*)(#define))");
         std::smatch sm;
-        std::regex_search(line, sm, defineRegex);
+        Core::regexSearch(line, sm, defineRegex);
         if(sm.size() > 0) {
           scope = Scope(ScopeType::GlobalDefine);
           scope.lineNumberStart = lineNo;
@@ -135,15 +142,15 @@ namespace Core {
             scope.lineNumberEnd = lineNo;
             scope.name = line;
 
-            parent.children.push_back(scope);
+            parent.children.push_back(std::move(scope));
           }
         }
       } else if(isStillInDefine) {
         if(line.find("\\") == std::string::npos) {
           scope.characterNumberEnd = line.size();
           scope.lineNumberEnd = lineNo;
-          scope.name = scope.getScopeLines().at(0);
-          parent.children.push_back(scope);
+          scope.name = scope.getScopeLines().at(0).str();
+          parent.children.push_back(std::move(scope));
           isStillInDefine = false;
         }
       }
@@ -159,7 +166,7 @@ namespace Core {
     for(unsigned int lineNumber = parent.lineNumberStart; lineNumber < parent.lineNumberEnd; ++lineNumber) {
       const std::string& line = file.lines[lineNumber];
       std::smatch match;
-      std::regex_match(line, match, namespaceRegex);
+      Core::regexMatch(line, match, namespaceRegex);
       if(match.size() > 0) {
         Scope scope(ScopeType::Namespace);
         scope.name = match[1];
@@ -178,7 +185,7 @@ namespace Core {
         extractEnums(file, scope);*/
 
         //Adding to parent the scope
-        parent.children.push_back(scope);
+        parent.children.push_back(std::move(scope));
       }
     }
   }
@@ -188,7 +195,7 @@ namespace Core {
     for(unsigned int lineNumber = parent.lineNumberStart; lineNumber < parent.lineNumberEnd; ++lineNumber) {
       const std::string& line = file.lines[lineNumber];
       std::smatch match;
-      std::regex_match(line, match, enumRegex);
+      Core::regexMatch(line, match, enumRegex);
 
       if(match.size() > 0) {
         Scope scope(ScopeType::Enum);
@@ -203,7 +210,7 @@ namespace Core {
 
         LOG(DEBUG) << "\n" << scope;
 
-        parent.children.push_back(scope);
+        parent.children.push_back(std::move(scope));
       }
     }
   }
@@ -213,7 +220,7 @@ namespace Core {
     for(unsigned int lineNumber = parent.lineNumberStart; lineNumber < parent.lineNumberEnd; ++lineNumber) {
       const std::string& line = file.lines[lineNumber];
       std::smatch match;
-      std::regex_match(line, match, classRegex);
+      Core::regexMatch(line, match, classRegex);
       if(match.size() > 0) {
         Scope scope(ScopeType::Class);
         scope.name = match[2];
@@ -227,7 +234,7 @@ namespace Core {
 
         LOG(DEBUG) << "\n" << scope;
 
-        parent.children.push_back(scope);
+        parent.children.push_back(std::move(scope));
       }
     }
   }
@@ -238,7 +245,7 @@ namespace Core {
     for(unsigned int lineNumber = parent.lineNumberStart; lineNumber < parent.lineNumberEnd; ++lineNumber) {
       const std::string& line = file.lines[lineNumber];
       std::smatch match;
-      std::regex_match(line, match, functionRegex);
+      Core::regexMatch(line, match, functionRegex);
       if(match.size() > 0) {
         if(isLineWithinDefine(file.filename, lineNumber)){
           break;
@@ -273,7 +280,7 @@ namespace Core {
 
         LOG(DEBUG) << "\n" << scope;
 
-        parent.children.push_back(scope);
+        parent.children.push_back(std::move(scope));
       }
     }
     
@@ -285,7 +292,7 @@ namespace Core {
     for(unsigned int lineNumber = parent.lineNumberStart; lineNumber < parent.lineNumberEnd; ++lineNumber) {
       const std::string& line = file.lines[lineNumber];
       std::smatch match;
-      std::regex_match(line, match, variableRegex);
+      Core::regexMatch(line, match, variableRegex);
       if(match.size() > 0) {
         if(isLineWithinDefine(file.filename, lineNumber)){
           break;
@@ -303,7 +310,7 @@ namespace Core {
         LOG(DEBUG) << "\n" << scope;
 
         //Adding to parent the scope
-        parent.children.push_back(scope);
+        parent.children.push_back(std::move(scope));
       }
     }
   }
@@ -313,7 +320,7 @@ namespace Core {
     for(unsigned int i = parent.lineNumberStart; i < parent.lineNumberEnd; ++i) {
       const std::string& line = file.lines[i];
       std::smatch match;
-      std::regex_search(line, match, conditionalRegex);
+      Core::regexSearch(line, match, conditionalRegex);
       if(match.size() > 0) {
         if(isLineWithinDefine(file.filename, i) || isWithinStringLiteral(line.find(match[0]), i, file) || isWithinComment(line.find(match[0]), i, file, parent)) {
           continue;
@@ -342,7 +349,7 @@ namespace Core {
         LOG(DEBUG) << "\n" << scope;
 
         //Adding to parent the scope
-        parent.children.push_back(scope);
+        parent.children.push_back(std::move(scope));
       }
     }
   }
@@ -356,7 +363,7 @@ namespace Core {
       if(line.empty()) {
         continue;
       }
-      if(std::regex_search(line, match, multiLineComments)) {
+      if(Core::regexSearch(line, match, multiLineComments)) {
         Scope scope(ScopeType::MultiLineComment);
         scope.parent = &parent;
         scope.lineNumberStart = lineNumber;
@@ -378,9 +385,9 @@ namespace Core {
 
         LOG(DEBUG) << "\n" << scope;
 
-        parent.children.push_back(scope);
-        m_comments[file.filename].push_back(scope); //TODO maybe remove comments from other scope containers
-      } else if(std::regex_match(line, match, singleLineComments)) {
+        getFileScopes(m_comments, file.filename).push_back(scope.clone()); //TODO maybe remove comments from other scope containers
+        parent.children.push_back(std::move(scope));
+      } else if(Core::regexMatch(line, match, singleLineComments)) {
         Scope scope(ScopeType::SingleLineComment);
         scope.name = match[1];
         scope.parent = &parent;
@@ -392,8 +399,8 @@ namespace Core {
 
         LOG(DEBUG) << "\n" << scope;
 
-        parent.children.push_back(scope);
-        m_comments[file.filename].push_back(scope);
+        getFileScopes(m_comments, file.filename).push_back(scope.clone());
+        parent.children.push_back(std::move(scope));
       }
     }
   }
@@ -448,7 +455,7 @@ namespace Core {
         startIndex = 0;
       }
 
-      m_stringLiterals[file.filename].push_back(scope);   
+      getFileScopes(m_stringLiterals, file.filename).push_back(std::move(scope));   
     }
 
     startIndex = 0;
@@ -502,32 +509,42 @@ namespace Core {
         startIndex = 0;
       }
 
-      m_stringLiterals[file.filename].push_back(scope);
+      getFileScopes(m_stringLiterals, file.filename).push_back(std::move(scope));
     }
   }
 
   void CppScopeExtractor::filterScopes(Scope& root) {
-    
-    auto childrenCopy = root.children;
-    root.children.erase(std::remove_if(root.children.begin(), root.children.end(), [&childrenCopy](const Scope& scope) {
-      for(auto& it : childrenCopy) {
+    //Deciding first which scopes go away, so every scope is compared against the unfiltered list
+    std::vector<bool> isFiltered(root.children.size(), false);
+    for(unsigned int i = 0; i < root.children.size(); ++i) {
+      const Scope& scope = root.children[i];
+      for(const auto& it : root.children) {
         if(it == scope) {
           continue;
         }
 
         //Filtering comments
         if(scope.isWithinOtherScope(it) && it.isOfType(ScopeType::Comment)) {
-          return true;
+          isFiltered[i] = true;
+          break;
         } else if(scope.isOfType(ScopeType::Function) && scope.isWithinOtherScope(it) && (it.isOfType(ScopeType::Function) || it.isOfType(ScopeType::Conditional))) {
           //Filtering function call within a function
-          return true;
+          isFiltered[i] = true;
+          break;
         }
-        
-
       }
+    }
 
-      return false;
-    }), root.children.end());
+    unsigned int kept = 0;
+    for(unsigned int i = 0; i < root.children.size(); ++i) {
+      if(!isFiltered[i]) {
+        if(kept != i) {
+          root.children[kept] = std::move(root.children[i]);
+        }
+        ++kept;
+      }
+    }
+    root.children.erase(root.children.begin() + kept, root.children.end());
   }
 
   void CppScopeExtractor::constructTree(Scope& root) {
@@ -569,6 +586,8 @@ namespace Core {
         }
       }
     }
+
+    root.typeIndex = std::make_unique<ScopeIndex>(root);
   }
 
   Scope& CppScopeExtractor::findBestParent(Scope& root, Scope& toSearch) {
@@ -629,6 +648,7 @@ namespace Core {
     int scopeLineNumber = startingLine;
     
     for(unsigned int j = startingLine; j < file.lines.size(); ++j) {
+      Budgeting::checkpoint(); // Bracket matching can run away on broken files
       scopeLineNumber = j;
       const std::string& namespaceLine = file.lines[j];
       for(unsigned int pos = 0; pos < namespaceLine.size(); ++pos) {
@@ -665,6 +685,7 @@ namespace Core {
     int startingCharForThisLine = startingCharacter;
 
     for(unsigned int j = startingLine; j < file.lines.size(); ++j) {
+      Budgeting::checkpoint();
       scopeLineNumber = j;
       const std::string& namespaceLine = file.lines[j];
       for(unsigned int pos = startingCharForThisLine; pos < namespaceLine.size(); ++pos) {
@@ -708,6 +729,7 @@ namespace Core {
     std::stack<char> ParenthesisStack;
 
     for(unsigned int j = startingLine; j < file.lines.size(); ++j) {
+      Budgeting::checkpoint();
       const std::string& namespaceLine = file.lines[j];
       for(unsigned int pos = startingCharForThisLine; pos < namespaceLine.size(); ++pos) {
         const char& c = namespaceLine[pos];
@@ -744,7 +766,7 @@ namespace Core {
     for(unsigned int i = startingLine; i < file.lines.size(); ++i) {
       const std::string& line = file.lines[i];
       std::smatch match;
-      std::regex_search(line, match, conditionalRegex);
+      Core::regexSearch(line, match, conditionalRegex);
       if(match.size() > 0) {
         if(match[1] == "do") {
           counter++;
@@ -774,6 +796,7 @@ namespace Core {
     bool foundCondition = false;
     std::stack<char> ParenthesisStack;
     for(unsigned int j = startingLine; j < file.lines.size(); ++j) {
+      Budgeting::checkpoint();
       const std::string& namespaceLine = file.lines[j];
       for(unsigned int pos = startingCharForThisLine; pos < namespaceLine.size(); ++pos) {
         const char& c = namespaceLine[pos];
@@ -811,7 +834,11 @@ namespace Core {
   }
 
   bool CppScopeExtractor::isLineWithinDefine(const std::string& filename, int lineNumber){
-    for(const auto& scope : m_defineScopes[filename]){
+    auto it = m_defineScopes.find(filename);
+    if(it == m_defineScopes.end()) {
+      return false;
+    }
+    for(const auto& scope : it->second){
       if(scope.isLineWithinScope(lineNumber)){
         return true;
       }
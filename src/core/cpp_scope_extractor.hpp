@@ -60,7 +60,6 @@ namespace Core {
     bool isLineWithinDefine(const std::string& filename, int line);
 
     static const std::vector<std::string> ReservedKeywords;
-    std::map<std::string, std::vector<Core::Scope>> m_defineScopes;
   };
 
 }
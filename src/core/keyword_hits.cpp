@@ -0,0 +1,94 @@
+/* MIT License
+ *
+ * Copyright (c) 2018 Jean-Sebastien Fauteux, Michel Rioux, Raphaël Massabot
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "keyword_hits.hpp"
+
+#include <algorithm>
+#include <iterator>
+#include <string>
+
+#include "literal_automaton.hpp"
+
+namespace Core {
+
+  namespace {
+
+    const char* const KeywordTexts[KeywordCount] = {
+      "goto",
+      "const_cast",
+      "auto",
+      "#define",
+      "#include"
+    };
+
+    const LiteralAutomaton& getAutomaton() {
+      static const LiteralAutomaton automaton(std::vector<std::string>(std::begin(KeywordTexts), std::end(KeywordTexts)));
+      return automaton;
+    }
+
+  }
+
+  const char* getKeywordText(Keyword keyword) {
+    return keyword == Keyword::None ? "" : KeywordTexts[static_cast<std::size_t>(keyword)];
+  }
+
+  KeywordHits::KeywordHits(const File& file) {
+    const LiteralAutomaton& automaton = getAutomaton();
+
+    for(unsigned int line = 0; line < file.lines.size(); ++line) {
+      // Keywords do not span lines
+      LiteralAutomaton::State state = 0;
+      unsigned int found = 0;
+      for(const char c : file.lines[line]) {
+        state = automaton.next(state, static_cast<unsigned char>(c));
+        if(automaton.hasOutputs(state)) {
+          for(auto keyword = automaton.beginOutputs(state); keyword != automaton.endOutputs(state); ++keyword) {
+            found |= 1u << *keyword;
+          }
+        }
+      }
+
+      for(std::size_t keyword = 0; found != 0; ++keyword, found >>= 1) {
+        if((found & 1u) != 0) {
+          m_lines[keyword].push_back(line);
+        }
+      }
+    }
+  }
+
+  bool KeywordHits::has(Keyword keyword) const {
+    return keyword == Keyword::None || !m_lines[static_cast<std::size_t>(keyword)].empty();
+  }
+
+  const std::vector<unsigned int>& KeywordHits::getLines(Keyword keyword) const {
+    static const std::vector<unsigned int> noLines;
+    return keyword == Keyword::None ? noLines : m_lines[static_cast<std::size_t>(keyword)];
+  }
+
+  KeywordHits::LineRange KeywordHits::getLines(Keyword keyword, unsigned int first, unsigned int last) const {
+    const auto& lines = getLines(keyword);
+    const auto begin = std::lower_bound(lines.begin(), lines.end(), first);
+    return LineRange(begin, std::upper_bound(begin, lines.end(), last));
+  }
+
+}
@@ -0,0 +1,70 @@
+/* MIT License
+ *
+ * Copyright (c) 2018 Jean-Sebastien Fauteux, Michel Rioux, Raphaël Massabot
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+#include "file.hpp"
+
+namespace Core {
+
+  // Rare words some rules are looking for, a file without them has nothing to report for those rules
+  enum class Keyword : unsigned int {
+    Goto = 0,
+    ConstCast,
+    Auto,
+    Define,
+    Include,
+    None
+  };
+
+  const std::size_t KeywordCount = static_cast<std::size_t>(Keyword::None);
+
+  const char* getKeywordText(Keyword keyword);
+
+  // Lines of a file holding each keyword, found by a single Aho-Corasick pass over the file.
+  // Keywords are matched as plain text, anywhere in a line, so rules still have to check what they find.
+  class KeywordHits {
+  public:
+    using LineIterator = std::vector<unsigned int>::const_iterator;
+    using LineRange = std::pair<LineIterator, LineIterator>;
+
+    KeywordHits() { }
+    explicit KeywordHits(const File& file);
+
+    // Always true for Keyword::None
+    bool has(Keyword keyword) const;
+    // Ascending, a line appears once even when it holds the keyword several times
+    const std::vector<unsigned int>& getLines(Keyword keyword) const;
+    // Lines between first and last, both included
+    LineRange getLines(Keyword keyword, unsigned int first, unsigned int last) const;
+
+  private:
+    std::array<std::vector<unsigned int>, KeywordCount> m_lines;
+  };
+
+}
@@ -0,0 +1,175 @@
+/* MIT License
+ *
+ * Copyright (c) 2018 Jean-Sebastien Fauteux, Michel Rioux, Raphaël Massabot
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <algorithm>
+#include <cctype>
+
+#include "line_table.hpp"
+
+namespace Core {
+
+  namespace {
+
+    LineInfo describeLine(const std::string& line) {
+      LineInfo info;
+      const char* data = line.data();
+      const unsigned int length = line.size();
+      info.length = length;
+
+      unsigned int position = 0;
+      while(position < length && data[position] == '\t') {
+        ++position;
+      }
+      info.leadingTabs = position;
+
+      bool hasTabs = position > 0;
+      bool hasSpaces = false;
+      while(position < length && (data[position] == ' ' || data[position] == '\t')) {
+        hasTabs |= data[position] == '\t';
+        hasSpaces |= data[position] == ' ';
+        ++position;
+      }
+      info.indentWidth = position;
+      if(hasTabs && hasSpaces) {
+        info.indentation = LineInfo::Indentation::Mixed;
+      } else if(hasTabs) {
+        info.indentation = LineInfo::Indentation::Tabs;
+      } else if(hasSpaces) {
+        info.indentation = LineInfo::Indentation::Spaces;
+      }
+
+      while(position < length && std::isspace(static_cast<unsigned char>(data[position]))) {
+        ++position;
+      }
+      info.firstNonSpace = position;
+
+      if(position == length) {
+        info.flags |= LineInfo::Blank;
+      } else if(data[position] == '#') {
+        info.flags |= LineInfo::Preprocessor;
+      } else if(data[position] == '/' && position + 1 < length && (data[position+1] == '/' || data[position+1] == '*')) {
+        info.flags |= LineInfo::CommentOnly;
+      }
+
+      // Branch free sweep over the bytes, simple enough for the compiler to vectorize
+      unsigned int openBraces = 0, closeBraces = 0, terminators = 0;
+      for(unsigned int i = 0; i < length; ++i) {
+        const char c = data[i];
+        openBraces += c == '{';
+        closeBraces += c == '}';
+        terminators += (c == '\r') | (c == '\n');
+      }
+      info.flags |= (openBraces ? LineInfo::OpenBrace : 0u)
+        | (closeBraces ? LineInfo::CloseBrace : 0u)
+        | (terminators ? LineInfo::LineTerminator : 0u);
+
+      return info;
+    }
+
+  }
+
+  LineTable::LineTable(const File& file, const Scope& rootScope)
+    : m_file(file)
+    , m_rootScope(rootScope)
+    , m_comments(rootScope.getAllChildrenOfType(ScopeType::Comment))
+  {
+    m_lines.reserve(file.lines.size());
+    for(const auto& line : file.lines) {
+      m_lines.push_back(describeLine(line));
+    }
+
+    indexComments();
+  }
+
+  void LineTable::indexComments() {
+    const unsigned int lineCount = m_lines.size();
+    m_commentOffsets.assign(lineCount + 1, 0);
+    if(lineCount == 0) {
+      return;
+    }
+
+    auto coveredLines = [lineCount](const Scope& comment, unsigned int& first, unsigned int& last) {
+      first = comment.lineNumberStart;
+      last = std::min(comment.lineNumberEnd, lineCount - 1);
+      return first <= last;
+    };
+
+    unsigned int first = 0, last = 0;
+    for(const Scope& comment : m_comments) {
+      if(coveredLines(comment, first, last)) {
+        for(unsigned int line = first; line <= last; ++line) {
+          ++m_commentOffsets[line + 1];
+        }
+      }
+    }
+    for(unsigned int line = 0; line < lineCount; ++line) {
+      m_commentOffsets[line + 1] += m_commentOffsets[line];
+      if(m_commentOffsets[line + 1] != m_commentOffsets[line]) {
+        m_lines[line].flags |= LineInfo::WithinComment;
+      }
+    }
+
+    m_commentsByLine.resize(m_commentOffsets[lineCount]);
+    std::vector<unsigned int> filled(m_commentOffsets.begin(), m_commentOffsets.end() - 1);
+    for(unsigned int i = 0; i < m_comments.size(); ++i) {
+      if(coveredLines(m_comments[i], first, last)) {
+        for(unsigned int line = first; line <= last; ++line) {
+          m_commentsByLine[filled[line]++] = i;
+        }
+      }
+    }
+  }
+
+  std::size_t LineTable::findFirstCommentHolding(const Scope& scope) const {
+    std::size_t first = m_comments.size();
+    if(scope.lineNumberStart >= m_lines.size()) {
+      return first;
+    }
+
+    // A comment holding the scope covers its first line, and the ones of a line are in tree order
+    for(unsigned int i = m_commentOffsets[scope.lineNumberStart]; i < m_commentOffsets[scope.lineNumberStart + 1]; ++i) {
+      const unsigned int position = m_commentsByLine[i];
+      if(scope.isWithinOtherScope(m_comments[position])) {
+        return position;
+      }
+    }
+
+    return first;
+  }
+
+  std::size_t LineTable::countCommentsHolding(const Scope& scope) const {
+    std::size_t count = 0;
+    if(scope.lineNumberStart >= m_lines.size()) {
+      return count;
+    }
+
+    for(unsigned int i = m_commentOffsets[scope.lineNumberStart]; i < m_commentOffsets[scope.lineNumberStart + 1]; ++i) {
+      if(scope.isWithinOtherScope(m_comments[m_commentsByLine[i]])) {
+        ++count;
+      }
+    }
+
+    return count;
+  }
+
+}
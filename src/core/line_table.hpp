@@ -0,0 +1,91 @@
+/* MIT License
+ *
+ * Copyright (c) 2018 Jean-Sebastien Fauteux, Michel Rioux, Raphaël Massabot
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+#include "file.hpp"
+#include "scope.hpp"
+
+namespace Core {
+
+  struct LineInfo {
+    enum Flag : unsigned int {
+      Blank = 1u << 0,             /* Only whitespace */
+      CommentOnly = 1u << 1,       /* First non whitespace characters open a comment */
+      Preprocessor = 1u << 2,      /* First non whitespace character is # */
+      OpenBrace = 1u << 3,
+      CloseBrace = 1u << 4,
+      WithinComment = 1u << 5,     /* Covered, even partly, by a comment scope */
+      LineTerminator = 1u << 6     /* Holds a stray \r or \n, which regex . does not match */
+    };
+
+    enum class Indentation : unsigned char {
+      None,
+      Tabs,
+      Spaces,
+      Mixed
+    };
+
+    unsigned int length = 0;
+    unsigned int indentWidth = 0;    // Leading spaces and tabs
+    unsigned int leadingTabs = 0;    // Tabs before any other character
+    unsigned int firstNonSpace = 0;  // Equal to length on blank lines
+    Indentation indentation = Indentation::None;
+    unsigned int flags = 0;
+
+    bool has(Flag flag) const { return (flags & flag) != 0; }
+  };
+
+  // Metadata of every line of a file, computed in a single pass so line based rules don't each rescan the text.
+  // Also indexes the comment scopes of the tree by the lines they cover.
+  class LineTable {
+  public:
+    LineTable(const File& file, const Scope& rootScope);
+
+    std::size_t size() const { return m_lines.size(); }
+    const LineInfo& operator[](std::size_t line) const { return m_lines[line]; }
+    const File& getFile() const { return m_file; }
+    const Scope& getRootScope() const { return m_rootScope; }
+
+    // Comments of the tree in depth first order, as getAllChildrenOfType(ScopeType::Comment) gives them
+    const ScopeRefVector& getComments() const { return m_comments; }
+    // Position in getComments() of the first comment holding the scope, getComments().size() when none does
+    std::size_t findFirstCommentHolding(const Scope& scope) const;
+    std::size_t countCommentsHolding(const Scope& scope) const;
+
+  private:
+    void indexComments();
+
+    const File& m_file;
+    const Scope& m_rootScope;
+    std::vector<LineInfo> m_lines;
+    ScopeRefVector m_comments;
+    // Comments covering line i are m_commentsByLine[m_commentOffsets[i]] up to m_commentsByLine[m_commentOffsets[i+1]]
+    std::vector<unsigned int> m_commentOffsets;
+    std::vector<unsigned int> m_commentsByLine;
+  };
+
+}
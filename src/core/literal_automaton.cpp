@@ -0,0 +1,97 @@
+/* MIT License
+ *
+ * Copyright (c) 2018 Jean-Sebastien Fauteux, Michel Rioux, Raphaël Massabot
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "literal_automaton.hpp"
+
+#include <algorithm>
+#include <queue>
+
+namespace Core {
+
+  LiteralAutomaton::LiteralAutomaton()
+  : LiteralAutomaton(std::vector<std::string>()) {
+  }
+
+  LiteralAutomaton::LiteralAutomaton(const std::vector<std::string>& literals)
+  : m_added(literals.size(), false) {
+    m_transitions.emplace_back();
+    m_transitions[0].fill(0);
+    std::vector<std::vector<std::size_t>> outputs(1);
+
+    // Trie of the literals
+    for(std::size_t literal = 0; literal < literals.size(); ++literal) {
+      const std::string& text = literals[literal];
+      if(text.empty() || m_transitions.size() + text.size() > MaxStates) {
+        continue;
+      }
+
+      State state = 0;
+      for(const char c : text) {
+        const unsigned char character = static_cast<unsigned char>(c);
+        if(m_transitions[state][character] == 0) {
+          m_transitions[state][character] = static_cast<State>(m_transitions.size());
+          m_transitions.emplace_back();
+          m_transitions.back().fill(0);
+          outputs.emplace_back();
+        }
+        state = m_transitions[state][character];
+      }
+      outputs[state].push_back(literal);
+      m_added[literal] = true;
+    }
+
+    // Breadth first so the failure state of a state is complete before it is used
+    std::vector<State> failures(m_transitions.size(), 0);
+    std::queue<State> pending;
+    for(unsigned int character = 0; character < 256; ++character) {
+      if(m_transitions[0][character] != 0) {
+        pending.push(m_transitions[0][character]);
+      }
+    }
+    while(!pending.empty()) {
+      const State state = pending.front();
+      pending.pop();
+      const auto& inherited = outputs[failures[state]];
+      outputs[state].insert(outputs[state].end(), inherited.begin(), inherited.end());
+      std::sort(outputs[state].begin(), outputs[state].end());
+      for(unsigned int character = 0; character < 256; ++character) {
+        const State next = m_transitions[state][character];
+        if(next != 0) {
+          failures[next] = m_transitions[failures[state]][character];
+          pending.push(next);
+        } else {
+          m_transitions[state][character] = m_transitions[failures[state]][character];
+        }
+      }
+    }
+
+    // Flattened so looking up the outputs of a state does not chase a pointer per state
+    m_outputOffsets.reserve(outputs.size() + 1);
+    for(const auto& stateOutputs : outputs) {
+      m_outputOffsets.push_back(m_outputs.size());
+      m_outputs.insert(m_outputs.end(), stateOutputs.begin(), stateOutputs.end());
+    }
+    m_outputOffsets.push_back(m_outputs.size());
+  }
+
+}
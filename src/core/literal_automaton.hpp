@@ -0,0 +1,59 @@
+/* MIT License
+ *
+ * Copyright (c) 2018 Jean-Sebastien Fauteux, Michel Rioux, Raphaël Massabot
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace Core {
+
+  // Aho-Corasick automaton over a set of literals. Failure links are folded into the transitions so a character
+  // is a single lookup, and every state knows all the literals ending at it.
+  class LiteralAutomaton {
+  public:
+    using State = std::uint16_t;
+    static const std::size_t MaxStates = 65536;
+
+    LiteralAutomaton();
+    // Literals that would take the automaton past MaxStates are left out, see isAdded
+    explicit LiteralAutomaton(const std::vector<std::string>& literals);
+
+    State next(State state, unsigned char character) const { return m_transitions[state][character]; }
+    bool hasOutputs(State state) const { return m_outputOffsets[state] != m_outputOffsets[state + 1]; }
+    // Indexes of the literals ending at the state, ascending
+    const std::size_t* beginOutputs(State state) const { return m_outputs.data() + m_outputOffsets[state]; }
+    const std::size_t* endOutputs(State state) const { return m_outputs.data() + m_outputOffsets[state + 1]; }
+    bool isAdded(std::size_t literal) const { return m_added[literal]; }
+
+  private:
+    std::vector<std::array<State, 256>> m_transitions;
+    std::vector<std::size_t> m_outputs;
+    std::vector<std::size_t> m_outputOffsets;
+    std::vector<bool> m_added;
+  };
+
+}
@@ -23,6 +23,8 @@
 
 #pragma once
 
+#include <cstdint>
+#include <limits>
 #include <string>
 #include <rosme/smartenum.hpp>
 
@@ -33,23 +35,72 @@ namespace Core {
                    Error,
                    Unknown);
 
+  // How the text of a message is made, it is only rendered when the message is written
+  enum class MessageText : std::uint8_t {
+    // The argument as is
+    Argument,
+    // length characters of the source line from column
+    Source,
+    // Same as Source, followed by a line break
+    SourceLineBreak,
+    // The source lines from line to sourceLine, each followed by a tab:
+    // the first from column, the last up to length characters
+    SourceLines,
+    // "<argument> expected - got: <length>"
+    ExpectedLength,
+    // "<argument> - Got: <size of the argument>"
+    ArgumentLength,
+    // "<argument> will throw a NULL pointer exception"
+    NullPointer,
+    // "<argument> is used before initialization"
+    UsedBeforeInitialization
+  };
+
+  inline bool usesArgument(MessageText text) {
+    return text != MessageText::Source && text != MessageText::SourceLineBreak && text != MessageText::SourceLines;
+  }
+
+  // Fixed size record, the MessageStack holding it renders its text from the source of the file
+  // or from the template of its MessageText
   struct Message {
-    Message(MessageType type = MessageType::Unknown, const std::string& content = "", const int line = 0, const int character = 0)
+    // Source texts up to the end of the line
+    static const std::uint32_t ToEndOfLine = std::numeric_limits<std::uint32_t>::max();
+
+    Message(MessageType type = MessageType::Unknown, MessageText text = MessageText::Argument, const int line = 0, const int character = 0)
       : type(type)
-      , content(content)
+      , text(text)
       , line(line)
       , character(character) {}
+
+    static Message fromSource(MessageType type, const int line, const int character, std::uint32_t sourceLine,
+                              std::uint32_t column = 0, std::uint32_t length = ToEndOfLine, bool lineBreak = false) {
+      Message message(type, lineBreak ? MessageText::SourceLineBreak : MessageText::Source, line, character);
+      message.sourceLine = sourceLine;
+      message.column = column;
+      message.length = length;
+      return message;
+    }
+
+    static Message fromSourceLines(MessageType type, const int line, const int character, std::uint32_t lastLine,
+                                   std::uint32_t lastLength = ToEndOfLine) {
+      Message message(type, MessageText::SourceLines, line, character);
+      message.sourceLine = lastLine;
+      message.column = character;
+      message.length = lastLength;
+      return message;
+    }
+
     MessageType type;
-    std::string content;
+    MessageText text;
     int line;
     int character;
+    // Where Source texts are taken from
+    std::uint32_t sourceLine = 0;
+    std::uint32_t column = 0;
+    // Characters taken from the source, or the length an ExpectedLength got
+    std::uint32_t length = 0;
+    // Index of the argument in the stack holding the message
+    std::uint32_t argument = 0;
   };
 
-  inline std::ostream& operator<<(std::ostream& out, const Message& message) {
-//     out << to_string(message.type) << "(L" << message.line << "/C" << message.character << ")"  << " : " << message.content;
-    std::string characterString(message.character != 0 ? ", Character: " + std::to_string(message.character) : "");
-    out << "L" << message.line+1 << characterString << ": " << message.content;
-    return out;
-  }
-
 }
@@ -22,27 +22,246 @@
 */
 #include "message_stack.hpp"
 #include "assert.hpp"
+#include "baseline.hpp"
+
+#include <algorithm>
+#include <iterator>
+#include <numeric>
+#include <tuple>
 
 namespace Core {
 
+  MessageStack::MessageStack(const MessageStack& other)
+    : m_rules(other.m_rules)
+    , m_messages(other.m_messages)
+    , m_sorted(false)
+    , m_arguments(other.m_arguments)
+    , m_baselineFilter(other.m_baselineFilter)
+    , m_countOnly(other.m_countOnly)
+    , m_counts(other.m_counts)
+    , m_countedMessages(other.m_countedMessages) {}
+
+  MessageStack& MessageStack::operator=(const MessageStack& other) {
+    if(this != &other) {
+      // The ranges of other point into its own messages
+      m_rules = other.m_rules;
+      m_messages = other.m_messages;
+      m_ranges.clear();
+      m_sorted = false;
+      m_arguments = other.m_arguments;
+      m_baselineFilter = other.m_baselineFilter;
+      m_countOnly = other.m_countOnly;
+      m_counts = other.m_counts;
+      m_countedMessages = other.m_countedMessages;
+    }
+    return *this;
+  }
+
   void MessageStack::pushMessage(RuleId ruleId, const Message & message) {
-    m_messages[ruleId].push_back(message);
+    if(m_baselineFilter && m_baselineFilter->isKnown(ruleId, message, nullptr)) {
+      return;
+    }
+    append(ruleId, message);
+  }
+
+  void MessageStack::pushMessage(RuleId ruleId, Message message, const std::string& argument) {
+    if(m_baselineFilter && m_baselineFilter->isKnown(ruleId, message, &argument)) {
+      return;
+    }
+    if(m_countOnly) {
+      append(ruleId, message);
+      return;
+    }
+    message.argument = static_cast<std::uint32_t>(m_arguments.size());
+    m_arguments.push_back(argument);
+    append(ruleId, message);
+  }
+
+  void MessageStack::append(RuleId ruleId, const Message& message) {
+    if(m_countOnly) {
+      ++m_counts[ruleId];
+      ++m_countedMessages;
+      return;
+    }
+    m_rules.push_back(ruleId);
+    m_messages.push_back(message);
+    m_sorted = false;
+  }
+
+  void MessageStack::pushMessage(RuleId ruleId, MessageType type, const std::string& text, const int line, const int character) {
+    pushMessage(ruleId, Message(type, MessageText::Argument, line, character), text);
   }
 
   bool MessageStack::hasMessages() const {
-    return m_messages.size() != 0;
+    return !m_messages.empty() || m_countedMessages != 0;
   }
 
-  const std::map<RuleId, std::vector<Message>>& MessageStack::getMessages() const {
-    return m_messages;
+  const std::map<RuleId, MessageRange>& MessageStack::getMessages() const {
+    ensureSorted();
+    return m_ranges;
   }
 
   std::size_t MessageStack::size() const {
-    return m_messages.size();
+    ensureSorted();
+    return m_ranges.size();
+  }
+
+  std::size_t MessageStack::countMessages() const {
+    return m_messages.size() + m_countedMessages;
+  }
+
+  std::map<RuleId, std::size_t> MessageStack::countMessagesByRule() const {
+    std::map<RuleId, std::size_t> counts = m_counts;
+    for(const auto& ruleIdMessagesPair : getMessages()) {
+      counts[ruleIdMessagesPair.first] += ruleIdMessagesPair.second.size();
+    }
+    return counts;
   }
   
   void MessageStack::clear()
   {
+    m_rules.clear();
     m_messages.clear();
+    m_ranges.clear();
+    m_sorted = true;
+    m_arguments.clear();
+    m_counts.clear();
+    m_countedMessages = 0;
+  }
+
+  void MessageStack::merge(MessageStack&& other)
+  {
+    // The arguments of other go after ours
+    const std::uint32_t argumentOffset = static_cast<std::uint32_t>(m_arguments.size());
+    if(argumentOffset != 0) {
+      for(auto& message : other.m_messages) {
+        if(usesArgument(message.text)) {
+          message.argument += argumentOffset;
+        }
+      }
+    }
+
+    if(m_messages.empty()) {
+      m_rules = std::move(other.m_rules);
+      m_messages = std::move(other.m_messages);
+      m_arguments = std::move(other.m_arguments);
+    } else {
+      m_rules.insert(m_rules.end(), other.m_rules.begin(), other.m_rules.end());
+      m_messages.insert(m_messages.end(), other.m_messages.begin(), other.m_messages.end());
+      m_arguments.insert(m_arguments.end(), std::make_move_iterator(other.m_arguments.begin()), std::make_move_iterator(other.m_arguments.end()));
+    }
+    m_sorted = m_messages.empty();
+    for(const auto& ruleIdCountPair : other.m_counts) {
+      m_counts[ruleIdCountPair.first] += ruleIdCountPair.second;
+    }
+    m_countedMessages += other.m_countedMessages;
+    m_countOnly = m_countOnly || other.m_countOnly;
+    other.clear();
+  }
+
+  void MessageStack::sort() {
+    ensureSorted();
+  }
+
+  void MessageStack::ensureSorted() const {
+    if(m_sorted) {
+      return;
+    }
+
+    auto isBefore = [this](std::size_t lhs, std::size_t rhs) {
+      return std::tie(m_rules[lhs], m_messages[lhs].line, m_messages[lhs].character)
+           < std::tie(m_rules[rhs], m_messages[rhs].line, m_messages[rhs].character);
+    };
+    // Rules mostly push in order already
+    bool inOrder = true;
+    for(std::size_t i = 1; i < m_messages.size() && inOrder; ++i) {
+      inOrder = !isBefore(i, i - 1);
+    }
+    if(!inOrder) {
+      std::vector<std::size_t> order(m_messages.size());
+      std::iota(order.begin(), order.end(), 0);
+      std::stable_sort(order.begin(), order.end(), isBefore);
+
+      std::vector<RuleId> rules;
+      std::vector<Message> messages;
+      rules.reserve(order.size());
+      messages.reserve(order.size());
+      for(const std::size_t index : order) {
+        rules.push_back(m_rules[index]);
+        messages.push_back(m_messages[index]);
+      }
+      m_rules = std::move(rules);
+      m_messages = std::move(messages);
+    }
+
+    m_ranges.clear();
+    std::size_t first = 0;
+    for(std::size_t i = 1; i <= m_messages.size(); ++i) {
+      if(i == m_messages.size() || m_rules[i] != m_rules[first]) {
+        m_ranges.emplace(m_rules[first], MessageRange(m_messages.data() + first, m_messages.data() + i));
+        first = i;
+      }
+    }
+    m_sorted = true;
+  }
+
+  void MessageStack::appendText(std::string& out, const Message& message, const File* file) const {
+    if(message.text == MessageText::Source || message.text == MessageText::SourceLineBreak) {
+      SIFT_ASSERT(file != nullptr, "Messages taken from the source need their file to be rendered");
+      if(file && message.sourceLine < file->lines.size()) {
+        const std::string& line = file->lines[message.sourceLine];
+        if(message.column <= line.size()) {
+          out.append(line, message.column, message.length);
+        }
+      }
+      if(message.text == MessageText::SourceLineBreak) {
+        out += "\n";
+      }
+      return;
+    }
+    if(message.text == MessageText::SourceLines) {
+      SIFT_ASSERT(file != nullptr, "Messages taken from the source need their file to be rendered");
+      const std::size_t first = static_cast<std::size_t>(message.line);
+      for(std::size_t i = first; file && i <= message.sourceLine && i < file->lines.size(); ++i) {
+        const std::string& line = file->lines[i];
+        const std::size_t column = i == first ? message.column : 0;
+        if(column <= line.size()) {
+          out.append(line, column, i == message.sourceLine ? message.length : std::string::npos);
+        }
+        out += "\t";
+      }
+      return;
+    }
+
+    const std::string& argument = m_arguments[message.argument];
+    out += argument;
+    switch(message.text) {
+    case MessageText::ExpectedLength:
+      out += " expected - got: ";
+      out += std::to_string(message.length);
+      break;
+    case MessageText::ArgumentLength:
+      out += " - Got: ";
+      out += std::to_string(argument.size());
+      break;
+    case MessageText::NullPointer:
+      out += " will throw a NULL pointer exception";
+      break;
+    case MessageText::UsedBeforeInitialization:
+      out += " is used before initialization";
+      break;
+    default:
+      break;
+    }
+  }
+
+  const std::string* MessageStack::getArgument(const Message& message) const {
+    return usesArgument(message.text) ? &m_arguments[message.argument] : nullptr;
+  }
+
+  std::string MessageStack::getText(const Message& message, const File* file) const {
+    std::string text;
+    appendText(text, message, file);
+    return text;
   }
 }
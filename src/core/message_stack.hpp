@@ -22,23 +22,104 @@
 */
 #pragma once
 
+#include <string>
 #include <vector>
 #include <map>
+#include <stdexcept>
+#include "file.hpp"
 #include "message.hpp"
 #include "constants.hpp"
 
 namespace Core {
 
+  class BaselineFilter;
+
+  // Messages of one rule, next to each other in their stack
+  class MessageRange {
+  public:
+    MessageRange(const Message* first = nullptr, const Message* last = nullptr)
+      : m_first(first)
+      , m_last(last) {}
+
+    const Message* begin() const { return m_first; }
+    const Message* end() const { return m_last; }
+    std::size_t size() const { return static_cast<std::size_t>(m_last - m_first); }
+    bool empty() const { return m_first == m_last; }
+    const Message& operator[](std::size_t index) const { return m_first[index]; }
+    const Message& at(std::size_t index) const {
+      if(index >= size()) {
+        throw std::out_of_range("MessageRange::at");
+      }
+      return m_first[index];
+    }
+    const Message& front() const { return *m_first; }
+    const Message& back() const { return *(m_last - 1); }
+
+  private:
+    const Message* m_first;
+    const Message* m_last;
+  };
+
+  // Append only, a push never looks anything up. Each worker fills its own stacks, merged in a
+  // fixed order once they are done. The messages are then read by rule, each rule in (line,
+  // column) order and in push order between equal positions, so the result does not depend on
+  // how the work was split. Sorting happens on the first read, stacks that are read from several
+  // threads are sorted before they are shared.
   class MessageStack {
   public:
+    MessageStack() = default;
+    MessageStack(const MessageStack& other);
+    MessageStack& operator=(const MessageStack& other);
+    MessageStack(MessageStack&&) = default;
+    MessageStack& operator=(MessageStack&&) = default;
+
+    // Messages filter knows are dropped as they are pushed, null keeps them all. Not carried by merge.
+    void setBaselineFilter(const BaselineFilter* filter) { m_baselineFilter = filter; }
+    // Only counts the messages pushed by rule, getMessages stays empty. Carried by merge.
+    void setCountOnly(bool countOnly) { m_countOnly = countOnly; }
+    bool isCountOnly() const { return m_countOnly; }
+
     void pushMessage(RuleId category, const Message& message);
+    // Keeps argument for the template of message
+    void pushMessage(RuleId category, Message message, const std::string& argument);
+    // Message whose text is text as is
+    void pushMessage(RuleId category, MessageType type, const std::string& text, const int line = 0, const int character = 0);
     bool hasMessages() const;
-    const std::map<RuleId, std::vector<Message>>& getMessages() const;
+    const std::map<RuleId, MessageRange>& getMessages() const;
     std::size_t size() const;
+    // Messages of all the rules, where size only counts the rules
+    std::size_t countMessages() const;
+    // Messages of each rule, kept or only counted
+    std::map<RuleId, std::size_t> countMessagesByRule() const;
     void clear();
+    // Appends the messages of other after the ones already pushed
+    void merge(MessageStack&& other);
+    void sort();
+
+    // Renders the text of message, file is the source the stack was filled from and may only be
+    // null when none of the messages take their text from it
+    void appendText(std::string& out, const Message& message, const File* file = nullptr) const;
+    std::string getText(const Message& message, const File* file = nullptr) const;
+    // Argument text of message, null for messages taken from the source
+    const std::string* getArgument(const Message& message) const;
 
   private:
-    std::map<RuleId, std::vector<Message>> m_messages;
+    void append(RuleId ruleId, const Message& message);
+    void ensureSorted() const;
+
+    // Rule of each message
+    mutable std::vector<RuleId> m_rules;
+    mutable std::vector<Message> m_messages;
+    // Only valid while m_sorted
+    mutable std::map<RuleId, MessageRange> m_ranges;
+    mutable bool m_sorted = true;
+    // By Message::argument
+    std::vector<std::string> m_arguments;
+    const BaselineFilter* m_baselineFilter = nullptr;
+    bool m_countOnly = false;
+    // Messages of each rule and of all of them, only pushed to while m_countOnly
+    std::map<RuleId, std::size_t> m_counts;
+    std::size_t m_countedMessages = 0;
   };
 
 }
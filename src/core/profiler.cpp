@@ -0,0 +1,168 @@
+/* MIT License
+ *
+ * Copyright (c) 2018 Jean-Sebastien Fauteux, Michel Rioux, Raphaël Massabot
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "profiler.hpp"
+
+#include <algorithm>
+#include <fstream>
+#include <vector>
+
+#include <nlohmann/json.hpp>
+
+namespace Core {
+
+  namespace {
+
+    const char* const PhaseNames[] = {"extraction", "syntax", "flow"};
+
+    nlohmann::json toJson(const ProfileCounters& counters) {
+      nlohmann::json json;
+      json["wallTimeMs"] = counters.wallTime / 1e6;
+      json["scopesVisited"] = counters.scopesVisited;
+      json["linesScanned"] = counters.linesScanned;
+      json["regexEvaluations"] = counters.regexEvaluations;
+      json["messages"] = counters.messages;
+      return json;
+    }
+
+    template<typename Value, typename CountersOf>
+    nlohmann::json slowest(const std::map<std::string, Value>& entries, const std::string& key, std::size_t topCount, CountersOf countersOf) {
+      std::vector<std::pair<std::string, const ProfileCounters*>> sorted;
+      for(const auto& entry : entries) {
+        sorted.emplace_back(entry.first, &countersOf(entry.second));
+      }
+      const std::size_t count = std::min(topCount, sorted.size());
+      std::partial_sort(sorted.begin(), sorted.begin() + count, sorted.end(), [](const auto& lhs, const auto& rhs) {
+        return lhs.second->wallTime > rhs.second->wallTime;
+      });
+
+      nlohmann::json top = nlohmann::json::array();
+      for(std::size_t i = 0; i < count; ++i) {
+        nlohmann::json entry = toJson(*sorted[i].second);
+        entry[key] = sorted[i].first;
+        top.push_back(entry);
+      }
+      return top;
+    }
+
+  }
+
+  ProfileCounters& ProfileCounters::operator+=(const ProfileCounters& other) {
+    wallTime += other.wallTime;
+    scopesVisited += other.scopesVisited;
+    linesScanned += other.linesScanned;
+    regexEvaluations += other.regexEvaluations;
+    messages += other.messages;
+    return *this;
+  }
+
+  namespace Profiling {
+
+    Sample::Sample(ProfileCounters* counters)
+      : m_counters(counters)
+    {
+      if(m_counters) {
+        m_previous = currentCounters();
+        currentCounters() = m_counters;
+        m_start = std::chrono::steady_clock::now();
+      }
+    }
+
+    Sample::~Sample()
+    {
+      if(m_counters) {
+        m_counters->wallTime += std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - m_start).count();
+        currentCounters() = m_previous;
+      }
+    }
+
+  }
+
+  void ProfileReport::add(ProfilePhase phase, const std::string& filename, const ProfileCounters& counters) {
+    PhaseProfile& phaseProfile = m_phases[static_cast<std::size_t>(phase)];
+    phaseProfile.total += counters;
+    phaseProfile.files[filename].total += counters;
+  }
+
+  void ProfileReport::add(ProfilePhase phase, const std::string& filename, const std::string& ruleType, const ProfileCounters& counters) {
+    add(phase, filename, counters);
+    PhaseProfile& phaseProfile = m_phases[static_cast<std::size_t>(phase)];
+    phaseProfile.files[filename].rules[ruleType] += counters;
+    phaseProfile.rules[ruleType] += counters;
+  }
+
+  void ProfileReport::clear() {
+    m_phases = std::array<PhaseProfile, 3>();
+  }
+
+  std::string ProfileReport::toJson(std::size_t topCount) const {
+    nlohmann::json json;
+    for(std::size_t i = 0; i < m_phases.size(); ++i) {
+      const PhaseProfile& phaseProfile = m_phases[i];
+      nlohmann::json phase;
+      phase["total"] = Core::toJson(phaseProfile.total);
+
+      nlohmann::json files = nlohmann::json::object();
+      for(const auto& filePair : phaseProfile.files) {
+        nlohmann::json file = Core::toJson(filePair.second.total);
+        if(!filePair.second.rules.empty()) {
+          nlohmann::json rules = nlohmann::json::object();
+          for(const auto& rulePair : filePair.second.rules) {
+            rules[rulePair.first] = Core::toJson(rulePair.second);
+          }
+          file["rules"] = rules;
+        }
+        files[filePair.first] = file;
+      }
+      phase["files"] = files;
+      phase["slowestFiles"] = slowest(phaseProfile.files, "file", topCount, [](const FileProfile& file) -> const ProfileCounters& {
+        return file.total;
+      });
+
+      if(!phaseProfile.rules.empty()) {
+        nlohmann::json rules = nlohmann::json::object();
+        for(const auto& rulePair : phaseProfile.rules) {
+          rules[rulePair.first] = Core::toJson(rulePair.second);
+        }
+        phase["rules"] = rules;
+        phase["slowestRules"] = slowest(phaseProfile.rules, "rule", topCount, [](const ProfileCounters& counters) -> const ProfileCounters& {
+          return counters;
+        });
+      }
+
+      json[PhaseNames[i]] = phase;
+    }
+
+    return json.dump(2);
+  }
+
+  bool ProfileReport::write(const std::string& filename, std::size_t topCount) const {
+    std::ofstream file(filename);
+    if(!file.is_open()) {
+      return false;
+    }
+    file << toJson(topCount) << "\n";
+    return file.good();
+  }
+
+}
@@ -0,0 +1,136 @@
+/* MIT License
+ *
+ * Copyright (c) 2018 Jean-Sebastien Fauteux, Michel Rioux, Raphaël Massabot
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <regex>
+#include <string>
+#include <utility>
+
+#include "budget.hpp"
+
+namespace Core {
+
+  // Work done by a part of the analysis, summed over whatever it is attributed to
+  struct ProfileCounters {
+    std::uint64_t wallTime = 0; // Nanoseconds
+    std::uint64_t scopesVisited = 0;
+    std::uint64_t linesScanned = 0;
+    std::uint64_t regexEvaluations = 0;
+    std::uint64_t messages = 0;
+
+    ProfileCounters& operator+=(const ProfileCounters& other);
+  };
+
+  namespace Profiling {
+
+    // Counters the code running on this thread reports to, null while nothing is being profiled
+    inline ProfileCounters*& currentCounters() {
+      static thread_local ProfileCounters* counters = nullptr;
+      return counters;
+    }
+
+    inline void countRegexEvaluation() {
+      if(ProfileCounters* counters = currentCounters()) {
+        ++counters->regexEvaluations;
+      }
+    }
+
+    inline void countLinesScanned(std::uint64_t lines) {
+      if(ProfileCounters* counters = currentCounters()) {
+        counters->linesScanned += lines;
+      }
+    }
+
+    // Makes counters the current ones of the thread and adds the wall time until it goes out of scope.
+    // Does nothing, not even reading the clock, for null counters.
+    class Sample {
+    public:
+      explicit Sample(ProfileCounters* counters);
+      ~Sample();
+
+      Sample(const Sample&) = delete;
+      Sample& operator=(const Sample&) = delete;
+
+    private:
+      ProfileCounters* m_counters;
+      ProfileCounters* m_previous = nullptr;
+      std::chrono::steady_clock::time_point m_start;
+    };
+
+  }
+
+  // Regex calls going through these are counted when profiling and double as budget checkpoints
+  template<typename... Args>
+  bool regexSearch(Args&&... args) {
+    Budgeting::checkpoint();
+    Profiling::countRegexEvaluation();
+    return std::regex_search(std::forward<Args>(args)...);
+  }
+
+  template<typename... Args>
+  bool regexMatch(Args&&... args) {
+    Budgeting::checkpoint();
+    Profiling::countRegexEvaluation();
+    return std::regex_match(std::forward<Args>(args)...);
+  }
+
+  enum class ProfilePhase : unsigned int {
+    Extraction = 0,
+    Syntax,
+    Flow
+  };
+
+  // Counters of a run by phase, file and rule type. Tasks keep their own counters, they are
+  // added here from a single thread once the tasks are done.
+  class ProfileReport {
+  public:
+    void add(ProfilePhase phase, const std::string& filename, const ProfileCounters& counters);
+    void add(ProfilePhase phase, const std::string& filename, const std::string& ruleType, const ProfileCounters& counters);
+    void clear();
+
+    // JSON with every counter and, for each phase, the topCount slowest files and rules
+    std::string toJson(std::size_t topCount) const;
+    bool write(const std::string& filename, std::size_t topCount) const;
+
+  private:
+    struct FileProfile {
+      ProfileCounters total;
+      std::map<std::string, ProfileCounters> rules;
+    };
+
+    struct PhaseProfile {
+      ProfileCounters total;
+      std::map<std::string, FileProfile> files;
+      std::map<std::string, ProfileCounters> rules;
+    };
+
+    std::array<PhaseProfile, 3> m_phases;
+  };
+
+}
@@ -0,0 +1,366 @@
+/* MIT License
+ *
+ * Copyright (c) 2018 Jean-Sebastien Fauteux, Michel Rioux, Raphaël Massabot
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "result_formatters.hpp"
+
+#include <utility>
+
+#include "config.hpp"
+
+namespace {
+
+  // Length of the UTF-8 sequence starting at index, 0 when the bytes there are not one
+  std::size_t utf8SequenceLength(const std::string& text, std::size_t index) {
+    const unsigned char lead = text[index];
+    std::size_t length = 0;
+    unsigned char low = 0x80;
+    unsigned char high = 0xBF;
+    if(lead >= 0xC2 && lead <= 0xDF) {
+      length = 2;
+    } else if(lead >= 0xE0 && lead <= 0xEF) {
+      length = 3;
+      // No overlong forms nor surrogates
+      low = lead == 0xE0 ? 0xA0 : 0x80;
+      high = lead == 0xED ? 0x9F : 0xBF;
+    } else if(lead >= 0xF0 && lead <= 0xF4) {
+      length = 4;
+      low = lead == 0xF0 ? 0x90 : 0x80;
+      high = lead == 0xF4 ? 0x8F : 0xBF;
+    } else {
+      return 0;
+    }
+    if(index + length > text.size()) {
+      return 0;
+    }
+    for(std::size_t i = 1; i < length; ++i) {
+      const unsigned char byte = text[index + i];
+      if(byte < (i == 1 ? low : 0x80) || byte > (i == 1 ? high : 0xBF)) {
+        return 0;
+      }
+    }
+    return length;
+  }
+
+  bool hasMessages(const Core::FileResult& result) {
+    return result.messageStack && result.messageStack->hasMessages();
+  }
+
+}
+
+namespace Core {
+
+  void appendJsonString(std::string& out, const std::string& text) {
+    static const char Hex[] = "0123456789abcdef";
+    out += '"';
+    for(std::size_t i = 0; i < text.size(); ++i) {
+      const unsigned char c = text[i];
+      if(c >= 0x80) {
+        const std::size_t length = utf8SequenceLength(text, i);
+        if(length != 0) {
+          out.append(text, i, length);
+          i += length - 1;
+        } else {
+          out += static_cast<char>(0xC0 | (c >> 6));
+          out += static_cast<char>(0x80 | (c & 0x3F));
+        }
+        continue;
+      }
+      switch(c) {
+        case '"': out += "\\\""; break;
+        case '\\': out += "\\\\"; break;
+        case '\n': out += "\\n"; break;
+        case '\r': out += "\\r"; break;
+        case '\t': out += "\\t"; break;
+        case '\b': out += "\\b"; break;
+        case '\f': out += "\\f"; break;
+        default:
+          if(c < 0x20) {
+            out += "\\u00";
+            out += Hex[c >> 4];
+            out += Hex[c & 0xF];
+          } else {
+            out += static_cast<char>(c);
+          }
+      }
+    }
+    out += '"';
+  }
+
+  TextResultFormatter::TextResultFormatter(const std::string& phase, RuleDescriptions rules)
+    : m_phase(phase)
+    , m_rules(std::move(rules)) {}
+
+  void TextResultFormatter::formatFile(const FileResult& result, std::string& out) {
+    if(!hasMessages(result) && result.budgetExceeded.empty()) {
+      return; // Don't bother displaying error-free files
+    }
+
+    out += "+ ";
+    out += result.filename;
+    out += " ----------\n";
+    if(hasMessages(result)) {
+      for(const auto& ruleIdMessagesPair : result.messageStack->getMessages()) {
+        const auto ruleIt = m_rules.find(ruleIdMessagesPair.first);
+        if(ruleIt != m_rules.end()) {
+          out += "  ";
+          out += ruleIt->second.name;
+          out += " -- ";
+          out += ruleIt->second.description;
+          out += "\n";
+        }
+        for(const auto& message : ruleIdMessagesPair.second) {
+          out += "    L";
+          out += std::to_string(message.line + 1);
+          if(message.character != 0) {
+            out += ", Character: ";
+            out += std::to_string(message.character);
+          }
+          out += ": ";
+          result.messageStack->appendText(out, message, result.file);
+          out += "\n";
+        }
+      }
+    }
+    if(!result.budgetExceeded.empty()) {
+      out += "  BudgetExceeded -- ";
+      out += result.budgetExceeded;
+      out += "\n";
+    }
+  }
+
+  void TextResultFormatter::formatEnd(long long executionTime, std::string& out) {
+    out += m_phase;
+    out += " Ran in ";
+    out += std::to_string(executionTime);
+    out += "ms\n";
+  }
+
+  JsonLinesResultFormatter::JsonLinesResultFormatter(const std::string& phase, RuleDescriptions rules)
+    : m_phase(phase)
+    , m_rules(std::move(rules)) {}
+
+  void JsonLinesResultFormatter::formatFile(const FileResult& result, std::string& out) {
+    // The fields every line of the file starts with
+    std::string prefix = "{\"phase\":";
+    appendJsonString(prefix, m_phase);
+    prefix += ",\"file\":";
+    appendJsonString(prefix, result.filename);
+
+    if(hasMessages(result)) {
+      for(const auto& ruleIdMessagesPair : result.messageStack->getMessages()) {
+        std::string rulePrefix = prefix;
+        rulePrefix += ",\"ruleId\":";
+        rulePrefix += std::to_string(ruleIdMessagesPair.first);
+        const auto ruleIt = m_rules.find(ruleIdMessagesPair.first);
+        if(ruleIt != m_rules.end()) {
+          rulePrefix += ",\"rule\":";
+          appendJsonString(rulePrefix, ruleIt->second.name);
+          rulePrefix += ",\"scope\":";
+          appendJsonString(rulePrefix, ruleIt->second.scope);
+        }
+
+        for(const auto& message : ruleIdMessagesPair.second) {
+          out += rulePrefix;
+          out += ",\"severity\":";
+          appendJsonString(out, to_string(message.type));
+          out += ",\"line\":";
+          out += std::to_string(message.line + 1);
+          out += ",\"character\":";
+          out += std::to_string(message.character);
+          out += ",\"message\":";
+          appendJsonString(out, result.messageStack->getText(message, result.file));
+          out += "}\n";
+        }
+      }
+    }
+    if(!result.budgetExceeded.empty()) {
+      out += prefix;
+      out += ",\"budgetExceeded\":";
+      appendJsonString(out, result.budgetExceeded);
+      out += "}\n";
+    }
+  }
+
+  void JsonLinesResultFormatter::formatEnd(long long executionTime, std::string& out) {
+    out += "{\"phase\":";
+    appendJsonString(out, m_phase);
+    out += ",\"executionTimeMs\":";
+    out += std::to_string(executionTime);
+    out += "}\n";
+  }
+
+  SarifResultFormatter::SarifResultFormatter(const std::string& phase, RuleDescriptions rules, bool opensLog, bool closesLog)
+    : m_phase(phase)
+    , m_rules(std::move(rules))
+    , m_opensLog(opensLog)
+    , m_closesLog(closesLog) {}
+
+  void SarifResultFormatter::formatBegin(std::string& out) {
+    out += m_opensLog ? "{\"version\":\"2.1.0\",\"$schema\":\"https://json.schemastore.org/sarif-2.1.0.json\",\"runs\":[\n" : ",\n";
+    out += "{\"tool\":{\"driver\":{\"name\":";
+    appendJsonString(out, PROGRAM_NAME);
+    out += ",\"version\":";
+    appendJsonString(out, VERSION);
+    out += ",\"rules\":[";
+    bool first = true;
+    for(const auto& rulePair : m_rules) {
+      out += first ? "\n" : ",\n";
+      first = false;
+      out += "{\"id\":";
+      appendJsonString(out, std::to_string(rulePair.first));
+      out += ",\"name\":";
+      appendJsonString(out, rulePair.second.name);
+      out += ",\"shortDescription\":{\"text\":";
+      appendJsonString(out, rulePair.second.description);
+      out += "},\"properties\":{\"scope\":";
+      appendJsonString(out, rulePair.second.scope);
+      out += "}}";
+    }
+    out += "]}},\"properties\":{\"phase\":";
+    appendJsonString(out, m_phase);
+    out += "},\"results\":[";
+  }
+
+  void SarifResultFormatter::beginResult(std::string& out) {
+    out += m_hasResults ? ",\n" : "\n";
+    m_hasResults = true;
+  }
+
+  void SarifResultFormatter::formatFile(const FileResult& result, std::string& out) {
+    if(!hasMessages(result)) {
+      if(!result.budgetExceeded.empty()) {
+        m_budgetsExceeded.emplace_back(result.filename, result.budgetExceeded);
+      }
+      return;
+    }
+
+    std::string location = "\"locations\":[{\"physicalLocation\":{\"artifactLocation\":{\"uri\":";
+    appendJsonString(location, result.filename);
+    location += "},\"region\":{\"startLine\":";
+    for(const auto& ruleIdMessagesPair : result.messageStack->getMessages()) {
+      std::string ruleId;
+      appendJsonString(ruleId, std::to_string(ruleIdMessagesPair.first));
+      for(const auto& message : ruleIdMessagesPair.second) {
+        beginResult(out);
+        out += "{\"ruleId\":";
+        out += ruleId;
+        out += ",\"level\":";
+        out += message.type == MessageType::Error ? "\"error\"" : message.type == MessageType::Warning ? "\"warning\"" : "\"note\"";
+        out += ",\"message\":{\"text\":";
+        appendJsonString(out, result.messageStack->getText(message, result.file));
+        out += "},";
+        out += location;
+        out += std::to_string(message.line + 1);
+        if(message.character != 0) {
+          out += ",\"startColumn\":";
+          out += std::to_string(message.character + 1);
+        }
+        out += "}}}]}";
+      }
+    }
+    if(!result.budgetExceeded.empty()) {
+      m_budgetsExceeded.emplace_back(result.filename, result.budgetExceeded);
+    }
+  }
+
+  void SarifResultFormatter::formatEnd(long long executionTime, std::string& out) {
+    // Files cut short are reported with the invocation, which comes after the results
+    out += "\n],\"invocations\":[{\"executionSuccessful\":true,\"toolExecutionNotifications\":[";
+    bool first = true;
+    for(const auto& budgetPair : m_budgetsExceeded) {
+      out += first ? "\n" : ",\n";
+      first = false;
+      out += "{\"level\":\"warning\",\"descriptor\":{\"id\":\"BudgetExceeded\"},\"message\":{\"text\":";
+      appendJsonString(out, budgetPair.second);
+      out += "},\"locations\":[{\"physicalLocation\":{\"artifactLocation\":{\"uri\":";
+      appendJsonString(out, budgetPair.first);
+      out += "}}}]}";
+    }
+    out += "],\"properties\":{\"executionTimeMs\":";
+    out += std::to_string(executionTime);
+    out += "}}]}";
+    out += m_closesLog ? "\n]}\n" : "\n";
+  }
+
+  SummaryResultFormatter::SummaryResultFormatter(const std::string& phase, RuleDescriptions rules, bool writesHeader)
+    : m_phase(phase)
+    , m_rules(std::move(rules))
+    , m_writesHeader(writesHeader) {}
+
+  void SummaryResultFormatter::appendRow(std::string& out, const std::string& kind, const std::string& name, std::size_t value) const {
+    out += m_phase;
+    out += '\t';
+    out += kind;
+    out += '\t';
+    out += name;
+    out += '\t';
+    out += std::to_string(value);
+    out += '\n';
+  }
+
+  void SummaryResultFormatter::formatBegin(std::string& out) {
+    if(m_writesHeader) {
+      out += "phase\tkind\tname\tmessages\n";
+    }
+  }
+
+  void SummaryResultFormatter::formatFile(const FileResult& result, std::string& out) {
+    ++m_files;
+    if(!result.budgetExceeded.empty()) {
+      ++m_budgetsExceeded;
+    }
+    if(!hasMessages(result)) {
+      return;
+    }
+
+    std::size_t messages = 0;
+    for(const auto& ruleIdCountPair : result.messageStack->countMessagesByRule()) {
+      m_ruleCounts[ruleIdCountPair.first] += ruleIdCountPair.second;
+      messages += ruleIdCountPair.second;
+    }
+    const auto separator = result.filename.find_last_of("/\\");
+    m_directoryCounts[separator != std::string::npos ? result.filename.substr(0, separator) : "."] += messages;
+    m_messages += messages;
+    appendRow(out, "file", result.filename, messages);
+  }
+
+  void SummaryResultFormatter::formatEnd(long long executionTime, std::string& out) {
+    for(const auto& ruleIdCountPair : m_ruleCounts) {
+      const auto ruleIt = m_rules.find(ruleIdCountPair.first);
+      std::string name = std::to_string(ruleIdCountPair.first);
+      if(ruleIt != m_rules.end()) {
+        name += ":";
+        name += ruleIt->second.name;
+      }
+      appendRow(out, "rule", name, ruleIdCountPair.second);
+    }
+    for(const auto& directoryCountPair : m_directoryCounts) {
+      appendRow(out, "directory", directoryCountPair.first, directoryCountPair.second);
+    }
+    appendRow(out, "total", "messages", m_messages);
+    appendRow(out, "total", "files", m_files);
+    appendRow(out, "total", "budgetsExceeded", m_budgetsExceeded);
+    appendRow(out, "total", "executionTimeMs", static_cast<std::size_t>(executionTime));
+  }
+
+}
@@ -0,0 +1,118 @@
+/* MIT License
+ *
+ * Copyright (c) 2018 Jean-Sebastien Fauteux, Michel Rioux, Raphaël Massabot
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "constants.hpp"
+#include "result_writer.hpp"
+
+namespace Core {
+
+  // What the formatters know of a rule besides its id
+  struct RuleDescription {
+    // RuleType of the rule, or the name of the flow check
+    std::string name;
+    // ScopeType the rule applies to
+    std::string scope;
+    // Message of the rule with its parameters filled in
+    std::string description;
+  };
+  using RuleDescriptions = std::map<RuleId, RuleDescription>;
+
+  // Appends text as a quoted JSON string. Bytes that are not valid UTF-8 are taken as Latin-1.
+  void appendJsonString(std::string& out, const std::string& text);
+
+  // The "+ file ----------" layout, rules only get their "  Name -- description" line when they are described
+  class TextResultFormatter : public ResultFormatter {
+  public:
+    TextResultFormatter(const std::string& phase, RuleDescriptions rules = RuleDescriptions());
+    void formatFile(const FileResult& result, std::string& out) override;
+    void formatEnd(long long executionTime, std::string& out) override;
+
+  private:
+    std::string m_phase;
+    RuleDescriptions m_rules;
+  };
+
+  // One JSON object per line and message, every line can be parsed as soon as it is written
+  class JsonLinesResultFormatter : public ResultFormatter {
+  public:
+    JsonLinesResultFormatter(const std::string& phase, RuleDescriptions rules);
+    void formatFile(const FileResult& result, std::string& out) override;
+    void formatEnd(long long executionTime, std::string& out) override;
+
+  private:
+    std::string m_phase;
+    RuleDescriptions m_rules;
+  };
+
+  // A SARIF 2.1.0 log with a run per phase. The phases append to the same file, so the first
+  // one opens the log and the last one closes it.
+  class SarifResultFormatter : public ResultFormatter {
+  public:
+    SarifResultFormatter(const std::string& phase, RuleDescriptions rules, bool opensLog, bool closesLog);
+    void formatBegin(std::string& out) override;
+    void formatFile(const FileResult& result, std::string& out) override;
+    void formatEnd(long long executionTime, std::string& out) override;
+
+  private:
+    void beginResult(std::string& out);
+
+    std::string m_phase;
+    RuleDescriptions m_rules;
+    bool m_opensLog;
+    bool m_closesLog;
+    bool m_hasResults = false;
+    // filename : why its analysis was cut short, written with the invocation at the end
+    std::vector<std::pair<std::string, std::string>> m_budgetsExceeded;
+  };
+
+  // Tab separated "phase kind name messages" rows, files as they come then rules, directories
+  // and the totals of the phase. Only reads the counts of the stacks, so it works on count only ones.
+  // The phases append to the same file, the first one writes the header.
+  class SummaryResultFormatter : public ResultFormatter {
+  public:
+    SummaryResultFormatter(const std::string& phase, RuleDescriptions rules, bool writesHeader);
+    void formatBegin(std::string& out) override;
+    void formatFile(const FileResult& result, std::string& out) override;
+    void formatEnd(long long executionTime, std::string& out) override;
+
+  private:
+    void appendRow(std::string& out, const std::string& kind, const std::string& name, std::size_t value) const;
+
+    std::string m_phase;
+    RuleDescriptions m_rules;
+    bool m_writesHeader;
+    std::map<RuleId, std::size_t> m_ruleCounts;
+    std::map<std::string, std::size_t> m_directoryCounts;
+    std::size_t m_messages = 0;
+    std::size_t m_files = 0;
+    std::size_t m_budgetsExceeded = 0;
+  };
+
+}
@@ -0,0 +1,125 @@
+/* MIT License
+ *
+ * Copyright (c) 2018 Jean-Sebastien Fauteux, Michel Rioux, Raphaël Massabot
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "result_writer.hpp"
+
+#include <muflihun/easylogging++.h>
+
+namespace {
+
+  // Text is handed to the file, and to the console echo, in blocks of about this size
+  const std::size_t WriteBlockSize = 1 << 20;
+
+}
+
+namespace Core {
+
+  ResultWriter::ResultWriter(const std::string& filename, bool append, bool echo, std::unique_ptr<ResultFormatter> formatter)
+    : m_file(filename, append ? std::ios::app : std::ios::trunc)
+    , m_isOpen(m_file.is_open())
+    , m_echo(echo)
+    , m_formatter(std::move(formatter)) {
+    if(!m_isOpen) {
+      LOG(ERROR) << "Could not open " << filename << " to write the results";
+    }
+    m_buffer.reserve(WriteBlockSize * 2);
+    m_thread = std::thread(&ResultWriter::run, this);
+  }
+
+  ResultWriter::~ResultWriter() {
+    close();
+  }
+
+  void ResultWriter::push(std::size_t sequence, FileResult&& result) {
+    {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      m_queue.emplace_back(sequence, std::move(result));
+    }
+    m_pushed.notify_one();
+  }
+
+  void ResultWriter::close(long long executionTime) {
+    if(!m_thread.joinable()) {
+      return;
+    }
+    {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      m_closing = true;
+      m_executionTime = executionTime;
+    }
+    m_pushed.notify_one();
+    m_thread.join();
+    m_file.close();
+  }
+
+  void ResultWriter::run() {
+    std::vector<std::pair<std::size_t, FileResult>> batch;
+    m_formatter->formatBegin(m_buffer);
+    for(;;) {
+      bool closing;
+      {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_pushed.wait(lock, [this]() { return !m_queue.empty() || m_closing; });
+        batch.swap(m_queue);
+        closing = m_closing;
+      }
+
+      for(auto& entry : batch) {
+        m_waiting.emplace(entry.first, std::move(entry.second));
+      }
+      batch.clear();
+
+      // Once closing nothing else is coming, the gaps are not waited on anymore
+      auto it = m_waiting.begin();
+      while(it != m_waiting.end() && (closing || it->first == m_nextSequence)) {
+        m_formatter->formatFile(it->second, m_buffer);
+        m_nextSequence = it->first + 1;
+        it = m_waiting.erase(it);
+        if(m_buffer.size() >= WriteBlockSize) {
+          flush();
+        }
+      }
+
+      if(closing) {
+        m_formatter->formatEnd(m_executionTime, m_buffer);
+        flush();
+        return;
+      }
+    }
+  }
+
+  void ResultWriter::flush() {
+    if(m_buffer.empty()) {
+      return;
+    }
+    if(m_isOpen) {
+      m_file.write(m_buffer.data(), m_buffer.size());
+    }
+    if(m_echo) {
+      // One log entry for the whole block, without its last newline
+      LOG(INFO) << m_buffer.substr(0, m_buffer.size() - (m_buffer.back() == '\n' ? 1 : 0));
+    }
+    m_buffer.clear();
+  }
+
+}
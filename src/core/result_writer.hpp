@@ -0,0 +1,105 @@
+/* MIT License
+ *
+ * Copyright (c) 2018 Jean-Sebastien Fauteux, Michel Rioux, Raphaël Massabot
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <fstream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "constants.hpp"
+#include "file.hpp"
+#include "message_stack.hpp"
+
+namespace Core {
+
+  // What is written for a file once its analysis is done. The stack and the file are not copied,
+  // whoever pushes the result keeps them alive until the writer is closed.
+  struct FileResult {
+    std::string filename;
+    // Source the messages are rendered from, null for files that never got a stack
+    const File* file = nullptr;
+    // Null for files that never got a stack
+    const MessageStack* messageStack = nullptr;
+    // Why the analysis of the file was cut short, empty when it was not
+    std::string budgetExceeded;
+  };
+
+  // Turns results into output text, only called from the writer thread and in order: the
+  // beginning, each file in sequence order, then the end
+  class ResultFormatter {
+  public:
+    virtual ~ResultFormatter() = default;
+    virtual void formatBegin(std::string& /*out*/) {}
+    virtual void formatFile(const FileResult& result, std::string& out) = 0;
+    virtual void formatEnd(long long executionTime, std::string& out) = 0;
+  };
+
+  // Writes results on its own thread while they are still being produced. Any thread can push,
+  // results are formatted in sequence order whatever order they come in and the text is
+  // written in large blocks. The console echo, when enabled, gets one log entry per block.
+  class ResultWriter {
+  public:
+    ResultWriter(const std::string& filename, bool append, bool echo, std::unique_ptr<ResultFormatter> formatter);
+    ~ResultWriter();
+
+    ResultWriter(const ResultWriter&) = delete;
+    ResultWriter& operator=(const ResultWriter&) = delete;
+
+    bool isOpen() const { return m_isOpen; }
+    // A result waits for every smaller sequence to be pushed before it is written
+    void push(std::size_t sequence, FileResult&& result);
+    // Writes the results still waiting, even with sequences missing, then the end of the output, and stops the thread
+    void close(long long executionTime = 0);
+
+  private:
+    void run();
+    void flush();
+
+    std::ofstream m_file;
+    bool m_isOpen;
+    bool m_echo;
+    std::unique_ptr<ResultFormatter> m_formatter;
+
+    std::mutex m_mutex;
+    std::condition_variable m_pushed;
+    std::vector<std::pair<std::size_t, FileResult>> m_queue;
+    bool m_closing = false;
+    long long m_executionTime = 0;
+
+    // Only touched by the writer thread
+    std::map<std::size_t, FileResult> m_waiting;
+    std::size_t m_nextSequence = 0;
+    std::string m_buffer;
+
+    std::thread m_thread;
+  };
+
+}
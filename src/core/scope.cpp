@@ -21,49 +21,103 @@
  * SOFTWARE.
  */
 
+#include <algorithm>
+
 #include "scope.hpp"
+#include "scope_index.hpp"
 #include "file.hpp"
 
 namespace Core {
   
+  Scope::Scope()
+  {
+  }
+
   Scope::Scope(ScopeType type)
     : type(type)
   {
   }
+
+  Scope::Scope(Scope&& other) noexcept {
+    *this = std::move(other);
+  }
+
+  Scope& Scope::operator=(Scope&& other) noexcept {
+    if(this == &other) {
+      return *this;
+    }
+
+    type = other.type;
+    children = std::move(other.children);
+    lineNumberStart = other.lineNumberStart;
+    lineNumberEnd = other.lineNumberEnd;
+    characterNumberStart = other.characterNumberStart;
+    characterNumberEnd = other.characterNumberEnd;
+    name = std::move(other.name);
+    file = other.file;
+    parent = other.parent;
+    typeIndex = std::move(other.typeIndex);
+
+    //Children keep their address, only the ones linked to the moved scope need to follow it
+    for(auto& child : children) {
+      if(child.parent == &other) {
+        child.parent = this;
+      }
+    }
+
+    return *this;
+  }
+
+  Scope::~Scope() {
+  }
+
+  Scope Scope::clone() const {
+    Scope copy(type);
+    copy.lineNumberStart = lineNumberStart;
+    copy.lineNumberEnd = lineNumberEnd;
+    copy.characterNumberStart = characterNumberStart;
+    copy.characterNumberEnd = characterNumberEnd;
+    copy.name = name;
+    copy.file = file;
+    copy.parent = parent;
+
+    copy.children.reserve(children.size());
+    for(const auto& child : children) {
+      copy.children.push_back(child.clone());
+      if(child.parent == this) {
+        copy.children.back().parent = &copy;
+      }
+    }
+
+    return copy;
+  }
   
   bool Scope::isMultiline() const {
     return lineNumberEnd != lineNumberStart;
   }
   
 
-  ScopeVector Scope::getDirectChildrenOfType(ScopeType type) const {
-    ScopeVector directChildren;
+  ScopeRefVector Scope::getDirectChildrenOfType(ScopeType type) const {
+    ScopeRefVector directChildren;
 
     for(const auto& child : children) {
       if(static_cast<unsigned int>(child.type & type) != 0) {
-        directChildren.push_back(child);
+        directChildren.push_back(std::cref(child));
       }
     }
 
     return directChildren;
   }
   
-  ScopeVector Scope::getAllChildrenOfType(ScopeType type) const {
-    ScopeVector stack, current, toReturn;
-    stack = children;
-    while(!stack.empty())
-    {
-      current = stack;
-      stack.clear();
-      for(const auto& child : current)
-      {
-        if(static_cast<unsigned int>(child.type & type) != 0) {
-          toReturn.push_back(child);
-        }
-        
-        stack.insert(stack.begin(), child.children.begin(), child.children.end());
-      }
+  ScopeRefVector Scope::getAllChildrenOfType(ScopeType type) const {
+    if(typeIndex) {
+      return typeIndex->getScopesOfType(type);
     }
+
+    ScopeRefVector toReturn;
+    forEachChildOfType(type, [&toReturn](const Scope& child) {
+      toReturn.push_back(std::cref(child));
+    });
     return toReturn;
   }
 
@@ -136,31 +190,44 @@ namespace Core {
     return children.end();
   }
   
-  std::vector<std::string> Core::Scope::getScopeLines() const
+  std::vector<StringView> Scope::getScopeLines() const
   {
-    std::vector<std::string> toReturn;
-    unsigned int currentLineNo = 0;
-    for(const auto& line : file->lines)
-    {
-      if(currentLineNo == lineNumberStart)
-      {
-        if(isMultiline()){
-          toReturn.push_back(line.substr(characterNumberStart, line.size()));
-        }else{
-          toReturn.push_back(line.substr(characterNumberStart, characterNumberEnd));  
-          break;
-        }          
-
-      }else if(currentLineNo != lineNumberEnd && currentLineNo > lineNumberStart && currentLineNo < lineNumberEnd){ // Guaranteed multiline at this point
-        toReturn.push_back(line);
-      }else if(currentLineNo == lineNumberEnd){
-        toReturn.push_back(line.substr(0, characterNumberEnd));  
-        break;
-      }
-      
-      currentLineNo++;
+    std::vector<StringView> toReturn;
+    if(!file || lineNumberStart >= file->lines.size()) {
+      return toReturn;
     }
-    
+
+    const unsigned int lastLine = isMultiline() ? std::max(lineNumberStart, std::min<unsigned int>(lineNumberEnd, file->lines.size() - 1)) : lineNumberStart;
+    toReturn.reserve(lastLine - lineNumberStart + 1);
+    for(unsigned int i = lineNumberStart; i <= lastLine; ++i) {
+      toReturn.push_back(getScopeLine(i));
+    }
+
     return toReturn;
   }
+
+  StringView Scope::getScopeLine(unsigned int lineNumber) const
+  {
+    const StringView line(file->lines[lineNumber]);
+    if(!isMultiline()) {
+      return line.substr(characterNumberStart, characterNumberEnd);
+    }
+    if(lineNumber == lineNumberStart) {
+      return line.substr(characterNumberStart);
+    }
+    if(lineNumber == lineNumberEnd) {
+      return line.substr(0, characterNumberEnd);
+    }
+    return line;
+  }
+
+  void blankOutScope(std::vector<std::string>& lines, const Scope& scope) {
+    for(unsigned int line = scope.lineNumberStart; line <= scope.lineNumberEnd && line < lines.size(); ++line) {
+      const unsigned int first = line == scope.lineNumberStart ? scope.characterNumberStart : 0;
+      const unsigned int last = line == scope.lineNumberEnd ? scope.characterNumberEnd : lines[line].size();
+      for(unsigned int position = first; position <= last && position < lines[line].size(); ++position) {
+        lines[line][position] = ' ';
+      }
+    }
+  }
 }
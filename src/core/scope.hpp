@@ -29,6 +29,7 @@
 #include <string>
 
 #include "file.hpp"
+#include "string_view.hpp"
 #include "utils.hpp"
 
 namespace Core {
@@ -57,14 +58,28 @@ namespace Core {
   };
 
   struct Scope;
+  class ScopeIndex;
   using ScopeVector = std::vector<Scope>;
+  using ScopeRefVector = std::vector<std::reference_wrapper<const Scope>>;
 
+  // Scopes own their whole subtree and are move-only, parent pointers would dangle in a copy.
+  // clone() has to be used explicitly when a scope needs to be duplicated.
   struct Scope {
-    Scope() {};
+    Scope();
     Scope(ScopeType type);
+    Scope(const Scope& other) = delete;
+    Scope(Scope&& other) noexcept;
+    Scope& operator=(const Scope& other) = delete;
+    Scope& operator=(Scope&& other) noexcept;
+    ~Scope();
+
+    Scope clone() const;
     
-    ScopeVector getDirectChildrenOfType(ScopeType type) const;
-    ScopeVector getAllChildrenOfType(ScopeType type) const;
+    ScopeRefVector getDirectChildrenOfType(ScopeType type) const;
+    ScopeRefVector getAllChildrenOfType(ScopeType type) const;
+    // Calls visitor(const Scope&) on every descendant matching the type mask, depth first, without copying
+    template<typename Visitor>
+    void forEachChildOfType(ScopeType type, Visitor&& visitor) const;
     unsigned int getDepth() const;
     std::string getTree() const; //Debug Function
     bool isWithinOtherScope(const Scope& other) const;
@@ -83,11 +98,28 @@ namespace Core {
     unsigned int characterNumberStart = 0;
     unsigned int characterNumberEnd = 0;
     std::string name;
-    std::vector<std::string> getScopeLines() const;
+    // Views into the file lines covered by the scope, they live as long as the file does
+    std::vector<StringView> getScopeLines() const;
+    // A single one of those views, lineNumber has to be covered by the scope and within the file
+    StringView getScopeLine(unsigned int lineNumber) const;
     File* file = nullptr;
     Scope* parent = nullptr;
+    // Only set on root scopes once the tree is constructed, used by getAllChildrenOfType
+    std::unique_ptr<const ScopeIndex> typeIndex;
   };
 
+  constexpr ScopeType operator&(ScopeType lhs, ScopeType rhs);
+
+  template<typename Visitor>
+  void Scope::forEachChildOfType(ScopeType typeToVisit, Visitor&& visitor) const {
+    for(const auto& child : children) {
+      if(static_cast<unsigned int>(child.type & typeToVisit) != 0) {
+        visitor(child);
+      }
+      child.forEachChildOfType(typeToVisit, visitor);
+    }
+  }
+
   inline bool operator==(const Scope& lhs, const Scope& rhs) {
     bool isSameNumbers = lhs.lineNumberStart == rhs.lineNumberStart
       && lhs.lineNumberEnd == rhs.lineNumberEnd
@@ -110,6 +142,9 @@ namespace Core {
     return !(lhs == rhs);
   }
 
+  // Replaces the characters of lines covered by the scope, both ends included, with spaces so positions are kept
+  void blankOutScope(std::vector<std::string>& lines, const Scope& scope);
+
   std::string to_string(ScopeType type);
   inline std::ostream& operator<<(std::ostream& out, const Scope& scope) {
     if(!scope.file) {
@@ -251,7 +286,7 @@ namespace Core {
     return ScopeType::Unknown;
   }
 
-  inline ScopeType operator&(ScopeType lhs, ScopeType rhs) {
+  constexpr ScopeType operator&(ScopeType lhs, ScopeType rhs) {
     using Underlying = std::underlying_type<ScopeType>::type;
     return static_cast<ScopeType>(
       static_cast<Underlying>(lhs) &
@@ -259,7 +294,7 @@ namespace Core {
       );
   }
 
-  inline ScopeType operator|(ScopeType lhs, ScopeType rhs) {
+  constexpr ScopeType operator|(ScopeType lhs, ScopeType rhs) {
     using Underlying = std::underlying_type<ScopeType>::type;
     return static_cast<ScopeType>(
       static_cast<Underlying>(lhs) |
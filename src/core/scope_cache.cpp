@@ -0,0 +1,360 @@
+/* MIT License
+ *
+ * Copyright (c) 2018 Jean-Sebastien Fauteux, Michel Rioux, Raphaël Massabot
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <cstring>
+#include <cstdio>
+#include <fstream>
+#include <iomanip>
+#include <limits>
+#include <sstream>
+#include <thread>
+#include <unordered_map>
+
+#include "scope_cache.hpp"
+#include "scope_index.hpp"
+#include "config.hpp"
+
+#ifdef UNIX
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace Core {
+
+  namespace {
+
+    const char Magic[8] = {'S', 'I', 'F', 'T', 'S', 'C', 'P', '\0'};
+    const std::uint32_t NoIndex = std::numeric_limits<std::uint32_t>::max();
+
+    struct EntryHeader {
+      char magic[8];
+      std::uint32_t version;
+      std::uint32_t lineCount;
+      std::uint64_t contentHash;
+      std::uint32_t scopeCount;
+      std::uint32_t stringLiteralCount;
+      std::uint32_t commentCount;
+      std::uint32_t defineCount;
+      std::uint32_t nameTableSize;
+      std::uint32_t reserved;
+    };
+
+    struct ScopeRecord {
+      std::uint32_t type;
+      std::uint32_t treeParent; // Record whose children contain this scope
+      std::uint32_t parent;     // Record pointed to by Scope::parent, not always the tree parent
+      std::uint32_t lineNumberStart;
+      std::uint32_t lineNumberEnd;
+      std::uint32_t characterNumberStart;
+      std::uint32_t characterNumberEnd;
+      std::uint32_t nameOffset;
+      std::uint32_t nameLength;
+    };
+
+    static_assert(sizeof(EntryHeader) == 48, "Scope cache header layout changed, bump ScopeCache::Version");
+    static_assert(sizeof(ScopeRecord) == 36, "Scope cache record layout changed, bump ScopeCache::Version");
+
+    // Read-only view of a whole file, mapped when the platform allows it
+    class MappedFile {
+    public:
+      explicit MappedFile(const std::string& filename) {
+      #if defined(UNIX)
+        int descriptor = open(filename.c_str(), O_RDONLY);
+        if(descriptor < 0) {
+          return;
+        }
+
+        struct stat info;
+        if(fstat(descriptor, &info) == 0 && info.st_size > 0) {
+          void* address = mmap(nullptr, info.st_size, PROT_READ, MAP_PRIVATE, descriptor, 0);
+          if(address != MAP_FAILED) {
+            m_data = static_cast<const char*>(address);
+            m_size = info.st_size;
+          }
+        }
+        close(descriptor);
+      #else
+        std::ifstream stream(filename, std::ios::binary);
+        if(stream.is_open()) {
+          m_buffer.assign(std::istreambuf_iterator<char>(stream), std::istreambuf_iterator<char>());
+          m_data = m_buffer.data();
+          m_size = m_buffer.size();
+        }
+      #endif
+      }
+
+      ~MappedFile() {
+      #if defined(UNIX)
+        if(m_data) {
+          munmap(const_cast<char*>(m_data), m_size);
+        }
+      #endif
+      }
+
+      MappedFile(const MappedFile&) = delete;
+      MappedFile& operator=(const MappedFile&) = delete;
+
+      const char* data() const { return m_data; }
+      std::size_t size() const { return m_size; }
+
+    private:
+      const char* m_data = nullptr;
+      std::size_t m_size = 0;
+    #if !defined(UNIX)
+      std::vector<char> m_buffer;
+    #endif
+    };
+
+    ScopeRecord makeRecord(const Scope& scope, std::uint32_t treeParent, std::string& names) {
+      ScopeRecord record;
+      record.type = static_cast<std::uint32_t>(scope.type);
+      record.treeParent = treeParent;
+      record.parent = NoIndex;
+      record.lineNumberStart = scope.lineNumberStart;
+      record.lineNumberEnd = scope.lineNumberEnd;
+      record.characterNumberStart = scope.characterNumberStart;
+      record.characterNumberEnd = scope.characterNumberEnd;
+      record.nameOffset = names.size();
+      record.nameLength = scope.name.size();
+      names += scope.name;
+      return record;
+    }
+
+    void appendTree(const Scope& scope, std::uint32_t treeParent, std::vector<ScopeRecord>& records,
+                    std::vector<const Scope*>& order, std::string& names) {
+      const std::uint32_t index = records.size();
+      records.push_back(makeRecord(scope, treeParent, names));
+      order.push_back(&scope);
+
+      for(const auto& child : scope.children) {
+        appendTree(child, index, records, order, names);
+      }
+    }
+
+    void appendFlat(const std::vector<Scope>& scopes, std::vector<ScopeRecord>& records, std::string& names) {
+      for(const auto& scope : scopes) {
+        records.push_back(makeRecord(scope, NoIndex, names));
+      }
+    }
+
+    void fillScope(Scope& scope, const ScopeRecord& record, const char* names, File& file) {
+      scope.type = static_cast<ScopeType>(record.type);
+      scope.lineNumberStart = record.lineNumberStart;
+      scope.lineNumberEnd = record.lineNumberEnd;
+      scope.characterNumberStart = record.characterNumberStart;
+      scope.characterNumberEnd = record.characterNumberEnd;
+      scope.name.assign(names + record.nameOffset, record.nameLength);
+      scope.file = &file;
+    }
+
+    // Children are reserved up front so the addresses taken afterward for parent links never move
+    void buildChildren(Scope& scope, std::uint32_t index, const ScopeRecord* records,
+                       const std::vector<std::vector<std::uint32_t>>& childIndices, const char* names, File& file) {
+      scope.children.reserve(childIndices[index].size());
+      for(auto childIndex : childIndices[index]) {
+        scope.children.emplace_back();
+        fillScope(scope.children.back(), records[childIndex], names, file);
+        buildChildren(scope.children.back(), childIndex, records, childIndices, names, file);
+      }
+    }
+
+    void collectPreOrder(Scope& scope, std::vector<Scope*>& order) {
+      order.push_back(&scope);
+      for(auto& child : scope.children) {
+        collectPreOrder(child, order);
+      }
+    }
+
+    std::vector<Scope> readFlat(const ScopeRecord* records, std::uint32_t count, const char* names, File& file) {
+      std::vector<Scope> scopes(count);
+      for(std::uint32_t i = 0; i < count; ++i) {
+        fillScope(scopes[i], records[i], names, file);
+      }
+      return scopes;
+    }
+
+  }
+
+  ScopeCache::ScopeCache(const std::string& directory)
+    : m_directory(directory)
+  {
+  }
+
+  std::uint64_t ScopeCache::hashContent(const File& file) {
+    // FNV-1a, lines are hashed with their separator so joining or splitting lines changes the key
+    std::uint64_t hash = 14695981039346656037ull;
+    auto addByte = [&hash](unsigned char byte) {
+      hash ^= byte;
+      hash *= 1099511628211ull;
+    };
+
+    for(const auto& line : file.lines) {
+      for(const auto c : line) {
+        addByte(static_cast<unsigned char>(c));
+      }
+      addByte('\n');
+    }
+
+    return hash;
+  }
+
+  std::string ScopeCache::getEntryFilename(const File& file) const {
+    std::ostringstream filename;
+    filename << m_directory << "/" << std::hex << std::setw(16) << std::setfill('0') << hashContent(file) << ".scopes";
+    return filename.str();
+  }
+
+  bool ScopeCache::load(File& file, Scope& outRoot, std::vector<Scope>& outStringLiterals,
+                        std::vector<Scope>& outComments, std::vector<Scope>& outDefines) const {
+    MappedFile entry(getEntryFilename(file));
+    if(!entry.data() || entry.size() < sizeof(EntryHeader)) {
+      return false;
+    }
+
+    const EntryHeader& header = *reinterpret_cast<const EntryHeader*>(entry.data());
+    if(std::memcmp(header.magic, Magic, sizeof(Magic)) != 0
+       || header.version != Version
+       || header.contentHash != hashContent(file)
+       || header.lineCount != file.lines.size()
+       || header.scopeCount == 0) {
+      return false;
+    }
+
+    const std::uint64_t recordCount = std::uint64_t(header.scopeCount) + header.stringLiteralCount
+      + header.commentCount + header.defineCount;
+    if(entry.size() != sizeof(EntryHeader) + recordCount * sizeof(ScopeRecord) + header.nameTableSize) {
+      LOG(WARNING) << "Ignoring truncated scope cache entry for '" << file.filename << "'";
+      return false;
+    }
+
+    const ScopeRecord* records = reinterpret_cast<const ScopeRecord*>(entry.data() + sizeof(EntryHeader));
+    const char* names = entry.data() + sizeof(EntryHeader) + recordCount * sizeof(ScopeRecord);
+
+    std::vector<std::vector<std::uint32_t>> childIndices(header.scopeCount);
+    for(std::uint64_t i = 0; i < recordCount; ++i) {
+      const ScopeRecord& record = records[i];
+      const bool isTreeRecord = i < header.scopeCount;
+      const bool badTreeParent = isTreeRecord ? (i > 0 && record.treeParent >= i) : record.treeParent != NoIndex;
+      if(badTreeParent
+         || (record.parent != NoIndex && record.parent >= header.scopeCount)
+         || std::uint64_t(record.nameOffset) + record.nameLength > header.nameTableSize) {
+        LOG(WARNING) << "Ignoring corrupted scope cache entry for '" << file.filename << "'";
+        return false;
+      }
+
+      if(isTreeRecord && i > 0) {
+        childIndices[record.treeParent].push_back(i);
+      }
+    }
+
+    Scope root;
+    fillScope(root, records[0], names, file);
+    root.name = file.filename;
+    buildChildren(root, 0, records, childIndices, names, file);
+
+    outRoot = std::move(root);
+
+    std::vector<Scope*> order;
+    order.reserve(header.scopeCount);
+    collectPreOrder(outRoot, order);
+    for(std::uint32_t i = 0; i < header.scopeCount; ++i) {
+      order[i]->parent = records[i].parent == NoIndex ? nullptr : order[records[i].parent];
+    }
+    outRoot.typeIndex = std::make_unique<ScopeIndex>(outRoot);
+
+    records += header.scopeCount;
+    outStringLiterals = readFlat(records, header.stringLiteralCount, names, file);
+    records += header.stringLiteralCount;
+    outComments = readFlat(records, header.commentCount, names, file);
+    records += header.commentCount;
+    outDefines = readFlat(records, header.defineCount, names, file);
+
+    return true;
+  }
+
+  bool ScopeCache::store(const File& file, const Scope& root, const std::vector<Scope>& stringLiterals,
+                         const std::vector<Scope>& comments, const std::vector<Scope>& defines) const {
+    std::vector<ScopeRecord> records;
+    std::vector<const Scope*> order;
+    std::string names;
+
+    appendTree(root, NoIndex, records, order, names);
+
+    std::unordered_map<const Scope*, std::uint32_t> indices;
+    for(std::uint32_t i = 0; i < order.size(); ++i) {
+      indices[order[i]] = i;
+    }
+    for(std::uint32_t i = 0; i < order.size(); ++i) {
+      auto it = indices.find(order[i]->parent);
+      records[i].parent = it != indices.end() ? it->second : NoIndex;
+    }
+
+    appendFlat(stringLiterals, records, names);
+    appendFlat(comments, records, names);
+    appendFlat(defines, records, names);
+
+    EntryHeader header;
+    std::memcpy(header.magic, Magic, sizeof(Magic));
+    header.version = Version;
+    header.lineCount = file.lines.size();
+    header.contentHash = hashContent(file);
+    header.scopeCount = order.size();
+    header.stringLiteralCount = stringLiterals.size();
+    header.commentCount = comments.size();
+    header.defineCount = defines.size();
+    header.nameTableSize = names.size();
+    header.reserved = 0;
+
+    // Written aside then renamed, a reader never maps a partially written entry. Files with the
+    // same content share their entry, each thread writes its own temporary one.
+    const std::string filename = getEntryFilename(file);
+    const std::string temporaryFilename = filename + "." + std::to_string(std::hash<std::thread::id>()(std::this_thread::get_id())) + ".tmp";
+    {
+      std::ofstream stream(temporaryFilename, std::ios::binary | std::ios::trunc);
+      if(!stream.is_open()) {
+        LOG(ERROR) << "Could not write scope cache entry '" << temporaryFilename << "'";
+        return false;
+      }
+
+      stream.write(reinterpret_cast<const char*>(&header), sizeof(header));
+      stream.write(reinterpret_cast<const char*>(records.data()), records.size() * sizeof(ScopeRecord));
+      stream.write(names.data(), names.size());
+      if(!stream.good()) {
+        LOG(ERROR) << "Could not write scope cache entry '" << temporaryFilename << "'";
+        return false;
+      }
+    }
+
+    std::remove(filename.c_str());
+    if(std::rename(temporaryFilename.c_str(), filename.c_str()) != 0) {
+      LOG(ERROR) << "Could not move scope cache entry to '" << filename << "'";
+      std::remove(temporaryFilename.c_str());
+      return false;
+    }
+
+    return true;
+  }
+
+}
@@ -0,0 +1,61 @@
+/* MIT License
+ *
+ * Copyright (c) 2018 Jean-Sebastien Fauteux, Michel Rioux, Raphaël Massabot
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "file.hpp"
+#include "scope.hpp"
+
+namespace Core {
+
+  // On-disk cache of what the scope extractor produces for a file, keyed by a hash of the file content.
+  // An entry is a fixed size header followed by fixed size scope records and a name table:
+  //   header | tree records (pre-order, root first) | string literals | comments | defines | names
+  // Records are plain 32 bits fields read in place from the mapped file, so loading does no text parsing:
+  // it rebuilds each Scope from its record and copies its name out of the name table.
+  // The layout is native endian and only meant to be reused on the machine that wrote it.
+  class ScopeCache {
+  public:
+    static const std::uint32_t Version = 1; /* Bump whenever the layout or the extractor output changes */
+
+    explicit ScopeCache(const std::string& directory);
+
+    // Restores the constructed tree of a file, false when there is no valid entry for its content
+    bool load(File& file, Scope& outRoot, std::vector<Scope>& outStringLiterals,
+              std::vector<Scope>& outComments, std::vector<Scope>& outDefines) const;
+    // Root has to be the constructed tree, entries are only ever replaced as a whole
+    bool store(const File& file, const Scope& root, const std::vector<Scope>& stringLiterals,
+               const std::vector<Scope>& comments, const std::vector<Scope>& defines) const;
+
+    std::string getEntryFilename(const File& file) const;
+    static std::uint64_t hashContent(const File& file);
+
+  private:
+    std::string m_directory;
+  };
+
+}
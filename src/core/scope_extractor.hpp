@@ -23,10 +23,15 @@
 
 #pragma once
 
+#include <map>
+#include <string>
+#include <vector>
+
+#include "scope.hpp"
+
 namespace Core {
 
   struct File;
-  struct Scope;
 
   class ScopeExtractor {
   public:
@@ -41,9 +46,38 @@ namespace Core {
       return m_comments;
     }
 
+    const std::map<std::string, std::vector<Scope>>& getDefines() const {
+      return m_defineScopes;
+    }
+
+    // Makes room for what the extraction of filename records on the side. Files extracted concurrently
+    // must all be added first, each extraction then only touches the entries of its own file.
+    void addFile(const std::string& filename) {
+      m_stringLiterals[filename];
+      m_comments[filename];
+      m_defineScopes[filename];
+    }
+
+    // Puts back what the extraction of a file records on the side, when its tree comes from the scope cache
+    void restoreFile(const std::string& filename, std::vector<Scope> stringLiterals, std::vector<Scope> comments, std::vector<Scope> defines) {
+      getFileScopes(m_stringLiterals, filename) = std::move(stringLiterals);
+      getFileScopes(m_comments, filename) = std::move(comments);
+      getFileScopes(m_defineScopes, filename) = std::move(defines);
+    }
+
   protected:
+    // Looks the entry of filename up without inserting into the map when addFile already made it
+    static std::vector<Scope>& getFileScopes(std::map<std::string, std::vector<Scope>>& scopesByFile, const std::string& filename) {
+      auto it = scopesByFile.find(filename);
+      if(it == scopesByFile.end()) {
+        it = scopesByFile.emplace(filename, std::vector<Scope>()).first;
+      }
+      return it->second;
+    }
+
     std::map<std::string, std::vector<Scope>> m_stringLiterals;
     std::map<std::string, std::vector<Scope>> m_comments;
+    std::map<std::string, std::vector<Scope>> m_defineScopes;
   };
 
 }
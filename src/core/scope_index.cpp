@@ -0,0 +1,83 @@
+/* MIT License
+ *
+ * Copyright (c) 2018 Jean-Sebastien Fauteux, Michel Rioux, Raphaël Massabot
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <algorithm>
+
+#include "scope_index.hpp"
+
+namespace Core {
+
+  ScopeIndex::ScopeIndex(const Scope& root)
+  {
+    indexChildren(root);
+  }
+
+  void ScopeIndex::indexChildren(const Scope& scope) {
+    for(const auto& child : scope.children) {
+      const unsigned int position = m_scopes.size();
+      m_scopes.push_back(&child);
+
+      const unsigned int type = static_cast<unsigned int>(child.type);
+      for(unsigned int bit = 0; bit < TypeBitCount; ++bit) {
+        if((type & (1u << bit)) != 0) {
+          m_positionsByType[bit].push_back(position);
+        }
+      }
+
+      indexChildren(child);
+    }
+  }
+
+  ScopeRefVector ScopeIndex::getScopesOfType(ScopeType type) const {
+    const unsigned int mask = static_cast<unsigned int>(type);
+    std::vector<unsigned int> positions;
+    unsigned int bucketCount = 0;
+
+    for(unsigned int bit = 0; bit < TypeBitCount; ++bit) {
+      const auto& bucket = m_positionsByType[bit];
+      if((mask & (1u << bit)) != 0 && !bucket.empty()) {
+        positions.insert(positions.end(), bucket.begin(), bucket.end());
+        ++bucketCount;
+      }
+    }
+
+    //Scopes of several types have to be put back in tree order
+    if(bucketCount > 1) {
+      std::sort(positions.begin(), positions.end());
+      positions.erase(std::unique(positions.begin(), positions.end()), positions.end());
+    }
+
+    ScopeRefVector toReturn;
+    toReturn.reserve(positions.size());
+    for(const auto position : positions) {
+      toReturn.push_back(std::cref(*m_scopes[position]));
+    }
+
+    return toReturn;
+  }
+
+  std::size_t ScopeIndex::size() const {
+    return m_scopes.size();
+  }
+
+}
@@ -0,0 +1,58 @@
+/* MIT License
+ *
+ * Copyright (c) 2018 Jean-Sebastien Fauteux, Michel Rioux, Raphaël Massabot
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include <array>
+#include <vector>
+
+#include "scope.hpp"
+
+namespace Core {
+
+  // Flat lookup from every ScopeType bit to the scopes of that type below a root scope.
+  // Built once the tree is final, the pointers stay valid as long as no children are added or removed.
+  // Moving the root keeps them valid, children buffers are moved along with it.
+  class ScopeIndex {
+  public:
+    explicit ScopeIndex(const Scope& root);
+
+    // Same content and order as a depth first traversal of the root filtered by type
+    ScopeRefVector getScopesOfType(ScopeType type) const;
+    std::size_t size() const;
+
+    // Scope types are single bits, up to ScopeType::Unknown
+    static const unsigned int TypeBitCount = 21;
+
+  private:
+
+    void indexChildren(const Scope& scope);
+
+    std::vector<const Scope*> m_scopes; // Depth first order
+    std::array<std::vector<unsigned int>, TypeBitCount> m_positionsByType;
+  };
+
+  static_assert(static_cast<unsigned int>(ScopeType::Unknown) == 1u << (ScopeIndex::TypeBitCount - 1),
+                "ScopeIndex::TypeBitCount has to cover every ScopeType bit");
+
+}
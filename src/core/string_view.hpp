@@ -0,0 +1,100 @@
+/* MIT License
+ *
+ * Copyright (c) 2018 Jean-Sebastien Fauteux, Michel Rioux, Raphaël Massabot
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <cstring>
+#include <ostream>
+#include <string>
+
+namespace Core {
+
+  // Non-owning view over a range of characters, typically part of a line of a File.
+  // The referenced string must outlive the view.
+  class StringView {
+  public:
+    using const_iterator = const char*;
+    static const std::size_t npos = std::string::npos;
+
+    StringView() {}
+    StringView(const char* data, std::size_t size)
+      : m_data(data)
+      , m_size(size) {}
+    StringView(const std::string& str)
+      : m_data(str.data())
+      , m_size(str.size()) {}
+
+    const char* data() const { return m_data; }
+    std::size_t size() const { return m_size; }
+    bool empty() const { return m_size == 0; }
+    const_iterator begin() const { return m_data; }
+    const_iterator end() const { return m_data + m_size; }
+    const char& operator[](std::size_t pos) const { return m_data[pos]; }
+
+    // Same semantics as std::string::substr, except that an out of range position yields an empty view
+    StringView substr(std::size_t pos, std::size_t count = npos) const {
+      if(pos > m_size) {
+        return StringView(end(), 0);
+      }
+      return StringView(m_data + pos, std::min(count, m_size - pos));
+    }
+
+    std::size_t find(char c, std::size_t pos = 0) const {
+      if(pos >= m_size) {
+        return npos;
+      }
+      const void* found = std::memchr(m_data + pos, c, m_size - pos);
+      return found ? static_cast<const char*>(found) - m_data : npos;
+    }
+
+    std::size_t find(const std::string& str, std::size_t pos = 0) const {
+      if(pos > m_size || str.size() > m_size - pos) {
+        return npos;
+      }
+      auto it = std::search(begin() + pos, end(), str.begin(), str.end());
+      return it == end() ? npos : it - begin();
+    }
+
+    std::string str() const {
+      return std::string(m_data, m_size);
+    }
+
+  private:
+    const char* m_data = "";
+    std::size_t m_size = 0;
+  };
+
+  inline bool operator==(const StringView& lhs, const StringView& rhs) {
+    return lhs.size() == rhs.size() && std::equal(lhs.begin(), lhs.end(), rhs.begin());
+  }
+
+  inline bool operator!=(const StringView& lhs, const StringView& rhs) {
+    return !(lhs == rhs);
+  }
+
+  inline std::ostream& operator<<(std::ostream& out, const StringView& view) {
+    return out.write(view.data(), view.size());
+  }
+
+}
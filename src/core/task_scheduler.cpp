@@ -0,0 +1,146 @@
+/* MIT License
+ *
+ * Copyright (c) 2018 Jean-Sebastien Fauteux, Michel Rioux, Raphaël Massabot
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "task_scheduler.hpp"
+
+#include <algorithm>
+
+namespace Core {
+
+  TaskScheduler::TaskScheduler(unsigned int threadCount)
+    : m_threadCount(threadCount != 0 ? threadCount : std::max(1u, std::thread::hardware_concurrency()))
+    , m_queues(m_threadCount) {
+    m_threads.reserve(m_threadCount - 1);
+    for(std::size_t worker = 1; worker < m_threadCount; ++worker) {
+      m_threads.emplace_back(&TaskScheduler::waitForBatches, this, worker);
+    }
+  }
+
+  TaskScheduler::~TaskScheduler() {
+    {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      m_stopping = true;
+    }
+    m_batchStarted.notify_all();
+    for(auto& thread : m_threads) {
+      thread.join();
+    }
+  }
+
+  void TaskScheduler::waitForBatches(std::size_t worker) {
+    std::size_t batch = 0;
+    for(;;) {
+      {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_batchStarted.wait(lock, [this, batch]() { return m_stopping || m_batch != batch; });
+        if(m_stopping) {
+          return;
+        }
+        batch = m_batch;
+      }
+
+      work(worker);
+
+      std::lock_guard<std::mutex> lock(m_mutex);
+      if(--m_busyThreads == 0) {
+        m_batchDone.notify_one();
+      }
+    }
+  }
+
+  bool TaskScheduler::takeTask(std::size_t worker, std::size_t& task) {
+    {
+      std::lock_guard<std::mutex> lock(m_queues[worker].mutex);
+      if(!m_queues[worker].tasks.empty()) {
+        task = m_queues[worker].tasks.front();
+        m_queues[worker].tasks.pop_front();
+        return true;
+      }
+    }
+    // No task is added once a batch runs, every queue being empty means the batch is done
+    for(std::size_t i = 1; i < m_queues.size(); ++i) {
+      Queue& victim = m_queues[(worker + i) % m_queues.size()];
+      std::lock_guard<std::mutex> lock(victim.mutex);
+      if(!victim.tasks.empty()) {
+        task = victim.tasks.back();
+        victim.tasks.pop_back();
+        return true;
+      }
+    }
+    return false;
+  }
+
+  void TaskScheduler::work(std::size_t worker) {
+    const std::function<void(std::size_t)>* task;
+    {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      task = m_task;
+    }
+
+    std::size_t index;
+    while(takeTask(worker, index)) {
+      try {
+        (*task)(index);
+      } catch(...) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if(!m_error) {
+          m_error = std::current_exception();
+        }
+      }
+    }
+  }
+
+  void TaskScheduler::run(std::size_t taskCount, const std::function<void(std::size_t)>& task) {
+    if(taskCount == 0) {
+      return;
+    }
+
+    for(std::size_t i = 0; i < taskCount; ++i) {
+      Queue& queue = m_queues[i % m_queues.size()];
+      std::lock_guard<std::mutex> lock(queue.mutex);
+      queue.tasks.push_back(i);
+    }
+    {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      m_task = &task;
+      m_error = nullptr;
+      m_busyThreads = m_threads.size();
+      ++m_batch;
+    }
+    m_batchStarted.notify_all();
+
+    work(0);
+
+    std::exception_ptr error;
+    {
+      std::unique_lock<std::mutex> lock(m_mutex);
+      m_batchDone.wait(lock, [this]() { return m_busyThreads == 0; });
+      m_task = nullptr;
+      std::swap(error, m_error);
+    }
+    if(error) {
+      std::rethrow_exception(error);
+    }
+  }
+
+}
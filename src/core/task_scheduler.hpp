@@ -0,0 +1,82 @@
+/* MIT License
+ *
+ * Copyright (c) 2018 Jean-Sebastien Fauteux, Michel Rioux, Raphaël Massabot
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace Core {
+
+  // Runs batches of independent tasks on a fixed number of threads. The tasks of a batch are dealt
+  // round robin to the workers in index order, so callers put their largest tasks first. Each worker
+  // runs its own tasks in that order, then steals from the end of the others until none is left.
+  // The threads live as long as the scheduler and wait for the next batch in between.
+  class TaskScheduler {
+  public:
+    // 0 uses a thread per core
+    explicit TaskScheduler(unsigned int threadCount = 0);
+    ~TaskScheduler();
+    TaskScheduler(const TaskScheduler&) = delete;
+    TaskScheduler& operator=(const TaskScheduler&) = delete;
+
+    unsigned int getThreadCount() const { return m_threadCount; }
+    // Calls task(i) for every i below taskCount and returns once they are all done. The calling
+    // thread is one of the workers. The first exception a task throws is rethrown at the end.
+    // One batch at a time, never from one of its own tasks.
+    void run(std::size_t taskCount, const std::function<void(std::size_t)>& task);
+
+  private:
+    struct Queue {
+      std::mutex mutex;
+      std::deque<std::size_t> tasks;
+    };
+
+    void waitForBatches(std::size_t worker);
+    // Runs tasks of the current batch until every queue is empty
+    void work(std::size_t worker);
+    bool takeTask(std::size_t worker, std::size_t& task);
+
+    unsigned int m_threadCount;
+    // One per worker, the calling thread being worker 0
+    std::vector<Queue> m_queues;
+    std::vector<std::thread> m_threads;
+
+    std::mutex m_mutex;
+    std::condition_variable m_batchStarted;
+    std::condition_variable m_batchDone;
+    // Guarded by m_mutex
+    const std::function<void(std::size_t)>* m_task = nullptr;
+    std::size_t m_batch = 0;
+    std::size_t m_busyThreads = 0;
+    bool m_stopping = false;
+    std::exception_ptr m_error;
+  };
+
+}
@@ -36,6 +36,7 @@
 
 #ifdef UNIX
 #include <dirent.h>
+#include <sys/stat.h>
 #else
 #include <Windows.h>
 #endif
@@ -164,6 +165,24 @@ namespace Core {
     return false;
   }
 
+  // True when the directory exists afterward, whether it was created or already there
+  inline bool createDirectory(const std::string& directory)
+  {
+    if(directory.empty()) {
+      return false;
+    }
+
+    #if defined(UNIX)
+    mkdir(directory.c_str(), 0755);
+    #elif defined(WIN32)
+    CreateDirectoryA(directory.c_str(), nullptr);
+    #else
+    #error "Current platform not supported"
+    #endif
+
+    return directoryExists(directory);
+  }
+
   struct FilesystemItem
   {
     bool isDirectory = false;
@@ -0,0 +1,207 @@
+/* MIT License
+ *
+ * Copyright (c) 2018 Jean-Sebastien Fauteux, Michel Rioux, Raphaël Massabot
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "control_flow_graph.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <unordered_set>
+
+namespace Flow {
+
+  const Core::Scope* getFlowScope(const Core::Scope& scope) {
+    const Core::Scope* flowScope = nullptr;
+    for(const Core::Scope* parent = scope.parent; parent; parent = parent->parent) {
+      if(parent->isOfType(Core::ScopeType::Function) || parent->isOfType(Core::ScopeType::Conditional)) {
+        flowScope = parent;
+      }
+    }
+    return flowScope;
+  }
+
+  VariableSet::VariableSet(std::size_t size)
+  : m_words((size + 63) / 64, 0) {
+  }
+
+  bool VariableSet::test(std::size_t variable) const {
+    return (m_words[variable / 64] & (std::uint64_t(1) << (variable % 64))) != 0;
+  }
+
+  void VariableSet::set(std::size_t variable) {
+    m_words[variable / 64] |= std::uint64_t(1) << (variable % 64);
+  }
+
+  void VariableSet::reset(std::size_t variable) {
+    m_words[variable / 64] &= ~(std::uint64_t(1) << (variable % 64));
+  }
+
+  bool VariableSet::unite(const VariableSet& other) {
+    bool changed = false;
+    for(std::size_t i = 0; i < m_words.size(); ++i) {
+      const std::uint64_t united = m_words[i] | other.m_words[i];
+      changed |= united != m_words[i];
+      m_words[i] = united;
+    }
+    return changed;
+  }
+
+  ControlFlowGraph::ControlFlowGraph(const Core::Scope& function, std::vector<const Core::Scope*> conditionals)
+  : m_function(function)
+  , m_endLine(std::max(function.lineNumberStart, function.lineNumberEnd)) {
+    std::stable_sort(conditionals.begin(), conditionals.end(), [](const Core::Scope* lhs, const Core::Scope* rhs) {
+      return lhs->lineNumberStart < rhs->lineNumberStart;
+    });
+
+    // The later a conditional starts the deeper it is, so a line shared by an if and its else belongs to the else
+    const std::size_t lineCount = m_endLine - function.lineNumberStart + 1;
+    m_owners.assign(lineCount, &function);
+    for(const Core::Scope* conditional : conditionals) {
+      const unsigned int lastLine = std::min(conditional->lineNumberEnd, m_endLine);
+      for(unsigned int line = std::max(conditional->lineNumberStart, function.lineNumberStart); line <= lastLine; ++line) {
+        m_owners[line - function.lineNumberStart] = conditional;
+      }
+    }
+
+    const std::unordered_set<const Core::Scope*> known(conditionals.begin(), conditionals.end());
+    for(const Core::Scope* conditional : conditionals) {
+      const Core::Scope* parent = known.count(conditional->parent) ? conditional->parent : &function;
+      m_children[parent].push_back(conditional);
+    }
+
+    m_blockOfLine.assign(lineCount, 0);
+    buildRegion(function, addBlock());
+  }
+
+  std::size_t ControlFlowGraph::getBlockOfLine(unsigned int line) const {
+    if(line < m_function.lineNumberStart || line > m_endLine) {
+      return 0;
+    }
+    return m_blockOfLine[line - m_function.lineNumberStart];
+  }
+
+  std::size_t ControlFlowGraph::addBlock() {
+    m_blocks.emplace_back();
+    return m_blocks.size() - 1;
+  }
+
+  void ControlFlowGraph::addEdge(std::size_t from, std::size_t to) {
+    m_blocks[from].successors.push_back(to);
+  }
+
+  // Returns the block where control is once the region is done
+  std::size_t ControlFlowGraph::buildRegion(const Core::Scope& region, std::size_t entry) {
+    static const ScopeRefs noChildren;
+    const auto childrenIt = m_children.find(&region);
+    const ScopeRefs& children = childrenIt != m_children.end() ? childrenIt->second : noChildren;
+
+    std::size_t current = entry;
+    std::size_t next = 0;
+    unsigned int line = std::max(region.lineNumberStart, m_function.lineNumberStart);
+    const unsigned int lastLine = &region == &m_function ? m_endLine : std::min(region.lineNumberEnd, m_endLine);
+    while(line <= lastLine) {
+      if(next < children.size() && children[next]->lineNumberStart <= line) {
+        // An if and the else following it are a single choice
+        ScopeRefs chain = {children[next++]};
+        if(chain.front()->name == "if") {
+          while(next < children.size() && children[next]->name == "else" && !isPlainElse(*chain.back())) {
+            chain.push_back(children[next++]);
+          }
+        }
+        unsigned int chainEnd = line;
+        for(const Core::Scope* conditional : chain) {
+          chainEnd = std::max(chainEnd, conditional->lineNumberEnd);
+        }
+        current = buildChain(chain, current);
+        line = chainEnd + 1;
+        continue;
+      }
+
+      if(getOwner(line) == &region) {
+        m_blocks[current].lines.push_back(line);
+        m_blockOfLine[line - m_function.lineNumberStart] = current;
+      }
+      ++line;
+    }
+    return current;
+  }
+
+  std::size_t ControlFlowGraph::buildChain(const ScopeRefs& chain, std::size_t entry) {
+    const std::string& kind = chain.front()->name;
+    if(kind == "for" || kind == "while") {
+      const std::size_t head = addBlock();
+      addEdge(entry, head);
+      const std::size_t body = addBlock();
+      addEdge(head, body);
+      addEdge(buildRegion(*chain.front(), body), head);
+      const std::size_t exit = addBlock();
+      addEdge(head, exit);
+      return exit;
+    }
+
+    if(kind == "do") {
+      const std::size_t body = addBlock();
+      addEdge(entry, body);
+      const std::size_t bodyEnd = buildRegion(*chain.front(), body);
+      addEdge(bodyEnd, body);
+      const std::size_t exit = addBlock();
+      addEdge(bodyEnd, exit);
+      return exit;
+    }
+
+    // if, else and switch, each body may run and nothing runs unless the chain ends with a plain else
+    std::vector<std::size_t> bodyEnds;
+    for(const Core::Scope* conditional : chain) {
+      const std::size_t body = addBlock();
+      addEdge(entry, body);
+      bodyEnds.push_back(buildRegion(*conditional, body));
+    }
+    const std::size_t exit = addBlock();
+    for(std::size_t bodyEnd : bodyEnds) {
+      addEdge(bodyEnd, exit);
+    }
+    if(chain.size() == 1 || !isPlainElse(*chain.back())) {
+      addEdge(entry, exit);
+    }
+    return exit;
+  }
+
+  const Core::Scope* ControlFlowGraph::getOwner(unsigned int line) const {
+    return m_owners[line - m_function.lineNumberStart];
+  }
+
+  bool ControlFlowGraph::isPlainElse(const Core::Scope& conditional) const {
+    if(conditional.name != "else" || !conditional.file) {
+      return false;
+    }
+    const std::string& line = conditional.file->lines[conditional.lineNumberStart];
+    std::size_t position = conditional.characterNumberStart + 4;
+    while(position < line.size() && std::isspace(static_cast<unsigned char>(line[position]))) {
+      ++position;
+    }
+    if(position + 2 > line.size() || line.compare(position, 2, "if") != 0) {
+      return true;
+    }
+    return position + 2 < line.size() && (std::isalnum(static_cast<unsigned char>(line[position + 2])) || line[position + 2] == '_');
+  }
+
+}
@@ -0,0 +1,88 @@
+/* MIT License
+ *
+ * Copyright (c) 2018 Jean-Sebastien Fauteux, Michel Rioux, Raphaël Massabot
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "../core/scope.hpp"
+
+namespace Flow {
+
+  // Outermost function or conditional holding the scope, nullptr outside of them
+  const Core::Scope* getFlowScope(const Core::Scope& scope);
+
+  // One bit per local variable of a function
+  class VariableSet {
+  public:
+    explicit VariableSet(std::size_t size = 0);
+
+    bool test(std::size_t variable) const;
+    void set(std::size_t variable);
+    void reset(std::size_t variable);
+    // Adds the variables of other, returns whether some were missing
+    bool unite(const VariableSet& other);
+
+  private:
+    std::vector<std::uint64_t> m_words;
+  };
+
+  // Blocks of lines of a function and how control can go from one to the other, built from the conditionals of the function.
+  // if, else and switch bodies may or may not run, for and while bodies may run again or not at all, do bodies run at least once.
+  class ControlFlowGraph {
+  public:
+    struct Block {
+      std::vector<unsigned int> lines; // In order
+      std::vector<std::size_t> successors;
+    };
+
+    // conditionals are those whose flow scope is function, in any order
+    ControlFlowGraph(const Core::Scope& function, std::vector<const Core::Scope*> conditionals);
+
+    // The first one is the entry of the function
+    const std::vector<Block>& getBlocks() const { return m_blocks; }
+    // Block holding the line, the entry block for lines outside of the function
+    std::size_t getBlockOfLine(unsigned int line) const;
+
+  private:
+    using ScopeRefs = std::vector<const Core::Scope*>;
+
+    std::size_t addBlock();
+    void addEdge(std::size_t from, std::size_t to);
+    std::size_t buildRegion(const Core::Scope& region, std::size_t entry);
+    std::size_t buildChain(const ScopeRefs& chain, std::size_t entry);
+    const Core::Scope* getOwner(unsigned int line) const;
+    bool isPlainElse(const Core::Scope& conditional) const;
+
+    const Core::Scope& m_function;
+    unsigned int m_endLine; // Last line of the function, included
+    std::vector<const Core::Scope*> m_owners; // Innermost conditional holding each line, the function otherwise
+    std::map<const Core::Scope*, ScopeRefs> m_children; // Direct child conditionals of the function and each conditional, by line
+    std::vector<Block> m_blocks;
+    std::vector<std::size_t> m_blockOfLine;
+  };
+
+}
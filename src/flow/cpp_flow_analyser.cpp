@@ -23,13 +23,23 @@
 
 #include "cpp_flow_analyser.hpp"
 
-#include <regex>
+#include <algorithm>
+#include <cctype>
 
 #include "../core/file.hpp"
 #include "../core/message.hpp"
+#include "control_flow_graph.hpp"
 
 namespace Flow
 {
+  namespace {
+
+    bool isIdentifierCharacter(char c) {
+      return isalnum(static_cast<unsigned char>(c)) || c == '_';
+    }
+
+  }
+
   CPPFlowAnalyser::CPPFlowAnalyser()
   {
     
@@ -39,119 +49,596 @@ namespace Flow
   {
   }
 
-  void CPPFlowAnalyser::analyzeFlow(Core::Scope& rootScope, Core::MessageStack& messageStack) {
-    analyzeNullPointer(rootScope, messageStack);
-    analyzeUninitializedVariable(rootScope, messageStack);
+  void CPPFlowAnalyser::registerIgnoredScopes(const std::map<std::string, std::vector<Core::Scope>>& literals,
+                                              const std::map<std::string, std::vector<Core::Scope>>& comments) {
+    m_stringLiterals = &literals;
+    m_comments = &comments;
+  }
+
+  void CPPFlowAnalyser::analyzeFlow(const Core::Scope& rootScope, Core::MessageStack& messageStack) {
+    analyzeVariables(rootScope.getAllChildrenOfType(Core::ScopeType::Variable), messageStack);
+  }
+
+  void CPPFlowAnalyser::analyzeVariables(const Core::ScopeRefVector& variables, Core::MessageStack& messageStack) {
+    // Both checks go through the same variables, a single pass over each function finds the errors of both
+    std::vector<int> nullPointerLines;
+    std::vector<int> uninitializedLines;
+    checkVariables(variables, nullPointerLines, uninitializedLines);
+    pushNullPointerMessages(variables, nullPointerLines, messageStack);
+    pushUninitializedVariableMessages(variables, uninitializedLines, messageStack);
+  }
+
+  void CPPFlowAnalyser::analyzeNullPointer(const Core::Scope& rootScope, Core::MessageStack& messageStack) {
+    const Core::ScopeRefVector variables = rootScope.getAllChildrenOfType(Core::ScopeType::Variable);
+    std::vector<int> nullPointerLines;
+    std::vector<int> uninitializedLines;
+    checkVariables(variables, nullPointerLines, uninitializedLines);
+    pushNullPointerMessages(variables, nullPointerLines, messageStack);
+  }
+
+  void CPPFlowAnalyser::analyzeUninitializedVariable(const Core::Scope& rootScope, Core::MessageStack& messageStack) {
+    const Core::ScopeRefVector variables = rootScope.getAllChildrenOfType(Core::ScopeType::Variable);
+    std::vector<int> nullPointerLines;
+    std::vector<int> uninitializedLines;
+    checkVariables(variables, nullPointerLines, uninitializedLines);
+    pushUninitializedVariableMessages(variables, uninitializedLines, messageStack);
   }
 
-  void CPPFlowAnalyser::analyzeNullPointer(Core::Scope& rootScope, Core::MessageStack& messageStack) {
-    Core::ScopeType scopeTypes = Core::ScopeType::Variable;
+  void CPPFlowAnalyser::pushNullPointerMessages(const Core::ScopeRefVector& variables, const std::vector<int>& lines, Core::MessageStack& messageStack) {
+    for (std::size_t i = 0; i < variables.size(); ++i) {
+      if (lines[i] > -1) {
+        messageStack.pushMessage(1, Core::Message(Core::MessageType::Error, Core::MessageText::NullPointer, lines[i]), variables[i].get().name);
+      }
+    }
+  }
 
-    for (auto&& currentScope : rootScope.getAllChildrenOfType(scopeTypes)) {
-      int nullPointerLine = scopeUsingNullPointer(currentScope);
-      if (nullPointerLine > -1) {
-        Core::Message message(Core::MessageType::Error,
-          currentScope.name + " will throw a NULL pointer exception", nullPointerLine
-        );
-        messageStack.pushMessage(1, message);
+  void CPPFlowAnalyser::pushUninitializedVariableMessages(const Core::ScopeRefVector& variables, const std::vector<int>& lines, Core::MessageStack& messageStack) {
+    for (std::size_t i = 0; i < variables.size(); ++i) {
+      if (lines[i] > -1) {
+        messageStack.pushMessage(2, Core::Message(Core::MessageType::Error, Core::MessageText::UsedBeforeInitialization, lines[i]), variables[i].get().name);
       }
     }
   }
 
-  void CPPFlowAnalyser::analyzeUninitializedVariable(Core::Scope& rootScope, Core::MessageStack& messageStack) {
-    Core::ScopeType scopeTypes = Core::ScopeType::Variable;
+  void CPPFlowAnalyser::checkVariables(const Core::ScopeRefVector& variables, std::vector<int>& nullPointerLines, std::vector<int>& uninitializedLines) {
+    nullPointerLines.assign(variables.size(), -1);
+    uninitializedLines.assign(variables.size(), -1);
+    if (variables.empty()) {
+      return;
+    }
+
+    // Variables of each function, the functions in the order of their first variable
+    std::vector<const Core::Scope*> functions;
+    std::map<const Core::Scope*, std::vector<std::size_t>> functionVariables;
+    for (std::size_t i = 0; i < variables.size(); ++i) {
+      const Core::Scope* function = getFlowScope(variables[i]);
+      if (!function) {
+        continue;
+      }
+      auto& positions = functionVariables[function];
+      if (positions.empty()) {
+        functions.push_back(function);
+      }
+      positions.push_back(i);
+    }
+
+    // constructTree leaves every scope a child of the root, sorted by line
+    const Core::Scope* rootScope = &variables.front().get();
+    while (rootScope->parent) {
+      rootScope = rootScope->parent;
+    }
+    const auto& rootChildren = rootScope->children;
 
-    for (auto&& currentScope : rootScope.getAllChildrenOfType(scopeTypes)) {
-      int uninitializedVariableLine = scopeUsingUninitializedVariable(currentScope);
-      if (uninitializedVariableLine > -1) {
-        Core::Message message(Core::MessageType::Error,
-          currentScope.name + " is used before initialization", uninitializedVariableLine
-        );
-        messageStack.pushMessage(2, message);
+    ScopeIdentifierIndexes indexes = getIdentifierIndexes(*variables.front().get().file);
+    for (const Core::Scope* function : functions) {
+      std::vector<const Core::Scope*> conditionals;
+      auto child = std::lower_bound(rootChildren.begin(), rootChildren.end(), function->lineNumberStart, [](const Core::Scope& scope, unsigned int line) {
+        return scope.lineNumberStart < line;
+      });
+      for (; child != rootChildren.end() && child->lineNumberStart <= function->lineNumberEnd; ++child) {
+        if (child->isOfType(Core::ScopeType::Conditional) && getFlowScope(*child) == function) {
+          conditionals.push_back(&*child);
+        }
       }
+
+      const ControlFlowGraph graph(*function, std::move(conditionals));
+      checkFunction(*function, graph, variables, functionVariables[function], indexes.getIndex(*function), nullPointerLines, uninitializedLines);
     }
   }
 
-  int CPPFlowAnalyser::scopeUsingNullPointer(Core::Scope& scope) {
-    //Regex = \s+\*(VARNAME)(\s+|=|\(|{|;)
-    std::regex isVariablePointerRegex(R"(\s+\*()" + scope.name + R"()(\s+|=|\(|\{|;))");
-    const std::string& lineVariableDeclaration = scope.file->lines[scope.lineNumberStart];
-    std::smatch match;
-    std::regex_search(lineVariableDeclaration, match, isVariablePointerRegex);
-    if (match.size() > 0) {
-      Core::Scope* parentScope = scope.parent;
-      
-      if (parentScope->isOfType(Core::ScopeType::Function) || parentScope->isOfType(Core::ScopeType::Conditional)) {
-        std::string varValue;
+  void CPPFlowAnalyser::checkFunction(const Core::Scope& function, const ControlFlowGraph& graph, const Core::ScopeRefVector& variables,
+                                      const std::vector<std::size_t>& functionVariables, const IdentifierIndex& index,
+                                      std::vector<int>& nullPointerLines, std::vector<int>& uninitializedLines) {
+    // A definition gives the variable a value, invalid for a NULL pointer or a primitive without a value. Other uses read it
+    struct Event {
+      unsigned int line;
+      std::size_t local;
+      bool isDefinition;
+      bool isInvalid;
+    };
 
-        std::string regexValue = match[0];
-        int positionAfterVarName = lineVariableDeclaration.find(regexValue);
-        int regexLength = regexValue.length();
-        positionAfterVarName += regexLength - 1;
+    // Locals are the pointers and primitives among the variables, each one is a bit of the sets
+    std::vector<std::size_t> locals;
+    std::vector<bool> isPointer;
+    std::vector<Event> events;
+    for (std::size_t position : functionVariables) {
+      const Core::Scope& variable = variables[position];
+      const Core::Scope* parentScope = variable.parent;
+      if (!(parentScope->isOfType(Core::ScopeType::Function) || parentScope->isOfType(Core::ScopeType::Conditional))) {
+        continue;
+      }
 
+      const std::string& lineVariableDeclaration = variable.file->lines[variable.lineNumberStart];
+      std::string varValue;
+      bool pointer = true;
+      int positionAfterVarName = findPointerDeclaration(variable, index);
+      if (positionAfterVarName >= 0) {
         isVariableValueChanged(lineVariableDeclaration, true, positionAfterVarName, varValue);
+      } else if (isScopeVariablePrimitive(variable, index)) {
+        pointer = false;
+        const auto declarations = index.getOccurrences(variable.name, variable.lineNumberStart, variable.lineNumberStart + 1);
+        for (auto occurrence = declarations.first; occurrence != declarations.second; ++occurrence) {
+          if ((positionAfterVarName = findUse(lineVariableDeclaration, *occurrence, variable.name)) >= 0) {
+            isVariableValueChanged(lineVariableDeclaration, true, positionAfterVarName, varValue);
+            break;
+          }
+        }
+      } else {
+        continue;
+      }
 
-        std::regex variableRegex(R"((^|\s)()" + scope.name + R"()(\s+|=|\(|\{|;))");
-        for (unsigned int i = scope.lineNumberStart + 1; i < parentScope->lineNumberEnd; ++i) {
-          const std::string line = parentScope->file->lines[i];
-          std::regex_search(line, match, variableRegex);
-          if (match.size() > 0) {
-            std::string regexValue = match[0];
-            positionAfterVarName =  line.find(regexValue);
-            regexLength = regexValue.length();
-            positionAfterVarName += regexLength - 1;
-
-            if (!isVariableValueChanged(line, false, positionAfterVarName, varValue)) {
-              if (!isVariableValueValid(varValue, true)) {
-                return i;
-              }
-            }
+      const std::size_t local = locals.size();
+      locals.push_back(position);
+      isPointer.push_back(pointer);
+      events.push_back({variable.lineNumberStart, local, true, isValueInvalid(varValue, pointer)});
+
+      // Only the first use of a line counts
+      unsigned int lastLine = variable.lineNumberStart;
+      const auto uses = index.getOccurrences(variable.name, variable.lineNumberStart + 1, parentScope->lineNumberEnd);
+      for (auto use = uses.first; use != uses.second; ++use) {
+        const std::string& line = function.file->lines[use->line];
+        if (use->line == lastLine) {
+          continue;
+        }
+        if ((positionAfterVarName = findUse(line, *use, variable.name)) < 0) {
+          // Passed to a function known to give a value to its out parameter
+          std::string callee;
+          std::uint32_t argument = 0;
+          if (m_summaries && findCallArgument(line, use->position, variable.name.size(), callee, argument)
+              && m_summaries->initializesParameter(callee, argument)) {
+            lastLine = use->line;
+            events.push_back({use->line, local, true, false});
+          }
+          continue;
+        }
+        lastLine = use->line;
+
+        std::string newValue;
+        if (isVariableValueChanged(line, false, positionAfterVarName, newValue)) {
+          events.push_back({use->line, local, true, isValueInvalid(newValue, pointer)});
+        } else {
+          events.push_back({use->line, local, false, false});
+        }
+      }
+    }
+    if (locals.empty()) {
+      return;
+    }
+
+    const auto& blocks = graph.getBlocks();
+    std::stable_sort(events.begin(), events.end(), [](const Event& lhs, const Event& rhs) {
+      return lhs.line < rhs.line;
+    });
+    std::vector<std::vector<Event>> blockEvents(blocks.size());
+    for (const Event& event : events) {
+      blockEvents[graph.getBlockOfLine(event.line)].push_back(event);
+    }
+
+    // Variables whose value may be invalid when each block starts, whichever way it is reached
+    std::vector<VariableSet> blockInvalid(blocks.size(), VariableSet(locals.size()));
+    const auto applyDefinitions = [&blockEvents](std::size_t block, VariableSet& invalid, std::vector<int>* useLines) {
+      for (const Event& event : blockEvents[block]) {
+        if (event.isDefinition) {
+          if (event.isInvalid) {
+            invalid.set(event.local);
+          } else {
+            invalid.reset(event.local);
           }
+        } else if (useLines && invalid.test(event.local) && (*useLines)[event.local] < 0) {
+          (*useLines)[event.local] = event.line;
+        }
+      }
+    };
+
+    std::vector<std::size_t> worklist;
+    for (std::size_t block = blocks.size(); block > 0; --block) {
+      worklist.push_back(block - 1);
+    }
+    std::vector<bool> queued(blocks.size(), true);
+    while (!worklist.empty()) {
+      const std::size_t block = worklist.back();
+      worklist.pop_back();
+      queued[block] = false;
+
+      VariableSet invalid = blockInvalid[block];
+      applyDefinitions(block, invalid, nullptr);
+      for (std::size_t successor : blocks[block].successors) {
+        if (blockInvalid[successor].unite(invalid) && !queued[successor]) {
+          queued[successor] = true;
+          worklist.push_back(successor);
         }
       }
+    }
+
+    // Blocks are not in line order, the first use of each variable is kept
+    std::vector<int> useLines(locals.size(), -1);
+    for (std::size_t block = 0; block < blocks.size(); ++block) {
+      VariableSet invalid = blockInvalid[block];
+      std::vector<int> blockUseLines(locals.size(), -1);
+      applyDefinitions(block, invalid, &blockUseLines);
+      for (std::size_t local = 0; local < locals.size(); ++local) {
+        if (blockUseLines[local] > -1 && (useLines[local] < 0 || blockUseLines[local] < useLines[local])) {
+          useLines[local] = blockUseLines[local];
+        }
+      }
+    }
 
+    for (std::size_t local = 0; local < locals.size(); ++local) {
+      (isPointer[local] ? nullPointerLines : uninitializedLines)[locals[local]] = useLines[local];
+    }
+  }
+
+  int CPPFlowAnalyser::findPointerDeclaration(const Core::Scope& scope, const IdentifierIndex& index) {
+    // \s+\*(VARNAME)(\s+|=|\(|{|;)
+    const std::string& line = scope.file->lines[scope.lineNumberStart];
+    const auto declarations = index.getOccurrences(scope.name, scope.lineNumberStart, scope.lineNumberStart + 1);
+    for (auto occurrence = declarations.first; occurrence != declarations.second; ++occurrence) {
+      if (occurrence->position >= 2 && line[occurrence->position - 1] == '*'
+          && isspace(static_cast<unsigned char>(line[occurrence->position - 2]))) {
+        const int positionAfterVarName = findEndOfUse(line, occurrence->position + scope.name.size());
+        if (positionAfterVarName >= 0) {
+          return positionAfterVarName;
+        }
+      }
     }
     return -1;
   }
 
-  int CPPFlowAnalyser::scopeUsingUninitializedVariable(Core::Scope& scope) {
-    Core::Scope* parentScope = scope.parent;
-    if (isScopeVariablePrimitive(scope) && (parentScope->isOfType(Core::ScopeType::Function) || parentScope->isOfType(Core::ScopeType::Conditional))) {
-      std::string varValue;
-      std::regex variableRegex(R"((^|\s)()" + scope.name + R"()(\s+|=|\(|\{|;))");
-      for (unsigned int i = scope.lineNumberStart; i < parentScope->lineNumberEnd; ++i) {
-       
-        const std::string line = parentScope->file->lines[i];
-        std::smatch match;
-        std::regex_search(line, match, variableRegex);
-        if (match.size() > 0) {
-          std::string regexValue = match[0];
-          int positionAfterVarName = line.find(regexValue);
-          int regexLength = regexValue.length();
-          positionAfterVarName += regexLength - 1;
-
-          if (!isVariableValueChanged(line, i == scope.lineNumberStart, positionAfterVarName, varValue)) {
-            if (varValue.empty() && i != scope.lineNumberStart) {
-              return i;
-            }
+  bool CPPFlowAnalyser::isValueInvalid(const std::string& varValue, bool isPointer) {
+    if (!isPointer) {
+      return varValue.empty();
+    }
+    return !isVariableValueValid(varValue, true) || isNullableCall(varValue);
+  }
+
+  bool CPPFlowAnalyser::isNullableCall(const std::string& varValue) {
+    if (!m_summaries) {
+      return false;
+    }
+    // The whole value is a call: NAME(...)
+    std::size_t position = varValue.find_first_not_of(" \t");
+    const std::size_t nameStart = position;
+    while (position < varValue.size() && (isIdentifierCharacter(varValue[position]) || varValue[position] == ':')) {
+      ++position;
+    }
+    const std::string name = varValue.substr(nameStart, position - nameStart);
+    position = varValue.find_first_not_of(" \t", position);
+    if (name.empty() || position == std::string::npos || varValue[position] != '(') {
+      return false;
+    }
+    const std::size_t close = findClosingParenthesis(varValue, position);
+    if (close == std::string::npos || varValue.find_first_not_of(" \t", close + 1) != std::string::npos) {
+      return false;
+    }
+    return m_summaries->mayReturnNull(FunctionSummary::key(getUnqualifiedName(name), countArguments(varValue, position, close)));
+  }
+
+  bool CPPFlowAnalyser::findCallArgument(const std::string& line, unsigned int position, std::size_t length, std::string& callee, std::uint32_t& argument) {
+    // The whole argument is the name, possibly with its address taken: ( or , then &NAME then , or )
+    const std::size_t after = line.find_first_not_of(" \t", position + length);
+    if (after == std::string::npos || (line[after] != ',' && line[after] != ')')) {
+      return false;
+    }
+    int before = static_cast<int>(position) - 1;
+    while (before >= 0 && isspace(static_cast<unsigned char>(line[before]))) {
+      --before;
+    }
+    if (before >= 0 && line[before] == '&') {
+      --before;
+      while (before >= 0 && isspace(static_cast<unsigned char>(line[before]))) {
+        --before;
+      }
+    }
+    if (before < 0 || (line[before] != '(' && line[before] != ',')) {
+      return false;
+    }
+
+    // Back to the parenthesis opening the call, counting the arguments on the way
+    argument = 0;
+    int depth = 0;
+    for (; before >= 0; --before) {
+      const char c = line[before];
+      if (c == ')') {
+        ++depth;
+      } else if (c == '(') {
+        if (depth == 0) {
+          break;
+        }
+        --depth;
+      } else if (c == ',' && depth == 0) {
+        ++argument;
+      }
+    }
+    int nameEnd = before - 1;
+    while (nameEnd >= 0 && isspace(static_cast<unsigned char>(line[nameEnd]))) {
+      --nameEnd;
+    }
+    int nameStart = nameEnd;
+    while (nameStart >= 0 && isIdentifierCharacter(line[nameStart])) {
+      --nameStart;
+    }
+    if (before < 0 || nameStart == nameEnd) {
+      return false;
+    }
+    const std::size_t close = findClosingParenthesis(line, before);
+    if (close == std::string::npos) {
+      return false;
+    }
+    callee = FunctionSummary::key(line.substr(nameStart + 1, nameEnd - nameStart), countArguments(line, before, close));
+    return true;
+  }
+
+  std::uint32_t CPPFlowAnalyser::countArguments(const std::string& text, std::size_t open, std::size_t close) {
+    if (text.find_first_not_of(" \t", open + 1) == close) {
+      return 0;
+    }
+    std::uint32_t count = 1;
+    int depth = 0;
+    for (std::size_t i = open + 1; i < close; ++i) {
+      if (text[i] == '(' || text[i] == '[' || text[i] == '{') {
+        ++depth;
+      } else if (text[i] == ')' || text[i] == ']' || text[i] == '}') {
+        --depth;
+      } else if (text[i] == ',' && depth == 0) {
+        ++count;
+      }
+    }
+    return count;
+  }
+
+  FileSummaries CPPFlowAnalyser::summarizeFunctions(const Core::Scope& rootScope) {
+    FileSummaries summaries;
+    ScopeIdentifierIndexes indexes = getIdentifierIndexes(*rootScope.file);
+    for (const Core::Scope& function : rootScope.getAllChildrenOfType(Core::ScopeType::Function)) {
+      const std::string& signature = function.file->lines[function.lineNumberStart];
+      const std::size_t nameStart = signature.find(function.name, function.characterNumberStart);
+      const std::size_t open = nameStart == std::string::npos ? nameStart : signature.find('(', nameStart + function.name.size());
+      if (open == std::string::npos) {
+        continue;
+      }
+      std::size_t close = findClosingParenthesis(signature, open);
+      // Declarations have no body to summarize
+      if (function.lineNumberEnd == function.lineNumberStart && signature.find('{', open) == std::string::npos) {
+        continue;
+      }
+
+      FunctionSummary summary;
+      summary.name = getUnqualifiedName(function.name);
+      const std::vector<std::string> parameters = splitParameters(signature.substr(open + 1, close == std::string::npos ? std::string::npos : close - open - 1));
+      // f() and f(void) take no argument
+      summary.parameterCount = parameters.size() == 1 && (parameters[0].empty() || parameters[0] == "void") ? 0 : parameters.size();
+      if (summary.name.empty()) {
+        continue;
+      }
+      const bool returnsPointer = signature.find('*') < nameStart;
+      if (close == std::string::npos) {
+        close = signature.size();
+      }
+      const IdentifierIndex& index = indexes.getIndex(function);
+      const auto isInBody = [&function, close](const IdentifierIndex::Occurrence& occurrence) {
+        return occurrence.line > function.lineNumberStart || occurrence.position > close;
+      };
+
+      // Out parameters are written through, or passed on to another function
+      for (std::uint32_t parameter = 0; parameter < parameters.size() && parameter < 32; ++parameter) {
+        const std::string& declaration = parameters[parameter];
+        const bool isPointer = declaration.find('*') != std::string::npos;
+        const bool isReference = !isPointer && declaration.find('&') != std::string::npos;
+        if ((!isPointer && !isReference) || declaration.compare(0, 6, "const ") == 0) {
+          continue;
+        }
+        std::size_t parameterEnd = declaration.size();
+        std::size_t parameterStart = parameterEnd;
+        while (parameterStart > 0 && isIdentifierCharacter(declaration[parameterStart - 1])) {
+          --parameterStart;
+        }
+        const std::string name = declaration.substr(parameterStart, parameterEnd - parameterStart);
+        if (name.empty()) {
+          continue;
+        }
+
+        const auto occurrences = index.getOccurrences(name, function.lineNumberStart, function.lineNumberEnd + 1);
+        for (auto occurrence = occurrences.first; occurrence != occurrences.second; ++occurrence) {
+          if (!isInBody(*occurrence)) {
+            continue;
+          }
+          const std::string& line = function.file->lines[occurrence->line];
+          std::string callee;
+          std::uint32_t argument = 0;
+          if (isAssigned(line, occurrence->position, name.size(), isPointer)) {
+            summary.initializedParameters |= std::uint32_t(1) << parameter;
+          } else if (findCallArgument(line, occurrence->position, name.size(), callee, argument)) {
+            summary.forwardedParameters.push_back({parameter, callee, argument});
           }
         }
       }
+
+      // return NULL, or return the result of another function
+      const auto returns = index.getOccurrences("return", function.lineNumberStart, function.lineNumberEnd + 1);
+      for (auto occurrence = returns.first; occurrence != returns.second; ++occurrence) {
+        const std::string& line = function.file->lines[occurrence->line];
+        const std::size_t valueStart = line.find_first_not_of(" \t", occurrence->position + 6);
+        if (valueStart == std::string::npos) {
+          continue;
+        }
+        std::size_t valueEnd = valueStart;
+        while (valueEnd < line.size() && (isIdentifierCharacter(line[valueEnd]) || line[valueEnd] == ':')) {
+          ++valueEnd;
+        }
+        const std::string value = line.substr(valueStart, valueEnd - valueStart);
+        const std::size_t next = line.find_first_not_of(" \t", valueEnd);
+        if (value == "NULL" || value == "nullptr" || (value == "0" && returnsPointer)) {
+          summary.mayReturnNull = true;
+        } else if (!value.empty() && next != std::string::npos && line[next] == '(') {
+          const std::size_t callClose = findClosingParenthesis(line, next);
+          if (callClose != std::string::npos) {
+            summary.returnedCalls.push_back(FunctionSummary::key(getUnqualifiedName(value), countArguments(line, next, callClose)));
+          }
+        }
+      }
+
+      summaries.push_back(std::move(summary));
     }
-    return -1;
+    return summaries;
+  }
+
+  void CPPFlowAnalyser::registerSummaries(const FunctionSummaries& summaries) {
+    m_summaries = &summaries;
   }
 
-  bool CPPFlowAnalyser::isScopeVariablePrimitive(Core::Scope& scope) {
-    if (scope.isOfType(Core::ScopeType::Variable)) {
-      const std::string line = scope.file->lines[scope.lineNumberStart];
-      std::regex variableRegex(R"((^|\s)(bool|int|char|double|float|long|short) )" + scope.name + R"((\s+|=|\(|\{|;))");
-      std::smatch match;
-      std::regex_search(line, match, variableRegex);
-      return match.size() > 0;
+  bool CPPFlowAnalyser::isAssigned(const std::string& line, unsigned int position, std::size_t length, bool throughPointer) {
+    // NAME = but not NAME ==
+    const std::size_t after = line.find_first_not_of(" \t", position + length);
+    if (after == std::string::npos || line[after] != '=' || (after + 1 < line.size() && line[after + 1] == '=')) {
+      return false;
+    }
+    int before = static_cast<int>(position) - 1;
+    while (before >= 0 && isspace(static_cast<unsigned char>(line[before]))) {
+      --before;
+    }
+    if (throughPointer) {
+      // *NAME =, where * is not a multiplication
+      if (before < 0 || line[before] != '*') {
+        return false;
+      }
+      --before;
+      while (before >= 0 && isspace(static_cast<unsigned char>(line[before]))) {
+        --before;
+      }
+      return before < 0 || !(isIdentifierCharacter(line[before]) || line[before] == ')');
+    }
+    return before < 0 || line[before] == '{' || line[before] == ';' || line[before] == '}' || line[before] == ')';
+  }
+
+  std::vector<std::string> CPPFlowAnalyser::splitParameters(const std::string& parameters) {
+    std::vector<std::string> split;
+    std::string current;
+    int depth = 0;
+    for (const char c : parameters) {
+      if (c == '(' || c == '<' || c == '[' || c == '{') {
+        ++depth;
+      } else if (c == ')' || c == '>' || c == ']' || c == '}') {
+        --depth;
+      } else if (c == ',' && depth == 0) {
+        split.push_back(current);
+        current.clear();
+        continue;
+      }
+      current += c;
+    }
+    split.push_back(current);
+
+    // Default values and surrounding blanks are left out
+    for (auto& parameter : split) {
+      parameter = parameter.substr(0, parameter.find('='));
+      const std::size_t first = parameter.find_first_not_of(" \t");
+      const std::size_t last = parameter.find_last_not_of(" \t");
+      parameter = first == std::string::npos ? std::string() : parameter.substr(first, last - first + 1);
+    }
+    return split;
+  }
+
+  std::size_t CPPFlowAnalyser::findClosingParenthesis(const std::string& text, std::size_t open) {
+    int depth = 0;
+    for (std::size_t i = open; i < text.size(); ++i) {
+      if (text[i] == '(') {
+        ++depth;
+      } else if (text[i] == ')' && --depth == 0) {
+        return i;
+      }
+    }
+    return std::string::npos;
+  }
+
+  std::string CPPFlowAnalyser::getUnqualifiedName(const std::string& name) {
+    const std::size_t separator = name.rfind("::");
+    return separator == std::string::npos ? name : name.substr(separator + 2);
+  }
+
+  bool CPPFlowAnalyser::isScopeVariablePrimitive(const Core::Scope& scope, const IdentifierIndex& index) {
+    if (!scope.isOfType(Core::ScopeType::Variable)) {
+      return false;
+    }
+
+    // (^|\s)(bool|int|char|double|float|long|short) VARNAME(\s+|=|\(|\{|;)
+    static const std::vector<std::string> primitiveTypes = {"bool", "int", "char", "double", "float", "long", "short"};
+    const std::string& line = scope.file->lines[scope.lineNumberStart];
+    const auto declarations = index.getOccurrences(scope.name, scope.lineNumberStart, scope.lineNumberStart + 1);
+    for (auto occurrence = declarations.first; occurrence != declarations.second; ++occurrence) {
+      const unsigned int position = occurrence->position;
+      if (position == 0 || line[position - 1] != ' ' || findEndOfUse(line, position + scope.name.size()) < 0) {
+        continue;
+      }
+      for (const auto& type : primitiveTypes) {
+        if (position < type.size() + 1 || line.compare(position - type.size() - 1, type.size(), type) != 0) {
+          continue;
+        }
+        const unsigned int typeStart = position - type.size() - 1;
+        if (typeStart == 0 || isspace(static_cast<unsigned char>(line[typeStart - 1]))) {
+          return true;
+        }
+      }
     }
     return false;
   }
 
+  int CPPFlowAnalyser::findUse(const std::string& line, const IdentifierIndex::Occurrence& occurrence, const std::string& name) {
+    // (^|\s)(VARNAME)(\s+|=|\(|\{|;)
+    if (occurrence.position > 0 && !isspace(static_cast<unsigned char>(line[occurrence.position - 1]))) {
+      return -1;
+    }
+    return findEndOfUse(line, occurrence.position + name.size());
+  }
+
+  int CPPFlowAnalyser::findEndOfUse(const std::string& line, unsigned int endOfName) {
+    if (endOfName >= line.size()) {
+      return -1;
+    }
+    const char c = line[endOfName];
+    if (isspace(static_cast<unsigned char>(c))) {
+      unsigned int end = endOfName;
+      while (end + 1 < line.size() && isspace(static_cast<unsigned char>(line[end + 1]))) {
+        ++end;
+      }
+      return end;
+    }
+    return (c == '=' || c == '(' || c == '{' || c == ';') ? static_cast<int>(endOfName) : -1;
+  }
+
+  ScopeIdentifierIndexes CPPFlowAnalyser::getIdentifierIndexes(const Core::File& file) const {
+    static const std::vector<Core::Scope> noScopes;
+    const auto findScopes = [&file](const std::map<std::string, std::vector<Core::Scope>>* scopesByFile) -> const std::vector<Core::Scope>& {
+      if (scopesByFile) {
+        const auto it = scopesByFile->find(file.filename);
+        if (it != scopesByFile->end()) {
+          return it->second;
+        }
+      }
+      return noScopes;
+    };
+    return ScopeIdentifierIndexes(file, findScopes(m_comments), findScopes(m_stringLiterals));
+  }
+
   //positionAfterVarName = the position on line after the variable name appear (if var name end at position 10, use 11 for this variable)
   bool CPPFlowAnalyser::isVariableValueChanged(const std::string& line, bool isVariableDeclarationLine, int positionAfterVarName, std::string& varValue) {
     bool isInitializingVariable = false;
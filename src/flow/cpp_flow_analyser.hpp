@@ -24,6 +24,9 @@
 #pragma once
 
 #include "flow_analyser.hpp"
+#include "control_flow_graph.hpp"
+#include "function_summary.hpp"
+#include "identifier_index.hpp"
 
 #include "../core/scope.hpp"
 #include "../core/message_stack.hpp"
@@ -35,17 +38,47 @@ namespace Flow {
     CPPFlowAnalyser();
     virtual ~CPPFlowAnalyser();
 
-    void analyzeFlow(Core::Scope& rootScope, Core::MessageStack& messageStack);
-    void analyzeNullPointer(Core::Scope& rootScope, Core::MessageStack& messageStack);
-    void analyzeUninitializedVariable(Core::Scope& rootScope, Core::MessageStack& messageStack);
+    void registerIgnoredScopes(const std::map<std::string, std::vector<Core::Scope>>& literals,
+                               const std::map<std::string, std::vector<Core::Scope>>& comments);
+    void analyzeFlow(const Core::Scope& rootScope, Core::MessageStack& messageStack);
+    void analyzeVariables(const Core::ScopeRefVector& variables, Core::MessageStack& messageStack);
+    FileSummaries summarizeFunctions(const Core::Scope& rootScope);
+    void registerSummaries(const FunctionSummaries& summaries);
+    void analyzeNullPointer(const Core::Scope& rootScope, Core::MessageStack& messageStack);
+    void analyzeUninitializedVariable(const Core::Scope& rootScope, Core::MessageStack& messageStack);
 
   private:
 
-    int scopeUsingNullPointer(Core::Scope& scope);
-    int scopeUsingUninitializedVariable(Core::Scope& scope);
-    bool isScopeVariablePrimitive(Core::Scope& scope);
+    // Line of the first use of each variable while its value may be invalid, -1 when there is none
+    void checkVariables(const Core::ScopeRefVector& variables, std::vector<int>& nullPointerLines, std::vector<int>& uninitializedLines);
+    void checkFunction(const Core::Scope& function, const ControlFlowGraph& graph, const Core::ScopeRefVector& variables,
+                       const std::vector<std::size_t>& functionVariables, const IdentifierIndex& index,
+                       std::vector<int>& nullPointerLines, std::vector<int>& uninitializedLines);
+    void pushNullPointerMessages(const Core::ScopeRefVector& variables, const std::vector<int>& lines, Core::MessageStack& messageStack);
+    void pushUninitializedVariableMessages(const Core::ScopeRefVector& variables, const std::vector<int>& lines, Core::MessageStack& messageStack);
+    int findPointerDeclaration(const Core::Scope& scope, const IdentifierIndex& index);
+    bool isValueInvalid(const std::string& varValue, bool isPointer);
+    bool isNullableCall(const std::string& varValue);
+    // Key of the function and position of the argument when the name is a whole argument of a call, its address possibly taken.
+    // The call has to end on the line.
+    bool findCallArgument(const std::string& line, unsigned int position, std::size_t length, std::string& callee, std::uint32_t& argument);
+    // Arguments between the parenthesis at open and the one at close
+    std::uint32_t countArguments(const std::string& text, std::size_t open, std::size_t close);
+    bool isAssigned(const std::string& line, unsigned int position, std::size_t length, bool throughPointer);
+    std::vector<std::string> splitParameters(const std::string& parameters);
+    std::size_t findClosingParenthesis(const std::string& text, std::size_t open);
+    std::string getUnqualifiedName(const std::string& name);
+    bool isScopeVariablePrimitive(const Core::Scope& scope, const IdentifierIndex& index);
+    // Position after a use of the variable (see isVariableValueChanged) or -1 if the occurrence is not one
+    int findUse(const std::string& line, const IdentifierIndex::Occurrence& occurrence, const std::string& name);
+    int findEndOfUse(const std::string& line, unsigned int endOfName);
+    ScopeIdentifierIndexes getIdentifierIndexes(const Core::File& file) const;
     bool isVariableValueChanged(const std::string& line, bool isVariableDeclarationLine, int positionAfterVarName, std::string& varValue);
     bool isVariableValueValid(std::string varValue, bool isPointer);
+
+    const std::map<std::string, std::vector<Core::Scope>>* m_stringLiterals = nullptr;
+    const std::map<std::string, std::vector<Core::Scope>>* m_comments = nullptr;
+    const FunctionSummaries* m_summaries = nullptr;
   };
   
 }
@@ -23,6 +23,11 @@
 
 #pragma once
 
+#include <map>
+#include <string>
+#include <vector>
+
+#include "function_summary.hpp"
 #include "../core/scope.hpp"
 #include "../core/message_stack.hpp"
 
@@ -31,7 +36,16 @@ namespace Flow {
   class FlowAnalyser {
   public:
     virtual ~FlowAnalyser();
-    virtual void analyzeFlow(Core::Scope& rootScope, Core::MessageStack& messageStack) = 0;
+    virtual void analyzeFlow(const Core::Scope& rootScope, Core::MessageStack& messageStack) = 0;
+    // Same checks on some variables of a single file, in the given order. Calls on different variables can run concurrently
+    virtual void analyzeVariables(const Core::ScopeRefVector& variables, Core::MessageStack& messageStack) = 0;
+    // Facts about the functions of a file seen from its own lines, files can be summarized concurrently
+    virtual FileSummaries summarizeFunctions(const Core::Scope& rootScope) = 0;
+    // Propagated summaries of every file, used by the analyses from then on. They must outlive the analyses
+    virtual void registerSummaries(const FunctionSummaries& summaries) = 0;
+    // Comments and string literals of each file, left out of the variables uses. They must outlive the analyses
+    virtual void registerIgnoredScopes(const std::map<std::string, std::vector<Core::Scope>>& literals,
+                                       const std::map<std::string, std::vector<Core::Scope>>& comments) = 0;
   };
   
 }
@@ -0,0 +1,135 @@
+/* MIT License
+ *
+ * Copyright (c) 2018 Jean-Sebastien Fauteux, Michel Rioux, Raphaël Massabot
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "function_summary.hpp"
+
+#include <deque>
+#include <unordered_set>
+
+namespace Flow {
+
+  std::string FunctionSummary::key(const std::string& name, std::uint32_t argumentCount) {
+    return name + "/" + std::to_string(argumentCount);
+  }
+
+  void FunctionSummaries::add(const FileSummaries& summaries) {
+    for(const auto& summary : summaries) {
+      m_summaries[FunctionSummary::key(summary.name, summary.parameterCount)].push_back(summary);
+      ++m_size;
+    }
+  }
+
+  std::size_t FunctionSummaries::propagate() {
+    // Approximate call graph, from the key of each callee to the functions depending on it
+    std::unordered_map<std::string, std::vector<FunctionSummary*>> callers;
+    std::deque<FunctionSummary*> worklist;
+    std::unordered_set<FunctionSummary*> queued;
+    for(auto& summaryPair : m_summaries) {
+      for(auto& summary : summaryPair.second) {
+        for(const auto& callee : summary.returnedCalls) {
+          callers[callee].push_back(&summary);
+        }
+        for(const auto& forwarded : summary.forwardedParameters) {
+          callers[forwarded.callee].push_back(&summary);
+        }
+        if(!summary.returnedCalls.empty() || !summary.forwardedParameters.empty()) {
+          worklist.push_back(&summary);
+          queued.insert(&summary);
+        }
+      }
+    }
+
+    // Facts only ever get added, so the facts of every key only grow until nothing changes
+    std::size_t evaluations = 0;
+    while(!worklist.empty()) {
+      FunctionSummary& summary = *worklist.front();
+      worklist.pop_front();
+      queued.erase(&summary);
+      ++evaluations;
+
+      bool changed = false;
+      if(!summary.mayReturnNull) {
+        for(const auto& callee : summary.returnedCalls) {
+          if(mayReturnNull(callee)) {
+            summary.mayReturnNull = true;
+            changed = true;
+            break;
+          }
+        }
+      }
+      for(const auto& forwarded : summary.forwardedParameters) {
+        const std::uint32_t bit = std::uint32_t(1) << forwarded.parameter;
+        if((summary.initializedParameters & bit) == 0 && initializesParameter(forwarded.callee, forwarded.argument)) {
+          summary.initializedParameters |= bit;
+          changed = true;
+        }
+      }
+
+      if(!changed) {
+        continue;
+      }
+      const auto callersIt = callers.find(FunctionSummary::key(summary.name, summary.parameterCount));
+      if(callersIt == callers.end()) {
+        continue;
+      }
+      for(FunctionSummary* caller : callersIt->second) {
+        if(queued.insert(caller).second) {
+          worklist.push_back(caller);
+        }
+      }
+    }
+    return evaluations;
+  }
+
+  void FunctionSummaries::clear() {
+    m_summaries.clear();
+    m_size = 0;
+  }
+
+  bool FunctionSummaries::mayReturnNull(const std::string& key) const {
+    const auto it = m_summaries.find(key);
+    if(it == m_summaries.end()) {
+      return false;
+    }
+    for(const auto& summary : it->second) {
+      if(summary.mayReturnNull) {
+        return true;
+      }
+    }
+    return false;
+  }
+
+  bool FunctionSummaries::initializesParameter(const std::string& key, std::uint32_t parameter) const {
+    const auto it = m_summaries.find(key);
+    if(parameter >= 32 || it == m_summaries.end()) {
+      return false;
+    }
+    for(const auto& summary : it->second) {
+      if((summary.initializedParameters & (std::uint32_t(1) << parameter)) == 0) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+}
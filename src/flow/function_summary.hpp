@@ -0,0 +1,78 @@
+/* MIT License
+ *
+ * Copyright (c) 2018 Jean-Sebastien Fauteux, Michel Rioux, Raphaël Massabot
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace Flow {
+
+  // What the callers of a function can rely on. Functions are known by their name, without class or
+  // namespace, and their number of parameters
+  struct FunctionSummary {
+    // The function passes one of its parameters as an argument of another function
+    struct ForwardedParameter {
+      std::uint32_t parameter;
+      std::string callee; // Key of the function called
+      std::uint32_t argument;
+    };
+
+    // Key of the functions named name called with argumentCount arguments
+    static std::string key(const std::string& name, std::uint32_t argumentCount);
+
+    std::string name;
+    std::uint32_t parameterCount = 0;
+    bool mayReturnNull = false;
+    std::uint32_t initializedParameters = 0; // Bit per out parameter given a value, the first 32 parameters only
+    std::vector<std::string> returnedCalls;  // Keys of the functions whose result is returned as is
+    std::vector<ForwardedParameter> forwardedParameters;
+  };
+
+  using FileSummaries = std::vector<FunctionSummary>;
+
+  // Summaries of the functions of every file. Functions sharing a key, overloads or methods of
+  // different classes, are kept apart: one of them may return null when any of them may, and
+  // initializes a parameter only when all of them do.
+  class FunctionSummaries {
+  public:
+    void add(const FileSummaries& summaries);
+    // Carries the facts of callees over to their callers through returned calls and forwarded parameters,
+    // a function is evaluated again only when one of its callees changed. Returns the number of evaluations
+    std::size_t propagate();
+    void clear();
+
+    // By FunctionSummary::key
+    bool mayReturnNull(const std::string& key) const;
+    bool initializesParameter(const std::string& key, std::uint32_t parameter) const;
+    std::size_t size() const { return m_size; }
+
+  private:
+    // key : summaries of the functions sharing it
+    std::unordered_map<std::string, std::vector<FunctionSummary>> m_summaries;
+    std::size_t m_size = 0;
+  };
+
+}
@@ -0,0 +1,111 @@
+/* MIT License
+ *
+ * Copyright (c) 2018 Jean-Sebastien Fauteux, Michel Rioux, Raphaël Massabot
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "identifier_index.hpp"
+
+#include <algorithm>
+#include <cctype>
+
+namespace Flow {
+
+  namespace {
+
+    bool isIdentifierCharacter(char c) {
+      return std::isalnum(static_cast<unsigned char>(c)) || c == '_';
+    }
+
+  }
+
+  IdentifierIndex::IdentifierIndex(const std::vector<std::string>& codeLines, unsigned int firstLine, unsigned int endLine) {
+    for(unsigned int line = firstLine; line < endLine && line < codeLines.size(); ++line) {
+      const std::string& code = codeLines[line];
+      unsigned int position = 0;
+      while(position < code.size()) {
+        if(!isIdentifierCharacter(code[position])) {
+          ++position;
+          continue;
+        }
+        const unsigned int start = position;
+        while(position < code.size() && isIdentifierCharacter(code[position])) {
+          ++position;
+        }
+        m_occurrences[code.substr(start, position - start)].push_back({line, start});
+      }
+    }
+  }
+
+  IdentifierIndex::OccurrenceRange IdentifierIndex::getOccurrences(const std::string& identifier, unsigned int firstLine, unsigned int endLine) const {
+    static const std::vector<Occurrence> noOccurrences;
+    const auto it = m_occurrences.find(identifier);
+    const auto& occurrences = it != m_occurrences.end() ? it->second : noOccurrences;
+
+    const auto begin = std::lower_bound(occurrences.begin(), occurrences.end(), firstLine, [](const Occurrence& occurrence, unsigned int line) {
+      return occurrence.line < line;
+    });
+    const auto end = std::lower_bound(begin, occurrences.end(), endLine, [](const Occurrence& occurrence, unsigned int line) {
+      return occurrence.line < line;
+    });
+    return OccurrenceRange(begin, end);
+  }
+
+  ScopeIdentifierIndexes::ScopeIdentifierIndexes(const Core::File& file, const std::vector<Core::Scope>& comments, const std::vector<Core::Scope>& stringLiterals)
+  : m_file(file)
+  , m_comments(comments)
+  , m_stringLiterals(stringLiterals) {
+  }
+
+  const IdentifierIndex& ScopeIdentifierIndexes::getIndex(const Core::Scope& scope) {
+    auto it = m_indexes.find(&scope);
+    if(it != m_indexes.end()) {
+      return it->second;
+    }
+
+    // Only the lines of the scope are copied, the comments and literals over them are blanked out again on lines
+    // copied for an earlier scope, which leaves those unchanged, and skipped on lines not copied yet
+    const unsigned int endLine = std::min<unsigned int>(scope.lineNumberEnd + 1, m_file.lines.size());
+    if(m_codeLines.empty()) {
+      m_codeLines.resize(m_file.lines.size());
+      m_copiedLines.resize(m_file.lines.size(), false);
+    }
+    bool copied = false;
+    for(unsigned int line = scope.lineNumberStart; line < endLine; ++line) {
+      if(!m_copiedLines[line]) {
+        m_codeLines[line] = m_file.lines[line];
+        m_copiedLines[line] = true;
+        copied = true;
+      }
+    }
+    if(copied) {
+      for(const auto* ignoredScopes : {&m_comments, &m_stringLiterals}) {
+        for(const auto& ignoredScope : *ignoredScopes) {
+          if(ignoredScope.lineNumberEnd >= scope.lineNumberStart && ignoredScope.lineNumberStart < endLine) {
+            Core::blankOutScope(m_codeLines, ignoredScope);
+          }
+        }
+      }
+    }
+
+    return m_indexes.emplace(&scope, IdentifierIndex(m_codeLines, scope.lineNumberStart, endLine)).first->second;
+  }
+
+}
@@ -0,0 +1,74 @@
+/* MIT License
+ *
+ * Copyright (c) 2018 Jean-Sebastien Fauteux, Michel Rioux, Raphaël Massabot
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include <map>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "../core/file.hpp"
+#include "../core/scope.hpp"
+
+namespace Flow {
+
+  // Where each identifier of a range of lines appears, outside comments and string literals
+  class IdentifierIndex {
+  public:
+    struct Occurrence {
+      unsigned int line;
+      unsigned int position;
+    };
+    using OccurrenceIterator = std::vector<Occurrence>::const_iterator;
+    using OccurrenceRange = std::pair<OccurrenceIterator, OccurrenceIterator>;
+
+    // codeLines are the lines of the file with comments and string literals blanked out, lines from firstLine up to endLine are indexed
+    IdentifierIndex(const std::vector<std::string>& codeLines, unsigned int firstLine, unsigned int endLine);
+
+    // Occurrences from firstLine up to endLine, by line then position
+    OccurrenceRange getOccurrences(const std::string& identifier, unsigned int firstLine, unsigned int endLine) const;
+
+  private:
+    std::unordered_map<std::string, std::vector<Occurrence>> m_occurrences;
+  };
+
+  // Identifier indexes of the functions and conditionals of a file, each built the first time one of its variables is checked
+  class ScopeIdentifierIndexes {
+  public:
+    ScopeIdentifierIndexes(const Core::File& file, const std::vector<Core::Scope>& comments, const std::vector<Core::Scope>& stringLiterals);
+
+    // Index of the lines of scope, from its first to its last line included
+    const IdentifierIndex& getIndex(const Core::Scope& scope);
+
+  private:
+    const Core::File& m_file;
+    const std::vector<Core::Scope>& m_comments;
+    const std::vector<Core::Scope>& m_stringLiterals;
+    std::vector<std::string> m_codeLines; // Lines are copied and blanked out along with the first index covering them
+    std::vector<bool> m_copiedLines;
+    std::map<const Core::Scope*, IdentifierIndex> m_indexes;
+  };
+
+}
@@ -0,0 +1,148 @@
+/* MIT License
+ *
+ * Copyright (c) 2018 Jean-Sebastien Fauteux, Michel Rioux, Raphaël Massabot
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "summary_cache.hpp"
+
+#include <cstdio>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+#include <thread>
+
+#include <muflihun/easylogging++.h>
+
+#include "../core/scope_cache.hpp"
+
+namespace Flow {
+
+  namespace {
+
+    const char Magic[] = "SIFTSUM";
+
+  }
+
+  SummaryCache::SummaryCache(const std::string& directory)
+    : m_directory(directory)
+  {
+  }
+
+  std::string SummaryCache::getEntryFilename(const Core::File& file) const {
+    std::ostringstream filename;
+    filename << m_directory << "/" << std::hex << std::setw(16) << std::setfill('0') << Core::ScopeCache::hashContent(file) << ".summaries";
+    return filename.str();
+  }
+
+  bool SummaryCache::load(const Core::File& file, FileSummaries& outSummaries) const {
+    std::ifstream stream(getEntryFilename(file));
+    if(!stream.is_open()) {
+      return false;
+    }
+
+    std::string magic;
+    std::uint32_t version = 0;
+    std::uint64_t contentHash = 0;
+    std::size_t lineCount = 0;
+    std::size_t summaryCount = 0;
+    stream >> magic >> version >> std::hex >> contentHash >> std::dec >> lineCount >> summaryCount;
+    if(!stream || magic != Magic || version != Version
+       || contentHash != Core::ScopeCache::hashContent(file) || lineCount != file.lines.size()) {
+      return false;
+    }
+
+    FileSummaries summaries(summaryCount);
+    for(auto& summary : summaries) {
+      std::string tag;
+      std::size_t returnedCallCount = 0;
+      std::size_t forwardedParameterCount = 0;
+      stream >> tag >> summary.name >> summary.parameterCount >> summary.mayReturnNull >> summary.initializedParameters >> returnedCallCount >> forwardedParameterCount;
+      if(!stream || tag != "F") {
+        LOG(WARNING) << "Ignoring corrupted summary cache entry for '" << file.filename << "'";
+        return false;
+      }
+
+      summary.returnedCalls.resize(returnedCallCount);
+      for(auto& callee : summary.returnedCalls) {
+        stream >> tag >> callee;
+        if(!stream || tag != "R") {
+          LOG(WARNING) << "Ignoring corrupted summary cache entry for '" << file.filename << "'";
+          return false;
+        }
+      }
+
+      summary.forwardedParameters.resize(forwardedParameterCount);
+      for(auto& forwarded : summary.forwardedParameters) {
+        stream >> tag >> forwarded.parameter >> forwarded.callee >> forwarded.argument;
+        if(!stream || tag != "P" || forwarded.parameter >= 32) {
+          LOG(WARNING) << "Ignoring corrupted summary cache entry for '" << file.filename << "'";
+          return false;
+        }
+      }
+    }
+
+    outSummaries = std::move(summaries);
+    return true;
+  }
+
+  bool SummaryCache::store(const Core::File& file, const FileSummaries& summaries) const {
+    std::ostringstream content;
+    content << Magic << " " << Version << " " << std::hex << Core::ScopeCache::hashContent(file) << std::dec
+            << " " << file.lines.size() << " " << summaries.size() << "\n";
+    for(const auto& summary : summaries) {
+      content << "F " << summary.name << " " << summary.parameterCount << " " << summary.mayReturnNull << " " << summary.initializedParameters
+              << " " << summary.returnedCalls.size() << " " << summary.forwardedParameters.size() << "\n";
+      for(const auto& callee : summary.returnedCalls) {
+        content << "R " << callee << "\n";
+      }
+      for(const auto& forwarded : summary.forwardedParameters) {
+        content << "P " << forwarded.parameter << " " << forwarded.callee << " " << forwarded.argument << "\n";
+      }
+    }
+
+    // Written aside then renamed, a reader never reads a partially written entry
+    const std::string filename = getEntryFilename(file);
+    const std::string temporaryFilename = filename + "." + std::to_string(std::hash<std::thread::id>()(std::this_thread::get_id())) + ".tmp";
+    {
+      std::ofstream stream(temporaryFilename, std::ios::trunc);
+      if(!stream.is_open()) {
+        LOG(ERROR) << "Could not write summary cache entry '" << temporaryFilename << "'";
+        return false;
+      }
+
+      stream << content.str();
+      if(!stream.good()) {
+        LOG(ERROR) << "Could not write summary cache entry '" << temporaryFilename << "'";
+        return false;
+      }
+    }
+
+    std::remove(filename.c_str());
+    if(std::rename(temporaryFilename.c_str(), filename.c_str()) != 0) {
+      LOG(ERROR) << "Could not move summary cache entry to '" << filename << "'";
+      std::remove(temporaryFilename.c_str());
+      return false;
+    }
+
+    return true;
+  }
+
+}
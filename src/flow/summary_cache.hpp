@@ -0,0 +1,57 @@
+/* MIT License
+ *
+ * Copyright (c) 2018 Jean-Sebastien Fauteux, Michel Rioux, Raphaël Massabot
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+#include "function_summary.hpp"
+#include "../core/file.hpp"
+
+namespace Flow {
+
+  // On-disk cache of the function summaries of a file, next to the scope cache entries and keyed by the same content hash.
+  // Summaries only depend on the file itself, an entry stays valid until the file changes.
+  // An entry is a header line then a line per summary, parameter forwarding and returned call:
+  //   SIFTSUM version hash lineCount summaryCount
+  //   F name parameterCount mayReturnNull initializedParameters returnedCallCount forwardedParameterCount
+  //   R calleeKey
+  //   P parameter calleeKey argument
+  class SummaryCache {
+  public:
+    static const std::uint32_t Version = 2; /* Bump whenever the layout or the summaries change */
+
+    explicit SummaryCache(const std::string& directory);
+
+    // False when there is no valid entry for the content of the file
+    bool load(const Core::File& file, FileSummaries& outSummaries) const;
+    bool store(const Core::File& file, const FileSummaries& summaries) const;
+
+    std::string getEntryFilename(const Core::File& file) const;
+
+  private:
+    std::string m_directory;
+  };
+
+}
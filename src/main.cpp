@@ -42,10 +42,12 @@ int main(int argc, char* argv[]) {
   SIFT sift;
   sift.parseArgv(argc, argv);
   sift.setupLogging();
+  sift.setupBaseline();
   sift.setupRules(sift.getRuleFileName());
   sift.readPath(sift.getPathToParse());
   sift.extractScopes();
   sift.registerRuleWork();
+  sift.openResultWriter();
   sift.applyRules();
   std::chrono::time_point<std::chrono::system_clock> after = std::chrono::system_clock::now();
   auto syntaxExecutionTime = std::chrono::duration_cast<std::chrono::milliseconds>(after - before).count();
@@ -58,6 +60,8 @@ int main(int argc, char* argv[]) {
   auto flowExecutionTime = std::chrono::duration_cast<std::chrono::milliseconds>(after - before).count();
   LOG(INFO) << "Flow Ran in " << syntaxExecutionTime << "ms";
   sift.outputMessagesFlow(flowExecutionTime);
+  sift.writeBaseline();
+  sift.writeProfile();
 
   LOG(INFO) << "SIFT Ran in " << syntaxExecutionTime + flowExecutionTime << "ms";
   return 0;
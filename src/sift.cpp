@@ -25,32 +25,76 @@
 #define NOMINMAX
 
 #include <chrono>
+#include <deque>
 #include <stack>
 #include <utility>
 #include <muflihun/easylogging++.h>
 #include <cxxopts/cxxopts.hpp>
-#include <nbsdx/ThreadPool.h>
 #include <algorithm>
 
 #include "sift.hpp"
 #include "core/config.hpp"
 #include "core/assert.hpp"
 #include "core/cpp_scope_extractor.hpp"
+#include "flow/control_flow_graph.hpp"
 #include "flow/cpp_flow_analyser.hpp"
+#include "flow/summary_cache.hpp"
 #include "syntax/cpp_syntax_analyser.hpp"
 #include "syntax/rule.hpp"
 
+namespace {
+
+  const std::vector<Core::Scope>& scopesOfFile(const std::map<std::string, std::vector<Core::Scope>>& scopesByFile, const std::string& filename) {
+    static const std::vector<Core::Scope> NoScopes;
+    auto it = scopesByFile.find(filename);
+    return it != scopesByFile.end() ? it->second : NoScopes;
+  }
+
+  std::uint64_t countScopes(const Core::Scope& scope) {
+    std::uint64_t count = scope.children.size();
+    for(const auto& child : scope.children) {
+      count += countScopes(child);
+    }
+    return count;
+  }
+
+  // Task indices ordered by decreasing size, equal sizes keep their order
+  std::vector<std::size_t> largestFirst(std::size_t taskCount, const std::function<std::size_t(std::size_t)>& sizeOf) {
+    std::vector<std::size_t> sizes(taskCount);
+    std::vector<std::size_t> order(taskCount);
+    for(std::size_t i = 0; i < taskCount; ++i) {
+      sizes[i] = sizeOf(i);
+      order[i] = i;
+    }
+    std::stable_sort(order.begin(), order.end(), [&sizes](std::size_t lhs, std::size_t rhs) {
+      return sizes[lhs] > sizes[rhs];
+    });
+    return order;
+  }
+
+  // Ids pushed by the flow analyser
+  Core::RuleDescriptions getFlowRuleDescriptions() {
+    return {
+      {1, {"NullPointer", Core::to_string(Core::ScopeType::Variable), "Variable will throw a NULL pointer exception"}},
+      {2, {"UninitializedVariable", Core::to_string(Core::ScopeType::Variable), "Variable is used before initialization"}}
+    };
+  }
+
+}
 
 SIFT::SIFT()
 {
   m_syntaxAnalyser = std::make_unique<Syntax::CPPSyntaxAnalyser>();
   m_flowAnalyser = std::make_unique<Flow::CPPFlowAnalyser>();
   m_scopeExtractor = std::make_unique<Core::CppScopeExtractor>();
-  
-  registerConflictDefinitions();
 
   m_parsingErrors = 0;
   m_scopedFileExtracted = 0;
+  m_useSummaries = false;
+  m_summaryOnly = false;
+  m_jobCount = 0;
+  m_resultsStreamed = false;
+  m_outputFormat = "text";
 }
   
 #define CXXOPT(longName, variableName, type, defaultValue) if(result.count(longName)) { \
@@ -71,8 +115,19 @@ void SIFT::parseArgv(int argc, char** argv)
   ("l,logconfig", "Specify a easylogging config file to use", cxxopts::value<std::string>())
   ("r,rules", "Specify a rule file to use", cxxopts::value<std::string>())
   ("o,output", "Output results to file", cxxopts::value<std::string>())
+  ("format", "Format of the output file: text, jsonl or sarif", cxxopts::value<std::string>())
   ("h,help", "Print help")
   ("p,path", "Specify what path/filename to parse", cxxopts::value<std::string>(m_pathToParse))
+  ("c,cache", "Reuse extracted scopes of unchanged files from this directory", cxxopts::value<std::string>())
+  ("profile", "Write the time and work spent per phase, file and rule to this JSON file", cxxopts::value<std::string>())
+  ("max-extraction-ms", "Give up extracting the scopes of a file after this many milliseconds, 0 for no limit", cxxopts::value<unsigned int>())
+  ("max-rules-ms", "Stop applying rules to a file after this many milliseconds, 0 for no limit", cxxopts::value<unsigned int>())
+  ("max-messages", "Stop applying rules to a file once it has this many messages, 0 for no limit", cxxopts::value<unsigned int>())
+  ("summaries", "Carry what functions may return and which out parameters they set across files in the flow analysis")
+  ("baseline", "Leave out the violations fingerprinted in this baseline file", cxxopts::value<std::string>())
+  ("write-baseline", "Write the fingerprints of every violation found to this baseline file", cxxopts::value<std::string>())
+  ("j,jobs", "Number of threads to run on, 0 for one per core", cxxopts::value<unsigned int>())
+  ("summary-only", "Only count the violations and output their number per file, rule and directory")
   ;
   try
   {
@@ -92,9 +147,31 @@ void SIFT::parseArgv(int argc, char** argv)
     CXXOPT("verbose", m_verboseMode, bool, false);
     CXXOPT("quiet", m_quietMode, bool, false);
     CXXOPT("output", m_outputFilename, std::string, "output.txt");
+    CXXOPT("format", m_outputFormat, std::string, "text");
+    if(m_outputFormat != "text" && m_outputFormat != "jsonl" && m_outputFormat != "sarif") {
+      throw std::invalid_argument("Unknown output format " + m_outputFormat);
+    }
     CXXOPT("logconfig", m_loggingSettingsFilename, std::string, "samples/logging.conf");
     CXXOPT("rules", m_ruleFilename, std::string, "samples/rules/rules.json");
     CXXOPT("path", m_pathToParse, std::string, "samples/src/brightness_manager.cc");
+    CXXOPT("cache", m_cacheDirectory, std::string, "");
+    CXXOPT("summaries", m_useSummaries, bool, false);
+    CXXOPT("summary-only", m_summaryOnly, bool, false);
+    unsigned int jobCount;
+    CXXOPT("jobs", jobCount, unsigned int, 0);
+    setJobCount(jobCount);
+    std::string profileFilename;
+    CXXOPT("profile", profileFilename, std::string, "");
+    setProfileFilename(profileFilename);
+    unsigned int maxExtractionTime, maxRulesTime, maxMessages;
+    CXXOPT("max-extraction-ms", maxExtractionTime, unsigned int, 0);
+    CXXOPT("max-rules-ms", maxRulesTime, unsigned int, 0);
+    CXXOPT("max-messages", maxMessages, unsigned int, 0);
+    m_budgetLimits.extractionTime = std::chrono::milliseconds(maxExtractionTime);
+    m_budgetLimits.ruleTime = std::chrono::milliseconds(maxRulesTime);
+    m_budgetLimits.messages = maxMessages;
+    CXXOPT("write-baseline", m_writeBaselineFilename, std::string, "");
+    CXXOPT("baseline", m_baselineFilename, std::string, "");
   }
   catch(...)
   {
@@ -102,6 +179,67 @@ void SIFT::parseArgv(int argc, char** argv)
     exit(EXIT_FAILURE);
   }
 }
+
+void SIFT::setJobCount(unsigned int jobCount)
+{
+  if(jobCount != m_jobCount) {
+    m_scheduler.reset();
+  }
+  m_jobCount = jobCount;
+}
+
+Core::TaskScheduler& SIFT::getScheduler()
+{
+  if(!m_scheduler) {
+    m_scheduler = std::make_unique<Core::TaskScheduler>(m_jobCount);
+  }
+  return *m_scheduler;
+}
+
+bool SIFT::loadBaseline(const std::string& filename)
+{
+  auto baseline = std::make_unique<Core::Baseline>();
+  if(!baseline->load(filename)) {
+    return false;
+  }
+  LOG(INFO) << "Loaded " << baseline->size() << " fingerprints from the baseline '" << filename << "'";
+  m_baseline = std::move(baseline);
+  return true;
+}
+
+void SIFT::writeBaseline() const
+{
+  if(m_writeBaselineFilename.empty()) {
+    return;
+  }
+  if(m_summaryOnly) {
+    LOG(ERROR) << "Could not write the baseline '" << m_writeBaselineFilename << "', only the number of violations is known with --summary-only";
+    return;
+  }
+
+  Core::Baseline baseline;
+  for(const bool syntaxPhase : {true, false}) {
+    const auto ruleTypes = getBaselineRuleTypes(syntaxPhase);
+    for(const auto& stackPair : syntaxPhase ? m_messageStacks : m_messageStacksFlow) {
+      const Core::File* file = findSourceFile(stackPair.first);
+      if(!file) {
+        continue;
+      }
+      const Core::BaselineFilter filter(nullptr, ruleTypes, *file);
+      for(const auto& ruleIdMessagesPair : stackPair.second.getMessages()) {
+        for(const auto& message : ruleIdMessagesPair.second) {
+          baseline.add(filter.fingerprint(ruleIdMessagesPair.first, message, stackPair.second.getArgument(message)));
+        }
+      }
+    }
+  }
+
+  if(baseline.save(m_writeBaselineFilename)) {
+    LOG(INFO) << "Wrote " << baseline.size() << " fingerprints to the baseline '" << m_writeBaselineFilename << "'";
+  } else {
+    LOG(ERROR) << "Could not write the baseline '" << m_writeBaselineFilename << "'";
+  }
+}
   
 void SIFT::setupLogging()
 {
@@ -135,10 +273,18 @@ void SIFT::setupLogging()
   el::Loggers::reconfigureLogger("default", conf);
   
 }
+
+void SIFT::setupBaseline()
+{
+  // The baseline to write holds every violation, none of them is left out
+  if(!m_baselineFilename.empty() && m_writeBaselineFilename.empty() && !loadBaseline(m_baselineFilename)) {
+    LOG(ERROR) << "Could not read the baseline '" << m_baselineFilename << "', reporting every violation";
+  }
+}
   
 void SIFT::setupRules(const std::string filename)
 {
-  m_rules = Syntax::readRules(m_conflict_definitions, filename);
+  m_rules = Syntax::readRules(filename);
     
   std::stringstream rulesString;
     
@@ -149,6 +295,8 @@ void SIFT::setupRules(const std::string filename)
     
   LOG(INFO) << "Parsed " << m_rules.size() << " rules:";
   LOG(INFO) << rulesString.str();
+
+  m_rulePlan = Syntax::RulePlan(m_rules, *m_syntaxAnalyser);
 }
 
 
@@ -163,6 +311,8 @@ void SIFT::setupRules(std::map<RuleId, Syntax::Rule> rules){
   
   LOG(INFO) << "Gave " << m_rules.size() << " rules:";
   LOG(INFO) << rulesString.str();
+
+  m_rulePlan = Syntax::RulePlan(m_rules, *m_syntaxAnalyser);
 }
 
 void SIFT::readSource(const std::string& filename, const std::vector<std::string>& source){
@@ -170,7 +320,7 @@ void SIFT::readSource(const std::string& filename, const std::vector<std::string
   file.filename = filename;
   file.lines = source;
   //m_files[filename] = file;
-  m_files.push_back(std::make_pair(filename, file));
+  m_files.push_back(std::make_pair(filename, std::move(file)));
   LOG(INFO) << "Source file '" << filename << "' has been read";
 }
 
@@ -183,7 +333,7 @@ void SIFT::readSingleSourceFile(const std::string & filename)
   }
 
   //m_files[filename] = file;
-  m_files.push_back(std::make_pair(filename, file));
+  m_files.push_back(std::make_pair(filename, std::move(file)));
   LOG(INFO) << "Source file '" << filename << "' has been read";
 }
   
@@ -195,6 +345,7 @@ void SIFT::readFilesFromDirectory(const std::string& directory, const std::strin
   
   std::vector<Core::FilesystemItem> stack, current, all;
   stack = Core::getFilenamesInDirectory(directory);
+  std::vector<std::string> paths;
     
   while(stack.size() > 0)
   {
@@ -220,46 +371,117 @@ void SIFT::readFilesFromDirectory(const std::string& directory, const std::strin
           continue;
         }
         
-        Core::File file;
-        bool success = Core::readSourceFile(item.fullPath, file);
-        if(!success)
-        {
-          LOG(ERROR) << "Could not read source file '" << item.fullPath << "'";
-          continue;
-        }
-          
-        //m_files[item.fullPath] = file;
-        m_files.push_back(std::make_pair(item.fullPath, file));
+        paths.push_back(item.fullPath);
       }
     }
   }
+
+  // Read by the workers into a slot per path, kept in the order they were found
+  std::vector<Core::File> files(paths.size());
+  std::vector<char> success(paths.size(), false);
+  getScheduler().run(paths.size(), [&paths, &files, &success](std::size_t i) {
+    success[i] = Core::readSourceFile(paths[i], files[i]);
+  });
+  for(std::size_t i = 0; i < paths.size(); ++i) {
+    if(!success[i])
+    {
+      LOG(ERROR) << "Could not read source file '" << paths[i] << "'";
+      continue;
+    }
+    m_files.push_back(std::make_pair(paths[i], std::move(files[i])));
+  }
     
   LOG(INFO) << "Read " << m_files.size() << " source files";
 }
   
 void SIFT::extractScopes()
 {
-  //TODO: Interesting, but could be maybe be a fix at 8?
-  std::random_shuffle(m_files.begin(), m_files.end());
-  const auto MaxThreadCount = std::thread::hardware_concurrency();
-  unsigned int filesPerThread = (m_files.size() / MaxThreadCount)+1;
-  
-  LOG(INFO) << "Parsing " << filesPerThread << " files per thread";
-  
-  using nbsdx::concurrent::ThreadPool;
+  m_scopeCache.reset();
+  m_scopesFromCache.clear();
+  if(!m_cacheDirectory.empty()) {
+    if(Core::createDirectory(m_cacheDirectory)) {
+      m_scopeCache = std::make_unique<Core::ScopeCache>(m_cacheDirectory);
+    } else {
+      LOG(ERROR) << "Could not use '" << m_cacheDirectory << "' as scope cache directory, extracting every file";
+    }
+  }
 
-  ThreadPool<8> pool;
+  // A task per file, the largest first so none of them is left running alone at the end
+  const std::vector<std::size_t> order = largestFirst(m_files.size(), [this](std::size_t i) {
+    std::size_t size = 0;
+    for(const auto& line : m_files[i].second.lines) {
+      size += line.size() + 1;
+    }
+    return size;
+  });
 
-  for(int i = 0; i < MaxThreadCount; ++i) {
-    pool.AddJob([this, filesPerThread, i]() {
-      extractScopesImpl(getFileRange(i*filesPerThread, filesPerThread));
-    });
+  Core::TaskScheduler& scheduler = getScheduler();
+  LOG(INFO) << "Parsing " << m_files.size() << " files on " << scheduler.getThreadCount() << " threads";
+  // Each task fills the slot of its file, collected in file order once they are all done
+  std::vector<ExtractedFile> extracted(m_files.size());
+  for(const auto& file : m_files) {
+    m_scopeExtractor->addFile(file.first);
   }
+  scheduler.run(order.size(), [this, &order, &extracted](std::size_t i) {
+    extractScopesImpl(m_files[order[i]].second, extracted[order[i]]);
+  });
 
-  pool.JoinAll(true);
+  std::vector<Core::Scope*> treesToConstruct;
+  for(std::size_t i = 0; i < m_files.size(); ++i) {
+    const std::string& filename = m_files[i].first;
+    ExtractedFile& file = extracted[i];
+    if(!file.budgetExceeded.empty()) {
+      m_budgetsExceeded[filename] = file.budgetExceeded;
+      LOG(WARNING) << "Budget exceeded for '" << filename << "', " << file.budgetExceeded;
+    }
+    if(!file.success) {
+      // Running out of budget is reported above, it is no parse error
+      if(file.budgetExceeded.empty()) {
+        LOG(ERROR) << "Could not parse source file '" << filename << "'";
+        ++m_parsingErrors;
+      }
+      continue;
+    }
+    if(m_profile) {
+      m_profile->add(Core::ProfilePhase::Extraction, filename, file.counters);
+    }
+    Core::Scope& rootScope = m_rootScopes[filename] = std::move(file.scope);
+    if(file.fromCache) {
+      m_scopesFromCache.insert(filename);
+    } else {
+      treesToConstruct.push_back(&rootScope);
+    }
+  }
+
+  // The string literals, comments and defines of every file are known from here on
+  std::vector<Core::ProfileCounters> treeCounters(treesToConstruct.size());
+  const std::vector<std::size_t> treeOrder = largestFirst(treesToConstruct.size(), [&treesToConstruct](std::size_t i) {
+    return treesToConstruct[i]->children.size();
+  });
+  scheduler.run(treeOrder.size(), [this, &treeOrder, &treesToConstruct, &treeCounters](std::size_t index) {
+    const std::size_t i = treeOrder[index];
+    Core::Scope& rootScope = *treesToConstruct[i];
+    {
+      const Core::Profiling::Sample sample(m_profile ? &treeCounters[i] : nullptr);
+      m_scopeExtractor->constructTree(rootScope);
+    }
+
+    if(m_scopeCache) {
+      const std::string& filename = rootScope.file->filename;
+      m_scopeCache->store(*rootScope.file, rootScope,
+                          scopesOfFile(m_scopeExtractor->getStringLiterals(), filename),
+                          scopesOfFile(m_scopeExtractor->getComments(), filename),
+                          scopesOfFile(m_scopeExtractor->getDefines(), filename));
+    }
+  });
+  if(m_profile) {
+    for(std::size_t i = 0; i < treesToConstruct.size(); ++i) {
+      m_profile->add(Core::ProfilePhase::Extraction, treesToConstruct[i]->file->filename, treeCounters[i]);
+    }
+  }
 
-  for(auto& scopePair : m_rootScopes) {
-    m_scopeExtractor->constructTree(scopePair.second);
+  if(m_scopeCache) {
+    LOG(INFO) << "Reused cached scopes for " << m_scopesFromCache.size() << "/" << m_files.size() << " files";
   }
 
   if(m_files.size() > 0){
@@ -271,144 +493,323 @@ void SIFT::extractScopes()
 
 void SIFT::applyRules()
 {
-  {
-    //Clearing Duplicate Rules
-    std::vector<Syntax::Rule> ruleList;
-    for(auto it = m_rules.begin(); it != m_rules.end();) {
-      if(std::find_if(ruleList.begin(), ruleList.end(), [it](const Syntax::Rule& rule) {
-        return it->second == rule;
-      }) != ruleList.end()) {
-        it = m_rules.erase(it);
-      } else {
-        ruleList.push_back(it->second);
-        ++it;
+  if(m_rulePlan.empty()) {
+    // Every file still gets a stack, even an empty one
+    std::size_t sequence = 0;
+    for(const auto& scopePair : m_rootScopes) {
+      const std::string& filename = scopePair.second.file->filename;
+      const Core::MessageStack& messageStack = m_messageStacks[filename];
+      if(m_resultWriter) {
+        m_resultWriter->push(sequence++, {filename, scopePair.second.file, &messageStack, ""});
       }
     }
+    m_resultsStreamed = m_resultWriter != nullptr;
+    return;
   }
 
+  // Scope and line rules share a single pass over each file, the others work on the whole file
+  const auto& fileRulesWork = m_rulePlan.getFileRules();
+  const auto& scopeRules = m_rulePlan.getScopeRules();
+  const auto& lineRules = m_rulePlan.getLineRules();
+
+  // A task is a file, a range of whole file rules and possibly the scope and line passes, each filling its own stack.
+  // Large files get a task per pass and whole file rule so a single big file does not keep one thread busy until the end.
+  // Keyword hits of each file, scanned by whichever of its tasks needs them first
+  struct FileKeywords {
+    std::once_flag scanned;
+    Core::KeywordHits hits;
+  };
+  std::vector<FileKeywords> keywords(m_rootScopes.size());
+  // The tasks of a file are next to each other, the last one to finish merges their stacks
+  struct FileTasks {
+    std::size_t firstTask;
+    std::atomic<std::size_t> tasksLeft;
+    Core::MessageStack* messageStack;
+  };
+  std::vector<FileTasks> fileTasks(m_rootScopes.size());
+  // Time and messages left for each file, in the same order
+  std::deque<Core::FileBudget> budgets;
+  // Violations of the baseline are dropped before they reach the task stacks, the others only counted with --summary-only
+  const auto ruleTypes = getBaselineRuleTypes(true);
+  std::deque<Core::BaselineFilter> baselineFilters;
+
+  struct RuleTask {
+    Core::Scope* rootScope;
+    std::size_t fileIndex;
+    FileKeywords* keywords;
+    std::size_t firstRule;
+    std::size_t lastRule;
+    bool withScopeRules;
+    bool withLineRules;
+    Core::FileBudget* budget;
+    Core::MessageStack messageStack;
+    // Whole file, then scope, then line rules counters, only sized when profiling
+    std::vector<Core::ProfileCounters> counters;
+  };
+
+  std::vector<RuleTask> tasks;
+  std::size_t fileIndex = 0;
   for(auto& scopePair : m_rootScopes)
   {
-    for(auto& rulePair : m_rules)
-    {
-      auto ruleType = rulePair.second.getRuleType();
-      auto it = m_rulesWork.find(ruleType);
-      if(it != m_rulesWork.end())
-      {
-        m_rulesWork[ruleType](rulePair.second, scopePair.second, m_messageStacks[scopePair.second.file->filename]);
+    Core::Scope& rootScope = scopePair.second;
+    FileKeywords* fileKeywords = &keywords[fileIndex];
+    budgets.emplace_back(m_budgetLimits.ruleTime, m_budgetLimits.messages);
+    Core::FileBudget* budget = &budgets.back();
+    const std::size_t firstTask = tasks.size();
+    if(rootScope.file->lines.size() >= RULE_TASK_SPLIT_LINES) {
+      if(!scopeRules.empty()) {
+        tasks.push_back({&rootScope, fileIndex, fileKeywords, 0, 0, true, false, budget, Core::MessageStack()});
+      }
+      if(!lineRules.empty()) {
+        tasks.push_back({&rootScope, fileIndex, fileKeywords, 0, 0, false, true, budget, Core::MessageStack()});
       }
+      for(std::size_t i = 0; i < fileRulesWork.size(); ++i) {
+        tasks.push_back({&rootScope, fileIndex, fileKeywords, i, i + 1, false, false, budget, Core::MessageStack()});
+      }
+    } else {
+      tasks.push_back({&rootScope, fileIndex, fileKeywords, 0, fileRulesWork.size(), !scopeRules.empty(), !lineRules.empty(), budget, Core::MessageStack()});
+    }
+    if(m_baseline) {
+      baselineFilters.emplace_back(m_baseline.get(), ruleTypes, *rootScope.file);
+    }
+    for(std::size_t i = firstTask; i < tasks.size(); ++i) {
+      tasks[i].messageStack.setBaselineFilter(m_baseline ? &baselineFilters.back() : nullptr);
+      tasks[i].messageStack.setCountOnly(m_summaryOnly);
+    }
+    FileTasks& file = fileTasks[fileIndex++];
+    file.firstTask = firstTask;
+    file.tasksLeft = tasks.size() - firstTask;
+    // Created before the pool starts, the workers only fill them
+    file.messageStack = &m_messageStacks[rootScope.file->filename];
+  }
+  const bool usesKeywords = m_rulePlan.usesKeywords();
+  const std::size_t scopeCountersOffset = fileRulesWork.size();
+  const std::size_t lineCountersOffset = scopeCountersOffset + scopeRules.size();
+  if(m_profile) {
+    for(auto& task : tasks) {
+      task.counters.resize(lineCountersOffset + lineRules.size());
     }
   }
-}
 
-// TODO maybe have a file for this, but since we aimed for a 'single binary' approach, here's data in code
-void SIFT::registerConflictDefinitions()
-{
-  using namespace Syntax;
-  m_conflict_definitions[RuleType::CurlyBracketsCloseSameLine] = {RuleType::CurlyBracketsCloseSeparateLine};
-  m_conflict_definitions[RuleType::CurlyBracketsCloseSeparateLine] = {RuleType::CurlyBracketsCloseSameLine};
-  
-  m_conflict_definitions[RuleType::CurlyBracketsOpenSameLine] = {RuleType::CurlyBracketsOpenSeparateLine};
-  m_conflict_definitions[RuleType::CurlyBracketsOpenSeparateLine] = {RuleType::CurlyBracketsOpenSameLine};
-  
-  m_conflict_definitions[RuleType::OwnHeaderBeforeStandard] = {RuleType::StandardHeaderBeforeOwn};
-  m_conflict_definitions[RuleType::StandardHeaderBeforeOwn] = {RuleType::OwnHeaderBeforeStandard};
-  
-  m_conflict_definitions[RuleType::StartWithLowerCase] = {RuleType::StartWithUpperCase, RuleType::StartWithX};
-  m_conflict_definitions[RuleType::StartWithUpperCase] = {RuleType::StartWithLowerCase, RuleType::StartWithX};
-  m_conflict_definitions[RuleType::StartWithX] = {RuleType::StartWithLowerCase, RuleType::StartWithUpperCase};
-  
+  {
+    // Largest files first, the tasks of a file keep their order
+    const std::vector<std::size_t> order = largestFirst(tasks.size(), [&tasks](std::size_t i) { return tasks[i].rootScope->file->lines.size(); });
+    Core::TaskScheduler& scheduler = getScheduler();
+    scheduler.run(tasks.size(), [this, &order, &tasks, &fileTasks, &fileRulesWork, &scopeRules, &lineRules, usesKeywords, scopeCountersOffset, lineCountersOffset](std::size_t index) {
+      RuleTask& task = tasks[order[index]];
+      const bool profiling = !task.counters.empty();
+      try {
+        Core::Budgeting::Guard guard(task.budget, &task.messageStack);
+        for(std::size_t i = task.firstRule; i < task.lastRule; ++i) {
+          const Core::Profiling::Sample sample(profiling ? &task.counters[i] : nullptr);
+          Core::Budgeting::checkpoint();
+          m_syntaxAnalyser->applyFileRule(*fileRulesWork[i], *task.rootScope, task.messageStack);
+        }
+        if(usesKeywords && (task.withScopeRules || task.withLineRules)) {
+          std::call_once(task.keywords->scanned, [&task]() {
+            task.keywords->hits = Core::KeywordHits(*task.rootScope->file);
+          });
+        }
+        if(task.withScopeRules) {
+          Syntax::runScopeRules(*task.rootScope, scopeRules, task.keywords->hits, task.messageStack,
+                                profiling ? &task.counters[scopeCountersOffset] : nullptr);
+        }
+        if(task.withLineRules) {
+          Syntax::runLineRules(*task.rootScope, lineRules, task.keywords->hits, task.messageStack,
+                               profiling ? &task.counters[lineCountersOffset] : nullptr);
+        }
+        guard.check();
+      } catch(const Core::BudgetExceeded&) {
+        // The rest of the file is skipped, the messages found so far are kept
+      }
+
+      FileTasks& file = fileTasks[task.fileIndex];
+      if(file.tasksLeft.fetch_sub(1) != 1) {
+        return;
+      }
+      // A rule only runs in one task per file, merged in task order and sorted the stack is the
+      // same as a serial run whichever thread finished first. Sorted here, before the writer reads it.
+      for(std::size_t i = file.firstTask; i < tasks.size() && tasks[i].fileIndex == task.fileIndex; ++i) {
+        file.messageStack->merge(std::move(tasks[i].messageStack));
+      }
+      file.messageStack->sort();
+      if(m_resultWriter) {
+        m_resultWriter->push(task.fileIndex, {task.rootScope->file->filename, task.rootScope->file, file.messageStack,
+                                              task.budget->isExceeded() ? "rules stopped after " + task.budget->getReason() : ""});
+      }
+    });
+  }
+  m_resultsStreamed = m_resultWriter != nullptr;
+
+  for(const auto& task : tasks) {
+    if(task.budget->isExceeded()) {
+      const std::string& filename = task.rootScope->file->filename;
+      if(m_budgetsExceeded.emplace(filename, "rules stopped after " + task.budget->getReason()).second) {
+        LOG(WARNING) << "Budget exceeded for '" << filename << "', " << m_budgetsExceeded[filename];
+      }
+    }
+  }
+
+  if(m_profile) {
+    const auto& scopeRuleTypes = m_rulePlan.getScopeRuleTypes();
+    const auto& lineRuleTypes = m_rulePlan.getLineRuleTypes();
+    for(const auto& task : tasks) {
+      const std::string& filename = task.rootScope->file->filename;
+      auto addCounters = [&](Syntax::RuleType type, const Core::ProfileCounters& counters) {
+        if(counters.wallTime || counters.scopesVisited || counters.linesScanned || counters.regexEvaluations) {
+          m_profile->add(Core::ProfilePhase::Syntax, filename, Syntax::to_string(type), counters);
+        }
+      };
+      for(std::size_t i = 0; i < fileRulesWork.size(); ++i) {
+        addCounters(fileRulesWork[i]->getRuleType(), task.counters[i]);
+      }
+      for(std::size_t i = 0; i < scopeRuleTypes.size(); ++i) {
+        addCounters(scopeRuleTypes[i], task.counters[scopeCountersOffset + i]);
+      }
+      for(std::size_t i = 0; i < lineRuleTypes.size(); ++i) {
+        addCounters(lineRuleTypes[i], task.counters[lineCountersOffset + i]);
+      }
+    }
+
+    // Messages are only known per rule once the stacks of the file are merged
+    for(const auto& scopePair : m_rootScopes) {
+      const std::string& filename = scopePair.second.file->filename;
+      for(const auto& ruleIdCountPair : m_messageStacks[filename].countMessagesByRule()) {
+        Core::ProfileCounters counters;
+        counters.messages = ruleIdCountPair.second;
+        m_profile->add(Core::ProfilePhase::Syntax, filename, Syntax::to_string(m_rules.at(ruleIdCountPair.first).getRuleType()), counters);
+      }
+    }
+  }
 }
 
 void SIFT::registerRuleWork()
 {
-  m_syntaxAnalyser->registerRuleWork(m_rulesWork, m_scopeExtractor->getStringLiterals(), m_scopeExtractor->getComments());
+  m_syntaxAnalyser->registerRuleWork(m_scopeExtractor->getStringLiterals(), m_scopeExtractor->getComments());
 }
   
   
-#define OUTPUT(msg) file << msg << "\n"; \
-  if(!m_quietMode) \
-  { \
-    LOG(INFO) << msg; \
-  }
-  
-void SIFT::outputMessagesSyntax(long long executionTime)
-{    
+void SIFT::openResultWriter()
+{
+  m_resultWriter = std::make_unique<Core::ResultWriter>(m_outputFilename, false, !m_quietMode, createResultFormatter(true));
+  m_resultsStreamed = false;
+}
+
+Core::RuleDescriptions SIFT::getRuleDescriptions()
+{
   auto findReplaceFn = [&](std::string& from, const std::string find, const std::string replace){
     auto index = from.find(find);
     if(index != std::string::npos){
       from.replace(index, find.length(), replace);
     }
   };
-  
-  std::ofstream file(m_outputFilename);
-  // Files
-  for(auto&& stackPair : m_messageStacks) {
-    if(stackPair.second.size() == 0)
-    {
-      continue; // Don't bother displaying error-free files
-    }
-    
-    OUTPUT("+ " << stackPair.first << " ----------");
-
-    // Rules
-    for(const auto& ruleIdMessagesPair : stackPair.second.getMessages()) {
-      const Syntax::Rule& rule = m_rules[ruleIdMessagesPair.first];
-      
-      std::string ruleString = m_syntaxAnalyser->getRuleMessage(rule);
-      
-      std::string ruleName = Syntax::to_string(rule.getRuleType());
-      std::string ruleScope = Core::to_string(rule.getScopeType());
-      std::string ruleParameter = rule.getParameter();
-            
-      findReplaceFn(ruleString, "%rs", ruleScope);      
-      findReplaceFn(ruleString, "%rp", ruleParameter.empty() ? "" : ruleParameter);
-
-      OUTPUT("  " << ruleName << " -- " << ruleString);
-      
-      for(const auto& message : ruleIdMessagesPair.second) {
-        OUTPUT("    " << message);
-      }
-    }
+
+  Core::RuleDescriptions rules;
+  for(const auto& rulePair : m_rules) {
+    const Syntax::Rule& rule = rulePair.second;
+
+    std::string ruleString = m_syntaxAnalyser->getRuleMessage(rule);
+
+    std::string ruleName = Syntax::to_string(rule.getRuleType());
+    std::string ruleScope = Core::to_string(rule.getScopeType());
+    std::string ruleParameter = rule.getParameter();
+
+    findReplaceFn(ruleString, "%rs", ruleScope);
+    findReplaceFn(ruleString, "%rp", ruleParameter.empty() ? "" : ruleParameter);
+    findReplaceFn(ruleString, "%rm", rule.getMessage());
+
+    rules[rulePair.first] = {ruleName, ruleScope, ruleString};
   }
-  
-  OUTPUT("Syntax Ran in " << executionTime << "ms");
+  return rules;
+}
 
-  file.close();
-    
-  LOG(INFO) << "Wrote results to file: " << m_outputFilename;
+std::unique_ptr<Core::ResultFormatter> SIFT::createResultFormatter(bool syntaxPhase)
+{
+  const std::string phase = syntaxPhase ? "Syntax" : "Flow";
+  const Core::RuleDescriptions flowRules = getFlowRuleDescriptions();
+  if(m_summaryOnly) {
+    // The syntax output is always followed by the flow one
+    return std::make_unique<Core::SummaryResultFormatter>(phase, syntaxPhase ? getRuleDescriptions() : flowRules, syntaxPhase);
+  }
+
+  if(m_outputFormat == "jsonl") {
+    return std::make_unique<Core::JsonLinesResultFormatter>(phase, syntaxPhase ? getRuleDescriptions() : flowRules);
+  }
+  if(m_outputFormat == "sarif") {
+    // The syntax output is always followed by the flow one
+    return std::make_unique<Core::SarifResultFormatter>(phase, syntaxPhase ? getRuleDescriptions() : flowRules, syntaxPhase, !syntaxPhase);
+  }
+  // The text layout lists the flow messages without rule headers
+  return std::make_unique<Core::TextResultFormatter>(phase, syntaxPhase ? getRuleDescriptions() : Core::RuleDescriptions());
 }
 
-void SIFT::outputMessagesFlow(long long executionTime)
+std::unordered_map<RuleId, std::uint64_t> SIFT::getBaselineRuleTypes(bool syntaxPhase) const
 {
-  auto findReplaceFn = [&](std::string& from, const std::string find, const std::string replace) {
-    auto index = from.find(find);
-    if (index != std::string::npos) {
-      from.replace(index, find.length(), replace);
+  std::unordered_map<RuleId, std::uint64_t> ruleTypes;
+  if(syntaxPhase) {
+    for(const auto& rulePair : m_rules) {
+      ruleTypes[rulePair.first] = Core::Baseline::hashText(Syntax::to_string(rulePair.second.getRuleType()));
     }
-  };
-
-  std::ofstream file(m_outputFilename, std::ios::app);
-  // Files
-  for (auto&& stackPair : m_messageStacksFlow) {
-    if (stackPair.second.size() == 0)
-    {
-      continue; // Don't bother displaying error-free files
+  } else {
+    for(const auto& rulePair : getFlowRuleDescriptions()) {
+      ruleTypes[rulePair.first] = Core::Baseline::hashText(rulePair.second.name);
     }
+  }
+  return ruleTypes;
+}
 
-    OUTPUT("+ " << stackPair.first << " ----------");
+const Core::File* SIFT::findSourceFile(const std::string& filename) const
+{
+  const auto scopeIt = m_rootScopes.find(filename);
+  return scopeIt != m_rootScopes.end() ? scopeIt->second.file : nullptr;
+}
 
-    // Rules
-    for (const auto& ruleIdMessagesPair : stackPair.second.getMessages()) {
+void SIFT::outputMessagesSyntax(long long executionTime)
+{
+  std::size_t sequence = 0;
+  if(m_resultsStreamed) {
+    // applyRules already pushed a result per file
+    sequence = m_rootScopes.size();
+  } else {
+    if(!m_resultWriter) {
+      openResultWriter();
+    }
+    std::vector<Core::MessageStack*> messageStacks;
+    for(auto& stackPair : m_messageStacks) {
+      messageStacks.push_back(&stackPair.second);
+    }
+    getScheduler().run(messageStacks.size(), [&messageStacks](std::size_t i) {
+      messageStacks[i]->sort();
+    });
+    for(auto& stackPair : m_messageStacks) {
+      const auto budgetIt = m_budgetsExceeded.find(stackPair.first);
+      m_resultWriter->push(sequence++, {stackPair.first, findSourceFile(stackPair.first), &stackPair.second,
+                                        budgetIt != m_budgetsExceeded.end() ? budgetIt->second : ""});
+    }
+  }
 
-      for (const auto& message : ruleIdMessagesPair.second) {
-        OUTPUT("    " << message);
-      }
+  // Files whose scopes could not be extracted in time never got a stack
+  for(const auto& budgetPair : m_budgetsExceeded) {
+    if(m_messageStacks.count(budgetPair.first) == 0) {
+      m_resultWriter->push(sequence++, {budgetPair.first, nullptr, nullptr, budgetPair.second});
     }
   }
 
-  OUTPUT("Flow Ran in " << executionTime << "ms");
+  m_resultWriter->close(executionTime);
+  m_resultWriter.reset();
+  m_resultsStreamed = false;
 
-  file.close();
+  LOG(INFO) << "Wrote results to file: " << m_outputFilename;
+}
+
+void SIFT::outputMessagesFlow(long long executionTime)
+{
+  Core::ResultWriter writer(m_outputFilename, true, !m_quietMode, createResultFormatter(false));
+  std::size_t sequence = 0;
+  for(const auto& stackPair : m_messageStacksFlow) {
+    writer.push(sequence++, {stackPair.first, findSourceFile(stackPair.first), &stackPair.second, ""});
+  }
+  writer.close(executionTime);
 
   LOG(INFO) << "Wrote results to file: " << m_outputFilename;
 }
@@ -427,42 +828,201 @@ void SIFT::clearState(){
   m_rootScopes.clear();
   m_files.clear();
   m_rules.clear();
-  m_rulesWork.clear();
+  m_rulePlan = Syntax::RulePlan();
+  m_budgetsExceeded.clear();
+  if(m_profile) {
+    m_profile->clear();
+  }
 }
 
-void SIFT::verifyFlow() {
-  for (auto& scopePair : m_rootScopes) {
-    m_flowAnalyser->analyzeFlow(scopePair.second, m_messageStacksFlow[scopePair.second.file->filename]);
+void SIFT::summarizeFunctions() {
+  std::unique_ptr<Flow::SummaryCache> summaryCache;
+  if(m_scopeCache) {
+    summaryCache = std::make_unique<Flow::SummaryCache>(m_cacheDirectory);
+  }
+  m_summariesFromCache.clear();
+
+  // Phase one, each file on its own
+  std::vector<const Core::Scope*> rootScopes;
+  for(const auto& scopePair : m_rootScopes) {
+    rootScopes.push_back(&scopePair.second);
+  }
+  std::vector<Flow::FileSummaries> fileSummaries(rootScopes.size());
+  std::vector<char> fromCache(rootScopes.size(), false);
+  {
+    const std::vector<std::size_t> order = largestFirst(rootScopes.size(), [&rootScopes](std::size_t i) { return rootScopes[i]->file->lines.size(); });
+    Core::TaskScheduler& scheduler = getScheduler();
+    scheduler.run(rootScopes.size(), [this, &order, &rootScopes, &fileSummaries, &fromCache, &summaryCache](std::size_t index) {
+      const std::size_t i = order[index];
+      const Core::File& file = *rootScopes[i]->file;
+      if(summaryCache && summaryCache->load(file, fileSummaries[i])) {
+        fromCache[i] = true;
+        return;
+      }
+      fileSummaries[i] = m_flowAnalyser->summarizeFunctions(*rootScopes[i]);
+      if(summaryCache) {
+        summaryCache->store(file, fileSummaries[i]);
+      }
+    });
   }
+
+  // Phase two, over every file at once
+  m_functionSummaries.clear();
+  for(std::size_t i = 0; i < rootScopes.size(); ++i) {
+    m_functionSummaries.add(fileSummaries[i]);
+    if(fromCache[i]) {
+      m_summariesFromCache.insert(rootScopes[i]->file->filename);
+    }
+  }
+  const std::size_t evaluations = m_functionSummaries.propagate();
+  m_flowAnalyser->registerSummaries(m_functionSummaries);
+
+  if(summaryCache) {
+    LOG(INFO) << "Reused cached function summaries for " << m_summariesFromCache.size() << "/" << rootScopes.size() << " files";
+  }
+  LOG(INFO) << "Propagated the summaries of " << m_functionSummaries.size() << " functions in " << evaluations << " evaluations";
 }
 
-void SIFT::extractScopesImpl(const SIFT::VectorPairFile& files) {
-  
-  for(const auto& filePair : files) {
-    Core::Scope scope;
-    ++m_scopedFileExtracted;
-    LOG(INFO) << "[" << m_scopedFileExtracted << "/" << m_files.size() << "] Parsing " << filePair.second->filename;
-    bool success = m_scopeExtractor->extractScopesFromFile(*filePair.second, scope);
-    if(success)
-    {
-      std::lock_guard<std::mutex> lock(m_mutex);
-      m_rootScopes[filePair.first] = scope;
+void SIFT::verifyFlow() {
+  m_flowAnalyser->registerIgnoredScopes(m_scopeExtractor->getStringLiterals(), m_scopeExtractor->getComments());
+  if(m_useSummaries) {
+    summarizeFunctions();
+  }
+
+  // A task is the variables of a file, or of one of its outermost functions when the file is large, each filling its own stack
+  struct FlowTask {
+    const Core::Scope* rootScope;
+    Core::ScopeRefVector variables;
+    Core::MessageStack messageStack;
+    Core::ProfileCounters counters;
+  };
+
+  std::vector<FlowTask> tasks;
+  for(const auto& scopePair : m_rootScopes) {
+    const Core::Scope& rootScope = scopePair.second;
+    // Every file still gets a stack, even an empty one
+    m_messageStacksFlow[rootScope.file->filename];
+    Core::ScopeRefVector variables = rootScope.getAllChildrenOfType(Core::ScopeType::Variable);
+    if(variables.empty()) {
+      continue;
     }
-    else
-    {
-      LOG(ERROR) << "Could not parse source file '" << filePair.first << "'";
-      ++m_parsingErrors;
+    if(rootScope.file->lines.size() < RULE_TASK_SPLIT_LINES) {
+      tasks.push_back({&rootScope, std::move(variables), Core::MessageStack(), Core::ProfileCounters()});
+      continue;
+    }
+    // Variables come in tree order, those of a function follow each other
+    const Core::Scope* currentFlowScope = nullptr;
+    for(std::size_t i = 0; i < variables.size(); ++i) {
+      const Core::Scope* flowScope = Flow::getFlowScope(variables[i]);
+      if(i == 0 || flowScope != currentFlowScope) {
+        tasks.push_back({&rootScope, Core::ScopeRefVector(), Core::MessageStack(), Core::ProfileCounters()});
+        currentFlowScope = flowScope;
+      }
+      tasks.back().variables.push_back(variables[i]);
+    }
+  }
+
+  // Violations of the baseline are dropped before they reach the task stacks, the others only counted with --summary-only
+  const auto ruleTypes = getBaselineRuleTypes(false);
+  std::deque<Core::BaselineFilter> baselineFilters;
+  const Core::Scope* filterScope = nullptr;
+  for(auto& task : tasks) {
+    if(m_baseline && task.rootScope != filterScope) {
+      baselineFilters.emplace_back(m_baseline.get(), ruleTypes, *task.rootScope->file);
+      filterScope = task.rootScope;
     }
+    task.messageStack.setBaselineFilter(m_baseline ? &baselineFilters.back() : nullptr);
+    task.messageStack.setCountOnly(m_summaryOnly);
+  }
+
+  {
+    const bool profiling = m_profile != nullptr;
+    const std::vector<std::size_t> order = largestFirst(tasks.size(), [&tasks](std::size_t i) { return tasks[i].variables.size(); });
+    Core::TaskScheduler& scheduler = getScheduler();
+    scheduler.run(tasks.size(), [this, &order, &tasks, profiling](std::size_t index) {
+      FlowTask& task = tasks[order[index]];
+      const Core::Profiling::Sample sample(profiling ? &task.counters : nullptr);
+      m_flowAnalyser->analyzeVariables(task.variables, task.messageStack);
+    });
+  }
+
+  if(m_profile) {
+    for(auto& task : tasks) {
+      task.counters.messages = task.messageStack.countMessages();
+      m_profile->add(Core::ProfilePhase::Flow, task.rootScope->file->filename, task.counters);
+    }
+  }
+
+  // The variables of a file are checked in tree order and its tasks follow that order,
+  // merging them in order gives the same stacks as a serial run. A task per file.
+  std::vector<std::size_t> firstTasks;
+  for(std::size_t i = 0; i < tasks.size(); ++i) {
+    if(i == 0 || tasks[i].rootScope != tasks[i - 1].rootScope) {
+      firstTasks.push_back(i);
+    }
+  }
+  getScheduler().run(firstTasks.size(), [this, &tasks, &firstTasks](std::size_t index) {
+    const Core::Scope* rootScope = tasks[firstTasks[index]].rootScope;
+    Core::MessageStack& messageStack = m_messageStacksFlow.at(rootScope->file->filename);
+    for(std::size_t i = firstTasks[index]; i < tasks.size() && tasks[i].rootScope == rootScope; ++i) {
+      messageStack.merge(std::move(tasks[i].messageStack));
+    }
+    messageStack.sort();
+  });
+
+  if(m_baseline) {
+    LOG(INFO) << "Left out " << m_baseline->getMatchCount() << " violations found in the baseline";
   }
 }
 
-SIFT::VectorPairFile SIFT::getFileRange(unsigned int start, unsigned int count) {
-  VectorPairFile files;
-  
-  for(unsigned int i = start; i < start+count && i < m_files.size(); ++i) {
-    auto& pa = m_files[i];
-    files.push_back(std::make_pair(pa.first, &pa.second));
+void SIFT::setProfileFilename(const std::string& filename) {
+  m_profileFilename = filename;
+  if(filename.empty()) {
+    m_profile.reset();
+  } else if(!m_profile) {
+    m_profile = std::make_unique<Core::ProfileReport>();
+  }
+}
+
+void SIFT::writeProfile() const {
+  if(!m_profile) {
+    return;
+  }
+
+  if(m_profile->write(m_profileFilename, PROFILE_TOP_COUNT)) {
+    LOG(INFO) << "Profile written to '" << m_profileFilename << "'";
+  } else {
+    LOG(ERROR) << "Could not write the profile to '" << m_profileFilename << "'";
+  }
+}
+
+void SIFT::extractScopesImpl(Core::File& file, ExtractedFile& out) {
+  ++m_scopedFileExtracted;
+
+  const Core::Profiling::Sample sample(m_profile ? &out.counters : nullptr);
+
+  if(m_scopeCache) {
+    std::vector<Core::Scope> stringLiterals, comments, defines;
+    out.fromCache = m_scopeCache->load(file, out.scope, stringLiterals, comments, defines);
+    if(out.fromCache) {
+      LOG(INFO) << "[" << m_scopedFileExtracted << "/" << m_files.size() << "] Cached " << file.filename;
+      m_scopeExtractor->restoreFile(file.filename, std::move(stringLiterals), std::move(comments), std::move(defines));
+    }
+  }
+
+  out.success = out.fromCache;
+  if(!out.fromCache) {
+    LOG(INFO) << "[" << m_scopedFileExtracted << "/" << m_files.size() << "] Parsing " << file.filename;
+    Core::FileBudget budget(m_budgetLimits.extractionTime, 0);
+    try {
+      const Core::Budgeting::Guard guard(&budget);
+      out.success = m_scopeExtractor->extractScopesFromFile(file, out.scope);
+    } catch(const Core::BudgetExceeded&) {
+      out.budgetExceeded = "extraction stopped after " + budget.getReason();
+    }
+  }
+  if(m_profile) {
+    out.counters.linesScanned += file.lines.size();
+    out.counters.scopesVisited += countScopes(out.scope);
   }
-  
-  return files;
 }
@@ -29,15 +29,25 @@
 #include <thread>
 #include <atomic>
 #include <mutex>
+#include <set>
 
 #include "core/constants.hpp"
 #include "core/message_stack.hpp"
 #include "core/file.hpp"
 #include "core/scope.hpp"
 #include "core/scope_extractor.hpp"
+#include "core/scope_cache.hpp"
+#include "core/profiler.hpp"
+#include "core/budget.hpp"
+#include "core/task_scheduler.hpp"
+#include "core/baseline.hpp"
+#include "core/result_writer.hpp"
+#include "core/result_formatters.hpp"
 #include "syntax/rule.hpp"
+#include "syntax/rule_plan.hpp"
 #include "syntax/syntax_analyser.hpp"
 #include "flow/flow_analyser.hpp"
+#include "flow/function_summary.hpp"
 
 // Class to render the function flow explicit, better than to have everything laid out in main
 class SIFT
@@ -48,25 +58,54 @@ public:
   // Move these to syntax_analyzer accordingly
   void parseArgv(int argc, char** argv);
   void setupLogging();
+  // Loads the baseline given by --baseline, after setupLogging so its messages follow the log settings
+  void setupBaseline();
   void setupRules(const std::string filename);
   void setupRules(std::map<RuleId, Syntax::Rule> rules);
   void extractScopes();
   void applyRules();
-  void registerConflictDefinitions();
   void registerRuleWork();
+  // Opens the output before applyRules so each file is written as soon as its rules are done,
+  // outputMessagesSyntax opens it itself otherwise
+  void openResultWriter();
   void outputMessagesSyntax(long long executionTime);
   void outputMessagesFlow(long long executionTime);
   void readPath(const std::string& path);
   void clearState();
   void verifyFlow();
     
-  const std::map<const std::string, Core::MessageStack> getMessageStacks(){ return m_messageStacks; }
-  const std::map<const std::string, Core::MessageStack> getMessageStacksFlow() { return m_messageStacksFlow; }
-  std::map<std::string, Core::Scope> getScopes() { return m_rootScopes; }
-  std::string getRuleFileName() { return m_ruleFilename; }
-  std::string getPathToParse() { return m_pathToParse; }
+  const std::map<const std::string, Core::MessageStack>& getMessageStacks() const { return m_messageStacks; }
+  const std::map<const std::string, Core::MessageStack>& getMessageStacksFlow() const { return m_messageStacksFlow; }
+  const std::map<std::string, Core::Scope>& getScopes() const { return m_rootScopes; }
+  const std::string& getRuleFileName() const { return m_ruleFilename; }
+  const std::string& getPathToParse() const { return m_pathToParse; }
+  // Empty disables the scope cache
+  void setCacheDirectory(const std::string& directory) { m_cacheDirectory = directory; }
+  const std::set<std::string>& getScopesFromCache() const { return m_scopesFromCache; }
+  const std::set<std::string>& getSummariesFromCache() const { return m_summariesFromCache; }
+  // Empty disables profiling
+  void setProfileFilename(const std::string& filename);
+  // Null when profiling is disabled
+  const Core::ProfileReport* getProfile() const { return m_profile.get(); }
+  void writeProfile() const;
+  void setBudgetLimits(const Core::FileBudgetLimits& limits) { m_budgetLimits = limits; }
+  // filename : why its analysis was cut short
+  const std::map<std::string, std::string>& getBudgetsExceeded() const { return m_budgetsExceeded; }
+  // Messages whose fingerprint is in the baseline are dropped as the rules push them, false when it could not be read
+  bool loadBaseline(const std::string& filename);
+  // Null when no baseline is loaded
+  const Core::Baseline* getBaseline() const { return m_baseline.get(); }
+  // Empty disables writing the baseline
+  void setWriteBaselineFilename(const std::string& filename) { m_writeBaselineFilename = filename; }
+  // Fingerprints every syntax and flow message reported, once both outputs are written
+  void writeBaseline() const;
+  // Threads each phase runs on, 0 for one per core
+  void setJobCount(unsigned int jobCount);
+  // The stacks only count the messages of each rule and the output is their summary table
+  void setSummaryOnly(bool summaryOnly) { m_summaryOnly = summaryOnly; }
   
   const std::map<RuleId, Syntax::Rule>& getRules() { return m_rules; }
+  const Syntax::RulePlan& getRulePlan() const { return m_rulePlan; }
   void readSource(const std::string & filename, const std::vector<std::string>& source);
 private:
   // filename : rawText
@@ -78,31 +117,69 @@ private:
     
   // id : rule
   std::map<RuleId, Syntax::Rule> m_rules;
-    
-  // ruleType : work
-  std::map<Syntax::RuleType, std::function<void(Syntax::Rule&, Core::Scope&, Core::MessageStack&)>> m_rulesWork;
+  // Compiled from m_rules by setupRules, only read while applying them
+  Syntax::RulePlan m_rulePlan;
     
   std::unique_ptr<Flow::FlowAnalyser> m_flowAnalyser;
   std::unique_ptr<Syntax::SyntaxAnalyser> m_syntaxAnalyser;
   std::unique_ptr<Core::ScopeExtractor> m_scopeExtractor;
+  std::unique_ptr<Core::ScopeCache> m_scopeCache;
+  std::set<std::string> m_scopesFromCache;
+  // Only filled with --summaries, registered with the flow analyser
+  Flow::FunctionSummaries m_functionSummaries;
+  std::set<std::string> m_summariesFromCache;
+  std::unique_ptr<Core::ProfileReport> m_profile;
   std::map<const std::string, Core::MessageStack> m_messageStacks;
   std::map<const std::string, Core::MessageStack> m_messageStacksFlow;
-  std::map<Syntax::RuleType, std::vector<Syntax::RuleType>> m_conflict_definitions;
+  Core::FileBudgetLimits m_budgetLimits;
+  std::map<std::string, std::string> m_budgetsExceeded;
+  std::unique_ptr<Core::ResultWriter> m_resultWriter;
+  std::unique_ptr<Core::Baseline> m_baseline;
+  std::string m_baselineFilename;
+  std::string m_writeBaselineFilename;
+  // Whether applyRules already pushed the result of every file to m_resultWriter
+  bool m_resultsStreamed;
     
   bool m_quietMode;
   bool m_verboseMode;
   std::string m_outputFilename;
+  // text, jsonl or sarif
+  std::string m_outputFormat;
   std::string m_loggingSettingsFilename;
   std::string m_ruleFilename;
   std::string m_pathToParse;
+  std::string m_cacheDirectory;
+  std::string m_profileFilename;
+  bool m_useSummaries;
+  bool m_summaryOnly;
+  unsigned int m_jobCount;
   
   void readSingleSourceFile(const std::string& filename);
   void readFilesFromDirectory(const std::string& directory, const std::string& extensions);
+  // Both phases of the function summaries, before the flow analysis
+  void summarizeFunctions();
+  Core::RuleDescriptions getRuleDescriptions();
+  // Formatter of the syntax or flow results in m_outputFormat
+  std::unique_ptr<Core::ResultFormatter> createResultFormatter(bool syntaxPhase);
+  // hashText of the type of every syntax or flow rule, for their fingerprints
+  std::unordered_map<RuleId, std::uint64_t> getBaselineRuleTypes(bool syntaxPhase) const;
+  // Source the messages of filename are rendered from, null once it is no longer read
+  const Core::File* findSourceFile(const std::string& filename) const;
   
   std::atomic<int> m_parsingErrors;
   std::atomic<int> m_scopedFileExtracted;
   std::mutex m_mutex;
-  using VectorPairFile = std::vector<std::pair<std::string, Core::File*>>;
-  void extractScopesImpl(const VectorPairFile& paths);
-  VectorPairFile getFileRange(unsigned int start, unsigned int count);
+  // What extracting a file gave, filled by the task of the file alone
+  struct ExtractedFile {
+    Core::Scope scope;
+    bool success = false;
+    bool fromCache = false;
+    Core::ProfileCounters counters;
+    // Why the extraction was cut short, empty when it was not
+    std::string budgetExceeded;
+  };
+  void extractScopesImpl(Core::File& file, ExtractedFile& out);
+  // The workers of every phase, started on first use and kept until the instance is destroyed
+  Core::TaskScheduler& getScheduler();
+  std::unique_ptr<Core::TaskScheduler> m_scheduler;
 };
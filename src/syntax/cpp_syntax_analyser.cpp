@@ -22,14 +22,41 @@
  */
 
 #include "cpp_syntax_analyser.hpp"
+#include "pattern_set.hpp"
+#include "rule_registry.hpp"
 
+#include <memory>
 #include <regex>
 
 #include "../core/file.hpp"
 #include "../core/message.hpp"
+#include "../core/profiler.hpp"
 
 namespace Syntax
 {
+  namespace {
+
+    // Whether the position is within the scope, or one of the scopes below it, of one of the types
+    bool isWithinScopeOfType(const Core::Scope& scope, unsigned int line, unsigned int position, Core::ScopeType types) {
+      if(scope.isOfType(types)) {
+        return true;
+      }
+
+      Core::Scope dummy;
+      dummy.lineNumberStart = line;
+      dummy.lineNumberEnd = line;
+      dummy.characterNumberStart = position;
+      dummy.characterNumberEnd = position;
+      for(const auto& child : scope.children) {
+        if(dummy.isWithinOtherScope(child) && isWithinScopeOfType(child, line, position, types)) {
+          return true;
+        }
+      }
+      return false;
+    }
+
+  }
+
   CPPSyntaxAnalyser::CPPSyntaxAnalyser()
   {
     
@@ -39,79 +66,129 @@ namespace Syntax
   {
   }
   
-  // Force consistency between name and method
-  #define NS(ns,item) ns::item
-  #define REGISTER_RULE(REG) work[NS(RuleType, REG)] = std::bind(&CPPSyntaxAnalyser::Rule##REG, this, std::placeholders::_1, std::placeholders::_2, std::placeholders::_3)
-  void CPPSyntaxAnalyser::registerRuleWork(std::map<Syntax::RuleType, std::function<void(Syntax::Rule&, Core::Scope&, Core::MessageStack&)>>& work,
-                                           const std::map<std::string, std::vector<Core::Scope>>& literals,  
+  void CPPSyntaxAnalyser::registerRuleWork(const std::map<std::string, std::vector<Core::Scope>>& literals,
                                            const std::map<std::string, std::vector<Core::Scope>>& comments)
   {
-    // Registers a rule, expects a name in Syntax::RuleType::RULENAME and a function named CPPSyntaxAnalyser::RuleRULENAME;
-    REGISTER_RULE(Unknown);
-    REGISTER_RULE(NoAuto);
-    REGISTER_RULE(NoDefine);
-    REGISTER_RULE(NoMacroFunctions);
-    REGISTER_RULE(StartWithX);
-    REGISTER_RULE(EndWithX);
-    REGISTER_RULE(MaxCharactersPerLine);
-    REGISTER_RULE(CurlyBracketsOpenSameLine);
-    REGISTER_RULE(CurlyBracketsOpenSeparateLine);
-    REGISTER_RULE(CurlyBracketsCloseSameLine);
-    REGISTER_RULE(CurlyBracketsCloseSeparateLine);
-    REGISTER_RULE(AlwaysHaveCurlyBrackets);
-    REGISTER_RULE(NoConstCast);
-    REGISTER_RULE(StartWithLowerCase);
-    REGISTER_RULE(StartWithUpperCase);
-    REGISTER_RULE(NameMaxCharacter);
-    REGISTER_RULE(SingleReturn);
-    REGISTER_RULE(NoGoto);
-    REGISTER_RULE(SpaceBetweenOperandsInternal);
-    REGISTER_RULE(NoSpaceBetweenOperandsInternal);
-    REGISTER_RULE(NoCodeAllowedSameLineCurlyBracketsOpen);
-    REGISTER_RULE(NoCodeAllowedSameLineCurlyBracketsClose);
-    REGISTER_RULE(TabIndentation);
-    REGISTER_RULE(CurlyBracketsIndentationAlignWithDeclaration);
-    REGISTER_RULE(ElseSeparateLineFromCurlyBracketClose);
-    REGISTER_RULE(OwnHeaderBeforeStandard);
-    REGISTER_RULE(StandardHeaderBeforeOwn);
-    
-    for(const auto& type : RuleType_list)
-    {
-      const std::string typeString = to_string(type);
-      SIFT_ASSERT(work.find(type) != work.end(), std::string("Rule '" + typeString + "' is defined but has no work registered for it"));
-    }
-
     m_stringLiterals = &literals;
     m_comments = &comments;
   }
 
-  std::string CPPSyntaxAnalyser::getRuleMessage(const Syntax::Rule& rule){
-    // %rp: rule parameter, %rn: rule name, %rs: rule scope
-    std::string ruleMessage = "%rs";
+  RuleKind CPPSyntaxAnalyser::prepareRule(const Syntax::Rule& rule, ScopeRuleWork& scopeWork, LineRuleWork& lineWork)
+  {
+    const RuleDefinition& definition = getRuleDefinition(rule.getRuleType());
+    if(definition.scopeWork) {
+      scopeWork.keyword = definition.keyword;
+      (this->*definition.scopeWork)(rule, scopeWork);
+      return RuleKind::Scope;
+    }
+    if(definition.lineWork) {
+      lineWork.keyword = definition.keyword;
+      (this->*definition.lineWork)(rule, lineWork);
+      // The work of a pattern rule checks it alone, the rule plan combines them with preparePatternRules
+      return rule.getRuleType() == RuleType::Pattern ? RuleKind::Pattern : RuleKind::Line;
+    }
+    return RuleKind::File;
+  }
 
-    switch(rule.getRuleType())
-    {
-      case Syntax::RuleType::StartWithX: ruleMessage = "Expect scopes of type '%rs' to begin with '%rp'"; break;
-      case Syntax::RuleType::EndWithX: ruleMessage = "Expect scopes of type '%rs' to end with '%rp'"; break;
-      case Syntax::RuleType::SingleReturn: ruleMessage = "Expect functions to have a single return"; break;
-      case Syntax::RuleType::TabIndentation: ruleMessage = "Expect indentation to be made using tabs"; break;
-      case Syntax::RuleType::CurlyBracketsIndentationAlignWithDeclaration: ruleMessage = "Expected curly bracket to be aligned with declaration for scope '%rs'"; break;
-      case Syntax::RuleType::ElseSeparateLineFromCurlyBracketClose: ruleMessage = "Expected 'else' to be on a seperate line than '{'"; break;
-      default: break;
+  void CPPSyntaxAnalyser::preparePatternRules(const std::vector<const Syntax::Rule*>& rules, LineRuleWork& work)
+  {
+    std::vector<const Syntax::Rule*> patternRules;
+    std::vector<std::string> patterns;
+    for(const Syntax::Rule* rule : rules) {
+      if(rule->getParameter().empty()) {
+        LOG(ERROR) << *rule << " needs a pattern as parameter";
+        continue;
+      }
+      try {
+        std::regex(rule->getParameter(), std::regex::ECMAScript);
+      } catch(const std::regex_error& e) {
+        LOG(ERROR) << *rule << " has an invalid pattern: " << e.what();
+        continue;
+      }
+      patternRules.push_back(rule);
+      patterns.push_back(rule->getParameter());
+    }
+    if(patternRules.empty()) {
+      return;
+    }
+
+    const auto patternSet = std::make_shared<const PatternSet>(patterns);
+    work.startFile = [this, patternRules, patternSet](const Core::LineTable& table) -> LineVisitor {
+      // Patterns only apply to code, comments and string literals are blanked out once per file
+      auto codeLines = std::make_shared<const std::vector<std::string>>(getCodeLines(table.getFile()));
+      return [patternRules, patternSet, codeLines, &table, candidates = std::vector<std::size_t>()](unsigned int i, Core::MessageStack& messageStack) mutable {
+        const std::string& code = (*codeLines)[i];
+        patternSet->findCandidates(code, candidates);
+        for(const std::size_t pattern : candidates) {
+          const Syntax::Rule& rule = *patternRules[pattern];
+          auto begin = code.cbegin();
+          std::smatch match;
+          while(begin != code.cend() && Core::regexSearch(begin, code.cend(), match, patternSet->getRegex(pattern),
+                                                          begin == code.cbegin() ? std::regex_constants::match_default : std::regex_constants::match_prev_avail)) {
+            const unsigned int position = static_cast<unsigned int>(match[0].first - code.cbegin());
+            if(rule.getScopeType() == Core::ScopeType::All || isWithinScopeOfType(table.getRootScope(), i, position, rule.getScopeType())) {
+              messageStack.pushMessage(rule.getRuleId(), Core::Message::fromSource(Core::MessageType::Error, i, position, i));
+            }
+            // Empty matches still move forward
+            begin = match[0].second == begin ? begin + 1 : match[0].second;
+          }
+        }
+      };
+    };
+  }
+
+  void CPPSyntaxAnalyser::applyFileRule(const Syntax::Rule& rule, Core::Scope& rootScope, Core::MessageStack& messageStack)
+  {
+    const RuleDefinition& definition = getRuleDefinition(rule.getRuleType());
+    if(definition.fileWork) {
+      (this->*definition.fileWork)(rule, rootScope, messageStack);
+      return;
+    }
+
+    // Scope and line rules applied alone, going through the file for that single rule
+    ScopeRuleWork scopeWork;
+    LineRuleWork lineWork;
+    const Core::KeywordHits hits = rootScope.file ? Core::KeywordHits(*rootScope.file) : Core::KeywordHits();
+    if(prepareRule(rule, scopeWork, lineWork) == RuleKind::Scope) {
+      runScopeRules(rootScope, {std::cref(scopeWork)}, hits, messageStack);
+    } else {
+      runLineRules(rootScope, {std::cref(lineWork)}, hits, messageStack);
     }
-        
-    return ruleMessage;
+  }
+
+  std::string CPPSyntaxAnalyser::getRuleMessage(const Syntax::Rule& rule){
+    return getRuleDefinition(rule.getRuleType()).message;
   }
   
-  void CPPSyntaxAnalyser::pushErrorMessage(Core::MessageStack& messageStack, Syntax::Rule& rule, const std::string& line, const Core::Scope& scope) {
+  void CPPSyntaxAnalyser::pushErrorMessage(Core::MessageStack& messageStack, const Syntax::Rule& rule, const Core::Scope& scope) {
     const unsigned int errorOffset = 10;
     int offset = (scope.characterNumberStart <= errorOffset) ? 0 : scope.characterNumberStart - errorOffset;
-    Core::Message message(Core::MessageType::Error,
-                          line.substr(offset, scope.characterNumberEnd - offset + errorOffset),
-                          scope.lineNumberStart,
-                          scope.characterNumberStart
-    );
-    messageStack.pushMessage(rule.getRuleId(), message);
+    // Around the scope on the line it starts on
+    messageStack.pushMessage(rule.getRuleId(), Core::Message::fromSource(Core::MessageType::Error,
+                                                                         scope.lineNumberStart,
+                                                                         scope.characterNumberStart,
+                                                                         scope.lineNumberStart,
+                                                                         offset,
+                                                                         scope.characterNumberEnd - offset + errorOffset
+    ));
+  }
+
+  Core::ScopeType CPPSyntaxAnalyser::getApplicableScopeTypes(const Syntax::Rule& rule) const {
+    return rule.getScopeType() != Core::ScopeType::All ? rule.getScopeType() : getDefaultScopeTypes(rule);
+  }
+
+  Core::ScopeType CPPSyntaxAnalyser::getDefaultScopeTypes(const Syntax::Rule& rule) const {
+    return getRuleDefinition(rule.getRuleType()).defaultScopeTypes;
+  }
+
+  Core::KeywordHits::LineRange CPPSyntaxAnalyser::getHitLines(const Core::Scope& scope, const Core::KeywordHits& hits, Core::Keyword keyword) const {
+    // Same lines as getScopeLines
+    if(!scope.file || scope.lineNumberStart >= scope.file->lines.size()) {
+      const auto& noLines = hits.getLines(Core::Keyword::None);
+      return Core::KeywordHits::LineRange(noLines.end(), noLines.end());
+    }
+    const unsigned int lastLine = scope.isMultiline() ? std::max(scope.lineNumberStart, std::min<unsigned int>(scope.lineNumberEnd, scope.file->lines.size() - 1)) : scope.lineNumberStart;
+    return hits.getLines(keyword, scope.lineNumberStart, lastLine);
   }
 
   Core::ScopeType CPPSyntaxAnalyser::computeApplicableScopeTypes(Core::ScopeType input, Core::ScopeType defaultAll, Core::ScopeType ignoredTypes){
@@ -121,30 +198,22 @@ namespace Syntax
       computed = input;
     }
     
-    unsigned int i = static_cast<unsigned int>(Core::ScopeType::Unknown);
-    do{
-      if((i & static_cast<unsigned int>(ignoredTypes)) != 0){
-        computed = computed & static_cast<Core::ScopeType>(~i); // Remove ignored flag
-      }
-      
-      i >>= 1;
-    }while(i != 0);
-    
-    return computed;
+    return computed & static_cast<Core::ScopeType>(~static_cast<unsigned int>(ignoredTypes)); // Remove ignored flags
   }
 
-  std::vector<Core::Scope> CPPSyntaxAnalyser::getStringLiterals(const std::string & filename) const {
+  const std::vector<Core::Scope>& CPPSyntaxAnalyser::getStringLiterals(const std::string & filename) const {
+    static const std::vector<Core::Scope> noStringLiterals;
     if(m_stringLiterals) {
       auto it = m_stringLiterals->find(filename);
       if(it != m_stringLiterals->end()) {
         return it->second;
       }
     }
-    return std::vector<Core::Scope>();
+    return noStringLiterals;
   }
   
   bool CPPSyntaxAnalyser::isWithinStringLiteral(unsigned int line, unsigned int position, Core::File& file) {
-    auto stringLiterals = getStringLiterals(file.filename);
+    const auto& stringLiterals = getStringLiterals(file.filename);
     Core::Scope dummy;
     dummy.lineNumberStart = line;
     dummy.lineNumberEnd = line;
@@ -181,18 +250,19 @@ namespace Syntax
     return true;
   }
   
-  std::vector<Core::Scope> CPPSyntaxAnalyser::getComments(const std::string& filename) const {
+  const std::vector<Core::Scope>& CPPSyntaxAnalyser::getComments(const std::string& filename) const {
+    static const std::vector<Core::Scope> noComments;
     if(m_comments) {
       auto it = m_comments->find(filename);
       if(it != m_comments->end()) {
         return it->second;
       }
     }
-    return std::vector<Core::Scope>();
+    return noComments;
   }
   
   bool CPPSyntaxAnalyser::isWithinComment(unsigned int line, unsigned int position, Core::File& file) {
-    auto comments = getComments(file.filename);
+    const auto& comments = getComments(file.filename);
     Core::Scope dummy;
     dummy.lineNumberStart = line;
     dummy.lineNumberEnd = line;
@@ -205,465 +275,373 @@ namespace Syntax
     }) != comments.end();
   }
   
+  std::vector<std::string> CPPSyntaxAnalyser::getCodeLines(const Core::File& file) const {
+    std::vector<std::string> lines = file.lines;
+    for(const auto& comment : getComments(file.filename)) {
+      Core::blankOutScope(lines, comment);
+    }
+    for(const auto& literal : getStringLiterals(file.filename)) {
+      Core::blankOutScope(lines, literal);
+    }
+    return lines;
+  }
+
   bool CPPSyntaxAnalyser::isWithinIgnoredScope(unsigned int line, unsigned int position, Core::File& file){
     return isWithinComment(line, position, file) || isWithinStringLiteral(line, position, file);
   }
   
-  void CPPSyntaxAnalyser::RuleUnknown(Syntax::Rule& rule, Core::Scope& rootScope, Core::MessageStack& messageStack) {
-    messageStack.pushMessage(rule.getRuleId(), Core::Message(Core::MessageType::Warning, "Unknown Rule being executed"));
+  void CPPSyntaxAnalyser::RuleUnknown(const Syntax::Rule& rule, Core::Scope& rootScope, Core::MessageStack& messageStack) {
+    messageStack.pushMessage(rule.getRuleId(), Core::MessageType::Warning, "Unknown Rule being executed");
   }
 
-  void CPPSyntaxAnalyser::RuleNoAuto(Syntax::Rule& rule, Core::Scope& rootScope, Core::MessageStack& messageStack) {
-    Core::ScopeType scopeTypes = computeApplicableScopeTypes(rule.getScopeType(), 
-      Core::ScopeType::Variable | Core::ScopeType::Function | Core::ScopeType::Global,
+  void CPPSyntaxAnalyser::RuleNoAuto(const Syntax::Rule& rule, ScopeRuleWork& work) {
+    work.scopeTypes = computeApplicableScopeTypes(rule.getScopeType(), 
+      getDefaultScopeTypes(rule),
       Core::ScopeType::Unknown
     );
     
-    std::regex autoRegex(R"(\b(auto)\b)");
-    for(auto&& currentScope : rootScope.getAllChildrenOfType(scopeTypes)) {
-      int offsetLine = 0;
-      for(const auto& line : currentScope.getScopeLines()){
-        std::string autoText;
-        std::smatch match;
-        if(std::regex_search(line, match, autoRegex)) {
-          autoText = line;
-        
-          Core::Message message(Core::MessageType::Error, 
-            autoText, currentScope.lineNumberStart, currentScope.characterNumberStart
+    const std::regex autoRegex(R"(\b(auto)\b)");
+    work.visit = [this, &rule, autoRegex](const Core::Scope& currentScope, const Core::KeywordHits& hits, Core::MessageStack& messageStack) {
+      const auto hitLines = getHitLines(currentScope, hits, Core::Keyword::Auto);
+      for(auto hit = hitLines.first; hit != hitLines.second; ++hit) {
+        const auto line = currentScope.getScopeLine(*hit);
+        Core::Profiling::countLinesScanned(1);
+        std::cmatch match;
+        if(Core::regexSearch(line.begin(), line.end(), match, autoRegex)) {
+          const Core::Message message = Core::Message::fromSource(Core::MessageType::Error,
+            currentScope.lineNumberStart, currentScope.characterNumberStart,
+            *hit, line.data() - currentScope.file->lines[*hit].data(), line.size()
           );
-                    
-          if(!isWithinIgnoredScope(currentScope.lineNumberStart+offsetLine, line.find(match[1]), *rootScope.file)){
+
+          if(!isWithinIgnoredScope(*hit, line.find(match[1].str()), *currentScope.file)){
             messageStack.pushMessage(rule.getRuleId(), message);
             break;
           }
         }
-        
-        offsetLine++;
       }
-    }
+    };
   } 
   
-  void CPPSyntaxAnalyser::RuleNoDefine(Syntax::Rule& rule, Core::Scope& rootScope, Core::MessageStack& messageStack)
+  void CPPSyntaxAnalyser::RuleNoDefine(const Syntax::Rule& rule, ScopeRuleWork& work)
   {
-    for(auto&& currentScope : rootScope.getAllChildrenOfType(Core::ScopeType::GlobalDefine)) {
-      std::stringstream defineLines;
-
-      const auto& lines = currentScope.getScopeLines();
-      for(unsigned int i = 0; i < lines.size(); i++) {
-        defineLines << lines[i] << "\t";
+    work.scopeTypes = getDefaultScopeTypes(rule);
+    work.visit = [&rule](const Core::Scope& currentScope, const Core::KeywordHits&, Core::MessageStack& messageStack) {
+      // The lines of the define are rendered from the source when the message is written, cut as getScopeLines does
+      std::uint32_t lastLine = currentScope.lineNumberStart;
+      std::uint32_t lastLength = currentScope.characterNumberEnd;
+      if(currentScope.isMultiline()) {
+        const std::uint32_t fileEnd = currentScope.file->lines.empty() ? 0 : currentScope.file->lines.size() - 1;
+        lastLine = std::max<std::uint32_t>(currentScope.lineNumberStart, std::min<std::uint32_t>(currentScope.lineNumberEnd, fileEnd));
+        if(lastLine != currentScope.lineNumberEnd || lastLine == currentScope.lineNumberStart) {
+          lastLength = Core::Message::ToEndOfLine;
+        }
       }
-      
-      Core::Message message(Core::MessageType::Error, 
-        defineLines.str(), currentScope.lineNumberStart, currentScope.characterNumberStart
-      );
-      messageStack.pushMessage(rule.getRuleId(), message);
-    }
+
+      messageStack.pushMessage(rule.getRuleId(), Core::Message::fromSourceLines(Core::MessageType::Error,
+        currentScope.lineNumberStart, currentScope.characterNumberStart, lastLine, lastLength
+      ));
+    };
   }
   
 
-  void CPPSyntaxAnalyser::RuleNoMacroFunctions(Syntax::Rule& rule, Core::Scope& rootScope, Core::MessageStack& messageStack)
+  void CPPSyntaxAnalyser::RuleNoMacroFunctions(const Syntax::Rule& rule, ScopeRuleWork& work)
   {
-    for(auto&& currentScope : rootScope.getAllChildrenOfType(Core::ScopeType::GlobalDefine)) {
-      std::string macro;
-      std::regex macroSearch(R"(.*#define\s*\w*\(.*)");
-      for(const auto& line : currentScope.getScopeLines()) {
-        std::smatch match;
-        if(std::regex_match(line, match, macroSearch))
+    work.scopeTypes = getDefaultScopeTypes(rule);
+    const std::regex macroSearch(R"(.*#define\s*\w*\(.*)");
+    work.visit = [this, &rule, macroSearch](const Core::Scope& currentScope, const Core::KeywordHits& hits, Core::MessageStack& messageStack) {
+      const auto hitLines = getHitLines(currentScope, hits, Core::Keyword::Define);
+      for(auto hit = hitLines.first; hit != hitLines.second; ++hit) {
+        const auto line = currentScope.getScopeLine(*hit);
+        Core::Profiling::countLinesScanned(1);
+        std::cmatch match;
+        if(Core::regexMatch(line.begin(), line.end(), match, macroSearch))
         {
-          macro = line;
+          messageStack.pushMessage(rule.getRuleId(), Core::Message::fromSource(Core::MessageType::Error,
+            currentScope.lineNumberStart, currentScope.characterNumberStart,
+            *hit, line.data() - currentScope.file->lines[*hit].data(), line.size()
+          ));
           break;
         }
       }
-
-      if(macro.empty()){
-        continue;
-      }
-      
-      Core::Message message(Core::MessageType::Error, 
-        macro, currentScope.lineNumberStart, currentScope.characterNumberStart
-      );
-      messageStack.pushMessage(rule.getRuleId(), message);
-    }
+    };
   }
   
   
-  void CPPSyntaxAnalyser::RuleStartWithX(Syntax::Rule& rule, Core::Scope& rootScope, Core::MessageStack& messageStack)
+  void CPPSyntaxAnalyser::RuleStartWithX(const Syntax::Rule& rule, ScopeRuleWork& work)
   {
-    Core::ScopeType scopeTypes = computeApplicableScopeTypes(rule.getScopeType(), 
-      Core::ScopeType::Namespace | Core::ScopeType::Class | Core::ScopeType::Function | Core::ScopeType::Enum | Core::ScopeType::Variable,
+    work.scopeTypes = computeApplicableScopeTypes(rule.getScopeType(), 
+      getDefaultScopeTypes(rule),
       Core::ScopeType::Unknown
     );
 
-    for(auto&& currentScope : rootScope.getAllChildrenOfType(scopeTypes)) {
+    work.visit = [&rule](const Core::Scope& currentScope, const Core::KeywordHits&, Core::MessageStack& messageStack) {
       const auto& param = rule.getParameter();
       if(currentScope.name.compare(0, param.length(), param) != 0) {
-        Core::Message message(Core::MessageType::Error, 
-          currentScope.name, currentScope.lineNumberStart, currentScope.characterNumberStart
-        );
-        messageStack.pushMessage(rule.getRuleId(), message);
+        messageStack.pushMessage(rule.getRuleId(), Core::MessageType::Error, currentScope.name, currentScope.lineNumberStart, currentScope.characterNumberStart);
       }
-    }
+    };
   }
   
-  void CPPSyntaxAnalyser::RuleEndWithX(Syntax::Rule& rule, Core::Scope& rootScope, Core::MessageStack& messageStack)
+  void CPPSyntaxAnalyser::RuleEndWithX(const Syntax::Rule& rule, ScopeRuleWork& work)
   {
-    Core::ScopeType scopeTypes = Core::ScopeType::Namespace | Core::ScopeType::Class | Core::ScopeType::Function | Core::ScopeType::Enum | Core::ScopeType::Variable;
-    if(rule.getScopeType() != Core::ScopeType::All)
-    {
-      scopeTypes = rule.getScopeType();
-    }
+    work.scopeTypes = getApplicableScopeTypes(rule);
     
-    for(auto&& currentScope : rootScope.getAllChildrenOfType(scopeTypes)) {
+    work.visit = [&rule](const Core::Scope& currentScope, const Core::KeywordHits&, Core::MessageStack& messageStack) {
       const auto& param = rule.getParameter();
       if(currentScope.name.length() < param.length() || currentScope.name.compare(currentScope.name.length()-param.length(), currentScope.name.length(), param) != 0) {
-        Core::Message message(Core::MessageType::Error, 
-          currentScope.name, currentScope.lineNumberStart, currentScope.characterNumberStart
-        );
-        messageStack.pushMessage(rule.getRuleId(), message);
+        messageStack.pushMessage(rule.getRuleId(), Core::MessageType::Error, currentScope.name, currentScope.lineNumberStart, currentScope.characterNumberStart);
       }
-    }
+    };
   }
 
-  void CPPSyntaxAnalyser::RuleMaxCharactersPerLine(Syntax::Rule& rule, Core::Scope& rootScope, Core::MessageStack& messageStack) {
-    const auto& lines = rootScope.file->lines;
-
+  void CPPSyntaxAnalyser::RuleMaxCharactersPerLine(const Syntax::Rule& rule, LineRuleWork& work) {
     try {
       const auto maxCharPerLine = std::stoul(rule.getParameter());
-      for(unsigned int i = 0; i < lines.size(); ++i) {
-        if(lines[i].size() > maxCharPerLine) {
-          messageStack.pushMessage(rule.getRuleId(), Core::Message(Core::MessageType::Error,
-                                                                   SSTR(rule.getParameter() << " expected - got: " << lines[i].size()),
-                                                                   i, 0
-          ));
-        }
-      }
+      work.startFile = [&rule, maxCharPerLine](const Core::LineTable& table) -> LineVisitor {
+        return [&rule, &table, maxCharPerLine](unsigned int i, Core::MessageStack& messageStack) {
+          if(table[i].length > maxCharPerLine) {
+            Core::Message message(Core::MessageType::Error, Core::MessageText::ExpectedLength, i, 0);
+            message.length = table[i].length;
+            messageStack.pushMessage(rule.getRuleId(), message, rule.getParameter());
+          }
+        };
+      };
     } catch(const std::exception& e) {
       LOG(ERROR) << "MaxCharactersPerLine rule requires a valid numerical character parameter";
     }
     
   }
 
-  void CPPSyntaxAnalyser::RuleCurlyBracketsOpenSameLine(Syntax::Rule& rule, Core::Scope& rootScope, Core::MessageStack& messageStack)
+  void CPPSyntaxAnalyser::RuleCurlyBracketsOpenSameLine(const Syntax::Rule& rule, ScopeRuleWork& work)
   {
-    Core::ScopeType scopeTypes = Core::ScopeType::Namespace | Core::ScopeType::Class | Core::ScopeType::Function | Core::ScopeType::Conditional;
-    if (rule.getScopeType() != Core::ScopeType::All) {
-      scopeTypes = rule.getScopeType();
-    }
+    work.scopeTypes = getApplicableScopeTypes(rule);
 
-    for (auto&& currentScope : rootScope.getAllChildrenOfType(scopeTypes)) {
+    work.visit = [this, &rule](const Core::Scope& currentScope, const Core::KeywordHits&, Core::MessageStack& messageStack) {
       if (isScopeUsingCurlyBrackets(currentScope) && isOpeningCurlyBracketSeparateLine(currentScope)) {
-        Core::Message message(Core::MessageType::Error,
-          currentScope.name, currentScope.lineNumberStart
-        );
-        messageStack.pushMessage(rule.getRuleId(), message);
+        messageStack.pushMessage(rule.getRuleId(), Core::MessageType::Error, currentScope.name, currentScope.lineNumberStart);
       }
-    }
+    };
   }
 
-  void CPPSyntaxAnalyser::RuleCurlyBracketsOpenSeparateLine(Syntax::Rule& rule, Core::Scope& rootScope, Core::MessageStack& messageStack)
+  void CPPSyntaxAnalyser::RuleCurlyBracketsOpenSeparateLine(const Syntax::Rule& rule, ScopeRuleWork& work)
   {
-    Core::ScopeType scopeTypes = Core::ScopeType::Namespace | Core::ScopeType::Class | Core::ScopeType::Function | Core::ScopeType::Conditional;
-    if (rule.getScopeType() != Core::ScopeType::All)
-    {
-      scopeTypes = rule.getScopeType();
-    }
+    work.scopeTypes = getApplicableScopeTypes(rule);
 
-    for (auto&& currentScope : rootScope.getAllChildrenOfType(scopeTypes)) {
+    work.visit = [this, &rule](const Core::Scope& currentScope, const Core::KeywordHits&, Core::MessageStack& messageStack) {
       if (isScopeUsingCurlyBrackets(currentScope) && !isOpeningCurlyBracketSeparateLine(currentScope)) {
-        Core::Message message(Core::MessageType::Error,
-          currentScope.name, currentScope.lineNumberStart
-        );
-        messageStack.pushMessage(rule.getRuleId(), message);
+        messageStack.pushMessage(rule.getRuleId(), Core::MessageType::Error, currentScope.name, currentScope.lineNumberStart);
       }
-    }
+    };
   }
 
 
 
-  void CPPSyntaxAnalyser::RuleCurlyBracketsCloseSameLine(Syntax::Rule& rule, Core::Scope& rootScope, Core::MessageStack& messageStack)
+  void CPPSyntaxAnalyser::RuleCurlyBracketsCloseSameLine(const Syntax::Rule& rule, ScopeRuleWork& work)
   {
-    Core::ScopeType scopeTypes = Core::ScopeType::Namespace | Core::ScopeType::Class | Core::ScopeType::Function | Core::ScopeType::Conditional;
-    if (rule.getScopeType() != Core::ScopeType::All)
-    {
-      scopeTypes = rule.getScopeType();
-    }
+    work.scopeTypes = getApplicableScopeTypes(rule);
 
-    for (auto&& currentScope : rootScope.getAllChildrenOfType(scopeTypes)) {
+    work.visit = [this, &rule](const Core::Scope& currentScope, const Core::KeywordHits&, Core::MessageStack& messageStack) {
       if (isScopeUsingCurlyBrackets(currentScope) && isClosingCurlyBracketSeparateLine(currentScope)) {
-        Core::Message message(Core::MessageType::Error,
-          currentScope.name, currentScope.lineNumberEnd
-        );
-        messageStack.pushMessage(rule.getRuleId(), message);
+        messageStack.pushMessage(rule.getRuleId(), Core::MessageType::Error, currentScope.name, currentScope.lineNumberEnd);
       }
-
-    }
+    };
   }
 
-  void CPPSyntaxAnalyser::RuleCurlyBracketsCloseSeparateLine(Syntax::Rule& rule, Core::Scope& rootScope, Core::MessageStack& messageStack)
+  void CPPSyntaxAnalyser::RuleCurlyBracketsCloseSeparateLine(const Syntax::Rule& rule, ScopeRuleWork& work)
   {
-    Core::ScopeType scopeTypes = Core::ScopeType::Namespace | Core::ScopeType::Class | Core::ScopeType::Function | Core::ScopeType::Conditional;
-    if (rule.getScopeType() != Core::ScopeType::All)
-    {
-      scopeTypes = rule.getScopeType();
-    }
+    work.scopeTypes = getApplicableScopeTypes(rule);
 
-    for (auto&& currentScope : rootScope.getAllChildrenOfType(scopeTypes)) {
+    work.visit = [this, &rule](const Core::Scope& currentScope, const Core::KeywordHits&, Core::MessageStack& messageStack) {
       if (isScopeUsingCurlyBrackets(currentScope) && !isClosingCurlyBracketSeparateLine(currentScope)) {
-        Core::Message message(Core::MessageType::Error,
-          currentScope.name, currentScope.lineNumberEnd
-        );
-        messageStack.pushMessage(rule.getRuleId(), message);
+        messageStack.pushMessage(rule.getRuleId(), Core::MessageType::Error, currentScope.name, currentScope.lineNumberEnd);
       }
-    }
+    };
   }
 
-  void CPPSyntaxAnalyser::RuleAlwaysHaveCurlyBrackets(Syntax::Rule& rule, Core::Scope& rootScope, Core::MessageStack& messageStack)
+  void CPPSyntaxAnalyser::RuleAlwaysHaveCurlyBrackets(const Syntax::Rule& rule, ScopeRuleWork& work)
   {
-    Core::ScopeType scopeTypes = Core::ScopeType::Conditional;
+    work.scopeTypes = getDefaultScopeTypes(rule);
 
-    for (auto&& currentScope : rootScope.getAllChildrenOfType(scopeTypes)) {
+    work.visit = [this, &rule](const Core::Scope& currentScope, const Core::KeywordHits&, Core::MessageStack& messageStack) {
       if (!isScopeUsingCurlyBrackets(currentScope)) {
-        Core::Message message(Core::MessageType::Error,
-          currentScope.name, currentScope.lineNumberEnd
-        );
-        messageStack.pushMessage(rule.getRuleId(), message);
+        messageStack.pushMessage(rule.getRuleId(), Core::MessageType::Error, currentScope.name, currentScope.lineNumberEnd);
       }
-    }
+    };
   }
   
-  void CPPSyntaxAnalyser::RuleNoConstCast(Syntax::Rule& rule, Core::Scope& rootScope, Core::MessageStack& messageStack) {
-    auto comments = rootScope.getAllChildrenOfType(Core::ScopeType::Comment);
-    std::regex constCastRegex(R"(const_cast<.*>\(.*\))");
-    const auto& lines = rootScope.file->lines;
-    for(unsigned int i = 0; i < lines.size(); ++i) {
-      const auto& line = lines[i];
-      std::smatch match;
-      if(std::regex_search(line, match, constCastRegex)) {
-        Core::Scope dummy;
-        dummy.lineNumberStart = i;
-        dummy.lineNumberEnd = i;
-        dummy.characterNumberStart = line.find(match[0]);
-        dummy.characterNumberEnd = dummy.characterNumberStart+match[0].str().size()-1;
-
-        if(comments.size() > 0) {
-          for(const auto& comment : comments) {
-            if(!dummy.isWithinOtherScope(comment)) {
-              pushErrorMessage(messageStack, rule, line, dummy);
+  void CPPSyntaxAnalyser::RuleNoConstCast(const Syntax::Rule& rule, LineRuleWork& work) {
+    const std::regex constCastRegex(R"(const_cast<.*>\(.*\))");
+    work.startFile = [this, &rule, constCastRegex](const Core::LineTable& table) -> LineVisitor {
+      return [this, &rule, &table, constCastRegex](unsigned int i, Core::MessageStack& messageStack) {
+        const auto& line = table.getFile().lines[i];
+        std::smatch match;
+        if(line.find("const_cast") != std::string::npos && Core::regexSearch(line, match, constCastRegex)) {
+          Core::Scope dummy;
+          dummy.lineNumberStart = i;
+          dummy.lineNumberEnd = i;
+          dummy.characterNumberStart = line.find(match[0]);
+          dummy.characterNumberEnd = dummy.characterNumberStart+match[0].str().size()-1;
+
+          const auto& comments = table.getComments();
+          if(comments.size() > 0) {
+            // Reported once for every comment not holding it
+            const std::size_t reportCount = comments.size() - table.countCommentsHolding(dummy);
+            for(std::size_t report = 0; report < reportCount; ++report) {
+              pushErrorMessage(messageStack, rule, dummy);
             }
+          } else {
+            pushErrorMessage(messageStack, rule, dummy);
           }
-        } else {
-          pushErrorMessage(messageStack, rule, line, dummy);
         }
-      }
-    }
+      };
+    };
   }
 
-  void CPPSyntaxAnalyser::RuleStartWithLowerCase(Syntax::Rule& rule, Core::Scope& rootScope, Core::MessageStack& messageStack)
+  void CPPSyntaxAnalyser::RuleStartWithLowerCase(const Syntax::Rule& rule, ScopeRuleWork& work)
   {
-    Core::ScopeType scopeTypes = Core::ScopeType::Namespace | Core::ScopeType::Class | Core::ScopeType::Function | Core::ScopeType::Enum | Core::ScopeType::Variable;
-    if (rule.getScopeType() != Core::ScopeType::All)
-    {
-      scopeTypes = rule.getScopeType();
-    }
+    work.scopeTypes = getApplicableScopeTypes(rule);
 
-    for (auto&& currentScope : rootScope.getAllChildrenOfType(scopeTypes)) {
+    work.visit = [&rule](const Core::Scope& currentScope, const Core::KeywordHits&, Core::MessageStack& messageStack) {
       if (!islower(currentScope.name[0])) {
-        Core::Message message(Core::MessageType::Error,
-          currentScope.name, currentScope.lineNumberStart, currentScope.characterNumberStart
-        );
-        messageStack.pushMessage(rule.getRuleId(), message);
+        messageStack.pushMessage(rule.getRuleId(), Core::MessageType::Error, currentScope.name, currentScope.lineNumberStart, currentScope.characterNumberStart);
       }
-    }
+    };
   }
 
-  void CPPSyntaxAnalyser::RuleStartWithUpperCase(Syntax::Rule& rule, Core::Scope& rootScope, Core::MessageStack& messageStack)
+  void CPPSyntaxAnalyser::RuleStartWithUpperCase(const Syntax::Rule& rule, ScopeRuleWork& work)
   {
-    Core::ScopeType scopeTypes = Core::ScopeType::Namespace | Core::ScopeType::Class | Core::ScopeType::Function | Core::ScopeType::Enum | Core::ScopeType::Variable;
-    if (rule.getScopeType() != Core::ScopeType::All)
-    {
-      scopeTypes = rule.getScopeType();
-    }
+    work.scopeTypes = getApplicableScopeTypes(rule);
 
-    for (auto&& currentScope : rootScope.getAllChildrenOfType(scopeTypes)) {
+    work.visit = [&rule](const Core::Scope& currentScope, const Core::KeywordHits&, Core::MessageStack& messageStack) {
       if (!isupper(currentScope.name[0])) {
-        Core::Message message(Core::MessageType::Error,
-          currentScope.name, currentScope.lineNumberStart, currentScope.characterNumberStart
-        );
-        messageStack.pushMessage(rule.getRuleId(), message);
+        messageStack.pushMessage(rule.getRuleId(), Core::MessageType::Error, currentScope.name, currentScope.lineNumberStart, currentScope.characterNumberStart);
       }
-    }
+    };
   }
 
-  void CPPSyntaxAnalyser::RuleNameMaxCharacter(Syntax::Rule& rule, Core::Scope& rootScope, Core::MessageStack& messageStack) {
-    Core::ScopeType scopeTypes = Core::ScopeType::Namespace | Core::ScopeType::Class | Core::ScopeType::Function | Core::ScopeType::Enum | Core::ScopeType::Variable;
-    if(rule.getScopeType() != Core::ScopeType::All) {
-      scopeTypes = rule.getScopeType();
-    }
+  void CPPSyntaxAnalyser::RuleNameMaxCharacter(const Syntax::Rule& rule, ScopeRuleWork& work) {
+    work.scopeTypes = getApplicableScopeTypes(rule);
 
     try {
       const auto maxCharPerName = std::stoul(rule.getParameter());
-      for(const auto& scope : rootScope.getAllChildrenOfType(scopeTypes)) {
+      work.visit = [&rule, maxCharPerName](const Core::Scope& scope, const Core::KeywordHits&, Core::MessageStack& messageStack) {
         if(scope.name.size() > maxCharPerName) {
-          Core::Message message(Core::MessageType::Error,
-                                SSTR(scope.name << " - Got: " << scope.name.size()),
-                                scope.lineNumberStart,
-                                scope.characterNumberStart);
-          messageStack.pushMessage(rule.getRuleId(), message);
+          messageStack.pushMessage(rule.getRuleId(), Core::Message(Core::MessageType::Error, Core::MessageText::ArgumentLength,
+                                                                   scope.lineNumberStart,
+                                                                   scope.characterNumberStart),
+                                   scope.name);
         }
-      }
+      };
     } catch(const std::exception& e) {
       LOG(ERROR) << "NameMaxCharacter rule requires a valid numerical character parameter";
     }
   }
 
-  void CPPSyntaxAnalyser::RuleSingleReturn(Syntax::Rule& rule, Core::Scope& rootScope, Core::MessageStack& messageStack) {
-    Core::ScopeType scopeTypes = Core::ScopeType::Function;
-
-    for (auto&& currentScope : rootScope.getAllChildrenOfType(scopeTypes)) {
+  void CPPSyntaxAnalyser::RuleSingleReturn(const Syntax::Rule& rule, ScopeRuleWork& work) {
+    work.scopeTypes = getDefaultScopeTypes(rule);
 
+    const std::regex returnRegex(R"((^|\s)(return)(\(|;|\s|$))");
+    work.visit = [&rule, returnRegex](const Core::Scope& currentScope, const Core::KeywordHits&, Core::MessageStack& messageStack) {
       int counter = 0;
-      std::regex returnRegex(R"((^|\s)(return)(\(|;|\s|$))");
       for (unsigned int i = currentScope.lineNumberStart; i <= currentScope.lineNumberEnd; ++i) {
         const std::string& line = currentScope.file->lines[i];
+        Core::Profiling::countLinesScanned(1);
         std::smatch match;
-        std::regex_search(line, match, returnRegex);
+        Core::regexSearch(line, match, returnRegex);
         if (match.size() > 0) {
           counter++;
           if (counter > 1) {
-            Core::Message message(Core::MessageType::Error,
-              currentScope.name, currentScope.lineNumberStart + 1, currentScope.characterNumberStart
-            );
-            messageStack.pushMessage(rule.getRuleId(), message);
+            messageStack.pushMessage(rule.getRuleId(), Core::MessageType::Error, currentScope.name, currentScope.lineNumberStart + 1, currentScope.characterNumberStart);
             break;
           }
         }
       }
-    }
+    };
   }
 
-  void CPPSyntaxAnalyser::RuleNoGoto(Syntax::Rule& rule, Core::Scope& rootScope, Core::MessageStack& messageStack) {
-    Core::ScopeType scopeTypes = Core::ScopeType::Function;
+  void CPPSyntaxAnalyser::RuleNoGoto(const Syntax::Rule& rule, ScopeRuleWork& work) {
+    work.scopeTypes = getDefaultScopeTypes(rule);
 
-    std::regex gotoRegex(R"(\b(goto)\b)");
-    for (auto&& currentScope : rootScope.getAllChildrenOfType(scopeTypes)) {
-      for (unsigned int i = currentScope.lineNumberStart; i <= currentScope.lineNumberEnd; ++i) {
-        const std::string& line = currentScope.file->lines[i];
+    const std::regex gotoRegex(R"(\b(goto)\b)");
+    work.visit = [&rule, gotoRegex](const Core::Scope& currentScope, const Core::KeywordHits& hits, Core::MessageStack& messageStack) {
+      const auto hitLines = hits.getLines(Core::Keyword::Goto, currentScope.lineNumberStart, currentScope.lineNumberEnd);
+      for (auto hit = hitLines.first; hit != hitLines.second; ++hit) {
+        const std::string& line = currentScope.file->lines[*hit];
+        Core::Profiling::countLinesScanned(1);
         std::smatch match;
-        if (std::regex_search(line, match, gotoRegex)) {
+        if (Core::regexSearch(line, match, gotoRegex)) {
 
-          Core::Message message(Core::MessageType::Error,
-            line + "\n", currentScope.lineNumberStart, currentScope.characterNumberStart
-          );
-          messageStack.pushMessage(rule.getRuleId(), message);
+          messageStack.pushMessage(rule.getRuleId(), Core::Message::fromSource(Core::MessageType::Error,
+            currentScope.lineNumberStart, currentScope.characterNumberStart, *hit, 0, Core::Message::ToEndOfLine, true
+          ));
           break;
         }
       }
-    }
+    };
   }
 
-  void CPPSyntaxAnalyser::RuleSpaceBetweenOperandsInternal(Syntax::Rule& rule, Core::Scope& rootScope, Core::MessageStack& messageStack) {
-    Core::ScopeType scopeTypes = Core::ScopeType::Function | Core::ScopeType::Conditional;
-    if (rule.getScopeType() != Core::ScopeType::All) {
-      scopeTypes = rule.getScopeType();
-    }
+  void CPPSyntaxAnalyser::RuleSpaceBetweenOperandsInternal(const Syntax::Rule& rule, ScopeRuleWork& work) {
+    work.scopeTypes = getApplicableScopeTypes(rule);
 
-    for (auto&& currentScope : rootScope.getAllChildrenOfType(scopeTypes)) {
+    work.visit = [this, &rule](const Core::Scope& currentScope, const Core::KeywordHits&, Core::MessageStack& messageStack) {
       if (!checkSpaceBetweenOperandsInternal(currentScope, false)) {
-        Core::Message message(Core::MessageType::Error,
-          currentScope.name, currentScope.lineNumberStart
-        );
-        messageStack.pushMessage(rule.getRuleId(), message);
+        messageStack.pushMessage(rule.getRuleId(), Core::MessageType::Error, currentScope.name, currentScope.lineNumberStart);
       }
-    }
+    };
   }
 
-  void CPPSyntaxAnalyser::RuleNoSpaceBetweenOperandsInternal(Syntax::Rule& rule, Core::Scope& rootScope, Core::MessageStack& messageStack) {
-    Core::ScopeType scopeTypes = Core::ScopeType::Function | Core::ScopeType::Conditional;
-    if (rule.getScopeType() != Core::ScopeType::All) {
-      scopeTypes = rule.getScopeType();
-    }
+  void CPPSyntaxAnalyser::RuleNoSpaceBetweenOperandsInternal(const Syntax::Rule& rule, ScopeRuleWork& work) {
+    work.scopeTypes = getApplicableScopeTypes(rule);
 
-    for (auto&& currentScope : rootScope.getAllChildrenOfType(scopeTypes)) {
+    work.visit = [this, &rule](const Core::Scope& currentScope, const Core::KeywordHits&, Core::MessageStack& messageStack) {
       if (!checkSpaceBetweenOperandsInternal(currentScope, true)) {
-        Core::Message message(Core::MessageType::Error,
-          currentScope.name, currentScope.lineNumberStart
-        );
-        messageStack.pushMessage(rule.getRuleId(), message);
+        messageStack.pushMessage(rule.getRuleId(), Core::MessageType::Error, currentScope.name, currentScope.lineNumberStart);
       }
-    }
+    };
   }
 
-  void CPPSyntaxAnalyser::RuleNoCodeAllowedSameLineCurlyBracketsOpen(Syntax::Rule& rule, Core::Scope& rootScope, Core::MessageStack& messageStack) {
-    Core::ScopeType scopeTypes = Core::ScopeType::Namespace | Core::ScopeType::Class | Core::ScopeType::Function | Core::ScopeType::Conditional;
-    if (rule.getScopeType() != Core::ScopeType::All) {
-      scopeTypes = rule.getScopeType();
-    }
+  void CPPSyntaxAnalyser::RuleNoCodeAllowedSameLineCurlyBracketsOpen(const Syntax::Rule& rule, ScopeRuleWork& work) {
+    work.scopeTypes = getApplicableScopeTypes(rule);
 
-    for (auto&& currentScope : rootScope.getAllChildrenOfType(scopeTypes)) {
+    work.visit = [this, &rule](const Core::Scope& currentScope, const Core::KeywordHits&, Core::MessageStack& messageStack) {
       if (isScopeUsingCurlyBrackets(currentScope) && !noCodeAfterCurlyBracketSameLineOpen(currentScope)) {
-        Core::Message message(Core::MessageType::Error,
-          currentScope.name, currentScope.lineNumberStart
-        );
-        messageStack.pushMessage(rule.getRuleId(), message);
+        messageStack.pushMessage(rule.getRuleId(), Core::MessageType::Error, currentScope.name, currentScope.lineNumberStart);
       }
-    }
+    };
   }
 
-  void CPPSyntaxAnalyser::RuleNoCodeAllowedSameLineCurlyBracketsClose(Syntax::Rule& rule, Core::Scope& rootScope, Core::MessageStack& messageStack) {
-    Core::ScopeType scopeTypes = Core::ScopeType::Namespace | Core::ScopeType::Class | Core::ScopeType::Function | Core::ScopeType::Conditional;
-    if (rule.getScopeType() != Core::ScopeType::All) {
-      scopeTypes = rule.getScopeType();
-    }
+  void CPPSyntaxAnalyser::RuleNoCodeAllowedSameLineCurlyBracketsClose(const Syntax::Rule& rule, ScopeRuleWork& work) {
+    work.scopeTypes = getApplicableScopeTypes(rule);
 
-    for (auto&& currentScope : rootScope.getAllChildrenOfType(scopeTypes)) {
+    work.visit = [this, &rule](const Core::Scope& currentScope, const Core::KeywordHits&, Core::MessageStack& messageStack) {
       if (isScopeUsingCurlyBrackets(currentScope) && !noCodeAfterCurlyBracketSameLineClose(currentScope)) {
-        Core::Message message(Core::MessageType::Error,
-          currentScope.name, currentScope.lineNumberStart
-        );
-        messageStack.pushMessage(rule.getRuleId(), message);
+        messageStack.pushMessage(rule.getRuleId(), Core::MessageType::Error, currentScope.name, currentScope.lineNumberStart);
       }
-    }
+    };
   }
 
-  void CPPSyntaxAnalyser::RuleTabIndentation(Syntax::Rule& rule, Core::Scope& rootScope, Core::MessageStack& messageStack) {
-    std::regex spaceSearch(R"(^\t*[ ]+[\w]*.*$)");
-    const auto& commentScopes = rootScope.getAllChildrenOfType(Core::ScopeType::Comment);
-    
-    int i = 0;
-    for(const auto& line : rootScope.file->lines){
-      std::smatch match;
-      if (std::regex_search(line, match, spaceSearch)) {
-        bool isInComment = false;
-        for(const auto& commentScope : commentScopes){
-          if(commentScope.isLineWithinScope(i)){
-            isInComment = true;
-            break;
-          }
-        }
-        
-        if(!isInComment){
-          Core::Message message(Core::MessageType::Error,
-                                line, i, 0
-          );
-          messageStack.pushMessage(rule.getRuleId(), message);
+  void CPPSyntaxAnalyser::RuleTabIndentation(const Syntax::Rule& rule, LineRuleWork& work) {
+    work.startFile = [&rule](const Core::LineTable& table) -> LineVisitor {
+      return [&rule, &table](unsigned int i, Core::MessageStack& messageStack) {
+        // Same lines as ^\t*[ ]+[\w]*.*$ outside of comments, a space right after the leading tabs
+        const Core::LineInfo& info = table[i];
+        if(info.indentWidth > info.leadingTabs && !info.has(Core::LineInfo::LineTerminator) && !info.has(Core::LineInfo::WithinComment)) {
+          messageStack.pushMessage(rule.getRuleId(), Core::Message::fromSource(Core::MessageType::Error, i, 0, i));
         }
-      }
-      ++i;
-    }
+      };
+    };
   }
 
-  void CPPSyntaxAnalyser::RuleCurlyBracketsIndentationAlignWithDeclaration(Syntax::Rule& rule, Core::Scope& rootScope, Core::MessageStack& messageStack) {
-    Core::ScopeType scopeTypes = Core::ScopeType::Namespace | Core::ScopeType::Class | Core::ScopeType::Function | Core::ScopeType::Conditional;
-    if(rule.getScopeType() != Core::ScopeType::All) {
-      scopeTypes = rule.getScopeType();
-    }
+  void CPPSyntaxAnalyser::RuleCurlyBracketsIndentationAlignWithDeclaration(const Syntax::Rule& rule, ScopeRuleWork& work) {
+    const Core::ScopeType scopeTypes = getApplicableScopeTypes(rule);
 
     if(!isScopeTypeOfType(rule.getScopeType(), scopeTypes)) {
       LOG(WARNING) << "ScopeType of Rule CurlyBracketsIndentationAlignWithDeclaration for scope " << to_string(rule.getScopeType()) << " is invalid";
       return;
     }
 
-    for(const auto& currentScope : rootScope.getAllChildrenOfType(scopeTypes)) {
+    work.scopeTypes = scopeTypes;
+    work.visit = [&rule](const Core::Scope& currentScope, const Core::KeywordHits&, Core::MessageStack& messageStack) {
       int curlyBracketLineIndex = currentScope.lineNumberStart;
       while(currentScope.file->lines[curlyBracketLineIndex].find('{') == std::string::npos) {
         //Finding the line where { is
@@ -672,113 +650,106 @@ namespace Syntax
       const std::string& curlyBracketOpenLine = currentScope.file->lines[curlyBracketLineIndex];
 
       if(curlyBracketOpenLine.find('{') != currentScope.characterNumberStart) {
-        Core::Message message(Core::MessageType::Error, currentScope.name, currentScope.lineNumberStart, currentScope.characterNumberStart);
-        messageStack.pushMessage(rule.getRuleId(), message);
+        messageStack.pushMessage(rule.getRuleId(), Core::MessageType::Error, currentScope.name, currentScope.lineNumberStart, currentScope.characterNumberStart);
       }
 
       const std::string& curlyBracketCloseLine = currentScope.file->lines[currentScope.lineNumberEnd];
 
       if(curlyBracketCloseLine.find('}') != currentScope.characterNumberStart) {
-        Core::Message message(Core::MessageType::Error, currentScope.name, currentScope.lineNumberEnd, currentScope.characterNumberEnd);
-        messageStack.pushMessage(rule.getRuleId(), message);
+        messageStack.pushMessage(rule.getRuleId(), Core::MessageType::Error, currentScope.name, currentScope.lineNumberEnd, currentScope.characterNumberEnd);
       }
-    }
+    };
   }
 
-  void CPPSyntaxAnalyser::RuleElseSeparateLineFromCurlyBracketClose(Syntax::Rule& rule, Core::Scope& rootScope, Core::MessageStack& messageStack) {
-    Core::ScopeType scopeTypes = Core::ScopeType::Conditional;
+  void CPPSyntaxAnalyser::RuleElseSeparateLineFromCurlyBracketClose(const Syntax::Rule& rule, ScopeRuleWork& work) {
+    work.scopeTypes = getDefaultScopeTypes(rule);
     
     //Ignoring rule applied to a different scope
-    if(rule.getScopeType() != scopeTypes) {
+    if(rule.getScopeType() != work.scopeTypes) {
       LOG(WARNING) << "ScopeType of Rule ElseSeparateLineFromCurlyBracketClose for scope " << to_string(rule.getScopeType()) << " is invalid. Falling back to Conditional";
     }
 
-    for(const auto& currentScope : rootScope.getAllChildrenOfType(scopeTypes)) {
+    work.visit = [this, &rule](const Core::Scope& currentScope, const Core::KeywordHits&, Core::MessageStack& messageStack) {
       if(currentScope.name.find("else") == std::string::npos) {
-        continue;
+        return;
       }
 
       const std::string& line = currentScope.file->lines[currentScope.lineNumberStart];
       const auto indexCurlyBracket = line.find('}');
       if(indexCurlyBracket != std::string::npos && !isWithinStringLiteral(currentScope.lineNumberStart, indexCurlyBracket, *currentScope.file)) {
-        Core::Message message(Core::MessageType::Error, currentScope.name, currentScope.lineNumberEnd, currentScope.characterNumberEnd);
-        messageStack.pushMessage(rule.getRuleId(), message);
+        messageStack.pushMessage(rule.getRuleId(), Core::MessageType::Error, currentScope.name, currentScope.lineNumberEnd, currentScope.characterNumberEnd);
       }
-    }
+    };
   }
 
-  void CPPSyntaxAnalyser::RuleOwnHeaderBeforeStandard(Syntax::Rule& rule, Core::Scope& rootScope, Core::MessageStack& messageStack) {
-    auto comments = rootScope.getAllChildrenOfType(Core::ScopeType::Comment);
-    std::regex includeRegex(R"(#include\s*(.*))");
-    const auto& lines = rootScope.file->lines;
-    bool hasSeenStandard = false;
-
-    for(unsigned int i = 0; i < lines.size(); ++i) {
-      const auto& line = lines[i];
-      std::smatch match;
-      if(std::regex_search(line, match, includeRegex)) {
-        Core::Scope dummy;
-        dummy.lineNumberStart = i;
-        dummy.lineNumberEnd = i;
-        dummy.characterNumberStart = line.find(match[0]);
-        dummy.characterNumberEnd = dummy.characterNumberStart+match[0].str().size()-1;
-
-        if(comments.size() > 0) {
-          for(const auto& comment : comments) {
-            if(!dummy.isWithinOtherScope(comment)) {
+  void CPPSyntaxAnalyser::RuleOwnHeaderBeforeStandard(const Syntax::Rule& rule, LineRuleWork& work) {
+    const std::regex includeRegex(R"(#include\s*(.*))");
+    work.startFile = [this, &rule, includeRegex](const Core::LineTable& table) -> LineVisitor {
+      return [this, &rule, &table, includeRegex, hasSeenStandard = false](unsigned int i, Core::MessageStack& messageStack) mutable {
+        const auto& line = table.getFile().lines[i];
+        std::smatch match;
+        if(line.find("#include") != std::string::npos && Core::regexSearch(line, match, includeRegex)) {
+          Core::Scope dummy;
+          dummy.lineNumberStart = i;
+          dummy.lineNumberEnd = i;
+          dummy.characterNumberStart = line.find(match[0]);
+          dummy.characterNumberEnd = dummy.characterNumberStart+match[0].str().size()-1;
+
+          if(table.getComments().size() > 0) {
+            // Checked once for every comment preceding the first one holding the include
+            const std::size_t checkCount = table.findFirstCommentHolding(dummy);
+            for(std::size_t check = 0; check < checkCount; ++check) {
               if(!validateOwnHeaderBeforeStandard(match[1], hasSeenStandard)) {
-                pushErrorMessage(messageStack, rule, line, dummy);
+                pushErrorMessage(messageStack, rule, dummy);
               }
-            } else {
-              break;
             }
-          }
-        } else if(!validateOwnHeaderBeforeStandard(match[1], hasSeenStandard)) {
-          pushErrorMessage(messageStack, rule, line, dummy);
-        }   
-      }
-    }
+          } else if(!validateOwnHeaderBeforeStandard(match[1], hasSeenStandard)) {
+            pushErrorMessage(messageStack, rule, dummy);
+          }   
+        }
+      };
+    };
   }
 
-  void CPPSyntaxAnalyser::RuleStandardHeaderBeforeOwn(Syntax::Rule & rule, Core::Scope & rootScope, Core::MessageStack & messageStack) {
-    auto comments = rootScope.getAllChildrenOfType(Core::ScopeType::Comment);
-    std::regex includeRegex(R"(#include\s*(.*))");
-    const auto& lines = rootScope.file->lines;
-    bool hasSeenOwn = false;
-
-    for(unsigned int i = 0; i < lines.size(); ++i) {
-      const auto& line = lines[i];
-      std::smatch match;
-      if(std::regex_search(line, match, includeRegex)) {
-        Core::Scope dummy;
-        dummy.lineNumberStart = i;
-        dummy.lineNumberEnd = i;
-        dummy.characterNumberStart = line.find(match[0]);
-        dummy.characterNumberEnd = dummy.characterNumberStart+match[0].str().size()-1;
-
-        if(comments.size() > 0) {
-          for(const auto& comment : comments) {
-            if(!dummy.isWithinOtherScope(comment)) {
+  void CPPSyntaxAnalyser::RuleStandardHeaderBeforeOwn(const Syntax::Rule& rule, LineRuleWork& work) {
+    const std::regex includeRegex(R"(#include\s*(.*))");
+    work.startFile = [this, &rule, includeRegex](const Core::LineTable& table) -> LineVisitor {
+      return [this, &rule, &table, includeRegex, hasSeenOwn = false](unsigned int i, Core::MessageStack& messageStack) mutable {
+        const auto& line = table.getFile().lines[i];
+        std::smatch match;
+        if(line.find("#include") != std::string::npos && Core::regexSearch(line, match, includeRegex)) {
+          Core::Scope dummy;
+          dummy.lineNumberStart = i;
+          dummy.lineNumberEnd = i;
+          dummy.characterNumberStart = line.find(match[0]);
+          dummy.characterNumberEnd = dummy.characterNumberStart+match[0].str().size()-1;
+
+          if(table.getComments().size() > 0) {
+            // Checked once for every comment preceding the first one holding the include
+            const std::size_t checkCount = table.findFirstCommentHolding(dummy);
+            for(std::size_t check = 0; check < checkCount; ++check) {
               if(!validateStandardHeaderBeforeOwn(match[1], hasSeenOwn)) {
-                pushErrorMessage(messageStack, rule, line, dummy);
+                pushErrorMessage(messageStack, rule, dummy);
               }
-            } else {
-              break;
             }
+          } else if(!validateStandardHeaderBeforeOwn(match[1], hasSeenOwn)) {
+            pushErrorMessage(messageStack, rule, dummy);
           }
-        } else if(!validateStandardHeaderBeforeOwn(match[1], hasSeenOwn)) {
-          pushErrorMessage(messageStack, rule, line, dummy);
         }
-      }
-    }
+      };
+    };
   }
   
-  bool CPPSyntaxAnalyser::isScopeUsingCurlyBrackets(Core::Scope& scope) {
+  void CPPSyntaxAnalyser::RulePattern(const Syntax::Rule& rule, LineRuleWork& work) {
+    preparePatternRules({&rule}, work);
+  }
+
+  bool CPPSyntaxAnalyser::isScopeUsingCurlyBrackets(const Core::Scope& scope) {
     const std::string& scopeLine = scope.file->lines[scope.lineNumberEnd];
     return scopeLine[scope.characterNumberEnd] == '}';
   }
 
-  bool CPPSyntaxAnalyser::isOpeningCurlyBracketSeparateLine(Core::Scope& scope) {
+  bool CPPSyntaxAnalyser::isOpeningCurlyBracketSeparateLine(const Core::Scope& scope) {
     const std::string& scopeLine = scope.file->lines[scope.lineNumberStart];
     for (unsigned int pos = scope.characterNumberStart; pos < scopeLine.size(); ++pos) {
       const char& c = scopeLine[pos];
@@ -789,7 +760,7 @@ namespace Syntax
     return true;
   }
 
-  bool CPPSyntaxAnalyser::isClosingCurlyBracketSeparateLine(Core::Scope& scope) {
+  bool CPPSyntaxAnalyser::isClosingCurlyBracketSeparateLine(const Core::Scope& scope) {
     const std::string& scopeLine = scope.file->lines[scope.lineNumberEnd];
     for (unsigned int pos = 0; pos < scope.characterNumberEnd; ++pos) {
       const char& c = scopeLine[pos];
@@ -802,7 +773,7 @@ namespace Syntax
 
   // noSpace parameter, true = check if RuleNoSpaceBetweenOperandsInternal is true
   //                    false = check if RuleSpaceBetweenOperandsInternal is true
-  bool CPPSyntaxAnalyser::checkSpaceBetweenOperandsInternal(Core::Scope& scope, bool noSpace) {
+  bool CPPSyntaxAnalyser::checkSpaceBetweenOperandsInternal(const Core::Scope& scope, bool noSpace) {
     unsigned int initialPosition = scope.characterNumberStart + scope.name.size();
     int parenthesisCounter = 0;
     unsigned int finalCharacter = 0;
@@ -903,7 +874,7 @@ namespace Syntax
     return true;
   }
 
-  bool CPPSyntaxAnalyser::noCodeAfterCurlyBracketSameLineOpen(Core::Scope& scope) {
+  bool CPPSyntaxAnalyser::noCodeAfterCurlyBracketSameLineOpen(const Core::Scope& scope) {
     bool foundBracket = false;
     for (unsigned int i = scope.lineNumberStart; i <= scope.lineNumberEnd; ++i) {
       const std::string& scopeLine = scope.file->lines[i];
@@ -923,7 +894,7 @@ namespace Syntax
     return true;
   }
 
-  bool CPPSyntaxAnalyser::noCodeAfterCurlyBracketSameLineClose(Core::Scope& scope) {
+  bool CPPSyntaxAnalyser::noCodeAfterCurlyBracketSameLineClose(const Core::Scope& scope) {
 
     const std::string& scopeLine = scope.file->lines[scope.lineNumberEnd];
     for (unsigned int pos = scope.characterNumberEnd; pos < scopeLine.size(); ++pos) {
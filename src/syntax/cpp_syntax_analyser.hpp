@@ -40,52 +40,67 @@ namespace Syntax {
     virtual ~CPPSyntaxAnalyser();
     
     std::string getRuleMessage(const Syntax::Rule& rule);
-    void registerRuleWork(std::map<Syntax::RuleType, std::function<void(Syntax::Rule&, Core::Scope&, Core::MessageStack&)>>& work,
-                          const std::map<std::string, std::vector<Core::Scope>>& literals = std::map<std::string, std::vector<Core::Scope>>(),
+    void registerRuleWork(const std::map<std::string, std::vector<Core::Scope>>& literals = std::map<std::string, std::vector<Core::Scope>>(),
                           const std::map<std::string, std::vector<Core::Scope>>& comments = std::map<std::string, std::vector<Core::Scope>>());
+    RuleKind prepareRule(const Syntax::Rule& rule, ScopeRuleWork& scopeWork, LineRuleWork& lineWork);
+    void preparePatternRules(const std::vector<const Syntax::Rule*>& rules, LineRuleWork& work);
+    void applyFileRule(const Syntax::Rule& rule, Core::Scope& rootScope, Core::MessageStack& messageStack);
     
-    void RuleUnknown(Syntax::Rule& rule, Core::Scope& rootScope, Core::MessageStack& messageStack);
-    void RuleNoAuto(Syntax::Rule& rule, Core::Scope& rootScope, Core::MessageStack& messageStack);
-    void RuleNoDefine(Syntax::Rule& rule, Core::Scope& rootScope, Core::MessageStack& messageStack);
-    void RuleNoMacroFunctions(Syntax::Rule& rule, Core::Scope& rootScope, Core::MessageStack& messageStack);
-    void RuleStartWithX(Syntax::Rule& rule, Core::Scope& rootScope, Core::MessageStack& messageStack);
-    void RuleEndWithX(Syntax::Rule& rule, Core::Scope& rootScope, Core::MessageStack& messageStack);
-    void RuleMaxCharactersPerLine(Syntax::Rule& rule, Core::Scope& rootScope, Core::MessageStack& messageStack);
-    void RuleCurlyBracketsOpenSameLine(Syntax::Rule& rule, Core::Scope& rootScope, Core::MessageStack& messageStack);
-    void RuleCurlyBracketsOpenSeparateLine(Syntax::Rule& rule, Core::Scope& rootScope, Core::MessageStack& messageStack);
-    void RuleCurlyBracketsCloseSameLine(Syntax::Rule& rule, Core::Scope& rootScope, Core::MessageStack& messageStack);
-    void RuleCurlyBracketsCloseSeparateLine(Syntax::Rule& rule, Core::Scope& rootScope, Core::MessageStack& messageStack);
-    void RuleAlwaysHaveCurlyBrackets(Syntax::Rule& rule, Core::Scope& rootScope, Core::MessageStack& messageStack);
-    void RuleNoConstCast(Syntax::Rule& rule, Core::Scope& rootScope, Core::MessageStack& messageStack);
-    void RuleStartWithLowerCase(Syntax::Rule& rule, Core::Scope& rootScope, Core::MessageStack& messageStack);
-    void RuleStartWithUpperCase(Syntax::Rule& rule, Core::Scope& rootScope, Core::MessageStack& messageStack);
-    void RuleNameMaxCharacter(Syntax::Rule& rule, Core::Scope& rootScope, Core::MessageStack& messageStack);
-    void RuleSingleReturn(Syntax::Rule& rule, Core::Scope& rootScope, Core::MessageStack& messageStack);
-    void RuleNoGoto(Syntax::Rule& rule, Core::Scope& rootScope, Core::MessageStack& messageStack);
-    void RuleSpaceBetweenOperandsInternal(Syntax::Rule& rule, Core::Scope& rootScope, Core::MessageStack& messageStack);
-    void RuleNoSpaceBetweenOperandsInternal(Syntax::Rule& rule, Core::Scope& rootScope, Core::MessageStack& messageStack);
-    void RuleNoCodeAllowedSameLineCurlyBracketsOpen(Syntax::Rule& rule, Core::Scope& rootScope, Core::MessageStack& messageStack);
-    void RuleNoCodeAllowedSameLineCurlyBracketsClose(Syntax::Rule& rule, Core::Scope& rootScope, Core::MessageStack& messageStack);
-    void RuleTabIndentation(Syntax::Rule& rule, Core::Scope& rootScope, Core::MessageStack& messageStack);
-    void RuleCurlyBracketsIndentationAlignWithDeclaration(Syntax::Rule& rule, Core::Scope& rootScope, Core::MessageStack& messageStack);
-    void RuleElseSeparateLineFromCurlyBracketClose(Syntax::Rule& rule, Core::Scope& rootScope, Core::MessageStack& messageStack);
-    void RuleOwnHeaderBeforeStandard(Syntax::Rule& rule, Core::Scope& rootScope, Core::MessageStack& messageStack);
-    void RuleStandardHeaderBeforeOwn(Syntax::Rule& rule, Core::Scope& rootScope, Core::MessageStack& messageStack);
+    // Rules working on the whole file at once
+    void RuleUnknown(const Syntax::Rule& rule, Core::Scope& rootScope, Core::MessageStack& messageStack);
+
+    // Rules working line by line, driven by runLineRules
+    void RuleMaxCharactersPerLine(const Syntax::Rule& rule, LineRuleWork& work);
+    void RuleNoConstCast(const Syntax::Rule& rule, LineRuleWork& work);
+    void RuleTabIndentation(const Syntax::Rule& rule, LineRuleWork& work);
+    void RuleOwnHeaderBeforeStandard(const Syntax::Rule& rule, LineRuleWork& work);
+    void RuleStandardHeaderBeforeOwn(const Syntax::Rule& rule, LineRuleWork& work);
+    void RulePattern(const Syntax::Rule& rule, LineRuleWork& work);
+
+    // Rules working scope by scope, driven by runScopeRules
+    void RuleNoAuto(const Syntax::Rule& rule, ScopeRuleWork& work);
+    void RuleNoDefine(const Syntax::Rule& rule, ScopeRuleWork& work);
+    void RuleNoMacroFunctions(const Syntax::Rule& rule, ScopeRuleWork& work);
+    void RuleStartWithX(const Syntax::Rule& rule, ScopeRuleWork& work);
+    void RuleEndWithX(const Syntax::Rule& rule, ScopeRuleWork& work);
+    void RuleCurlyBracketsOpenSameLine(const Syntax::Rule& rule, ScopeRuleWork& work);
+    void RuleCurlyBracketsOpenSeparateLine(const Syntax::Rule& rule, ScopeRuleWork& work);
+    void RuleCurlyBracketsCloseSameLine(const Syntax::Rule& rule, ScopeRuleWork& work);
+    void RuleCurlyBracketsCloseSeparateLine(const Syntax::Rule& rule, ScopeRuleWork& work);
+    void RuleAlwaysHaveCurlyBrackets(const Syntax::Rule& rule, ScopeRuleWork& work);
+    void RuleStartWithLowerCase(const Syntax::Rule& rule, ScopeRuleWork& work);
+    void RuleStartWithUpperCase(const Syntax::Rule& rule, ScopeRuleWork& work);
+    void RuleNameMaxCharacter(const Syntax::Rule& rule, ScopeRuleWork& work);
+    void RuleSingleReturn(const Syntax::Rule& rule, ScopeRuleWork& work);
+    void RuleNoGoto(const Syntax::Rule& rule, ScopeRuleWork& work);
+    void RuleSpaceBetweenOperandsInternal(const Syntax::Rule& rule, ScopeRuleWork& work);
+    void RuleNoSpaceBetweenOperandsInternal(const Syntax::Rule& rule, ScopeRuleWork& work);
+    void RuleNoCodeAllowedSameLineCurlyBracketsOpen(const Syntax::Rule& rule, ScopeRuleWork& work);
+    void RuleNoCodeAllowedSameLineCurlyBracketsClose(const Syntax::Rule& rule, ScopeRuleWork& work);
+    void RuleCurlyBracketsIndentationAlignWithDeclaration(const Syntax::Rule& rule, ScopeRuleWork& work);
+    void RuleElseSeparateLineFromCurlyBracketClose(const Syntax::Rule& rule, ScopeRuleWork& work);
 
   private:
-    bool isScopeUsingCurlyBrackets(Core::Scope& scope);
-    bool isOpeningCurlyBracketSeparateLine(Core::Scope& scope);
-    bool isClosingCurlyBracketSeparateLine(Core::Scope& scope);
-    bool checkSpaceBetweenOperandsInternal(Core::Scope& scope, bool noSpace);
-    bool noCodeAfterCurlyBracketSameLineOpen(Core::Scope& scope);
-    bool noCodeAfterCurlyBracketSameLineClose(Core::Scope& scope);
+    bool isScopeUsingCurlyBrackets(const Core::Scope& scope);
+    bool isOpeningCurlyBracketSeparateLine(const Core::Scope& scope);
+    bool isClosingCurlyBracketSeparateLine(const Core::Scope& scope);
+    bool checkSpaceBetweenOperandsInternal(const Core::Scope& scope, bool noSpace);
+    bool noCodeAfterCurlyBracketSameLineOpen(const Core::Scope& scope);
+    bool noCodeAfterCurlyBracketSameLineClose(const Core::Scope& scope);
     
-    void pushErrorMessage(Core::MessageStack& messageStack, Syntax::Rule& rule, const std::string& line, const Core::Scope& scope);
+    void pushErrorMessage(Core::MessageStack& messageStack, const Syntax::Rule& rule, const Core::Scope& scope);
+    // Scope types of the rule, the default ones of the rule registry when it is applied to All
+    Core::ScopeType getApplicableScopeTypes(const Syntax::Rule& rule) const;
+    Core::ScopeType getDefaultScopeTypes(const Syntax::Rule& rule) const;
+    // Lines of the scope, as getScopeLines gives them, holding the keyword
+    Core::KeywordHits::LineRange getHitLines(const Core::Scope& scope, const Core::KeywordHits& hits, Core::Keyword keyword) const;
     Core::ScopeType computeApplicableScopeTypes(Core::ScopeType input, Core::ScopeType defaultAll, Core::ScopeType ignoredTypes);
-    std::vector<Core::Scope> getComments(const std::string& filename) const;
+    const std::vector<Core::Scope>& getComments(const std::string& filename) const;
     bool isWithinComment(unsigned int line, unsigned int position, Core::File& file);
-    std::vector<Core::Scope> getStringLiterals(const std::string& filename) const;
+    const std::vector<Core::Scope>& getStringLiterals(const std::string& filename) const;
     bool isWithinStringLiteral(unsigned int line, unsigned int position, Core::File& file);
+    // Lines of the file with comments and string literals blanked out, positions are kept
+    std::vector<std::string> getCodeLines(const Core::File& file) const;
 
     bool validateOwnHeaderBeforeStandard(const std::string& header, bool& hasSeenStandard);
     bool validateStandardHeaderBeforeOwn(const std::string& header, bool& hasSeenOwn);
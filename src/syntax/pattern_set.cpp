@@ -0,0 +1,202 @@
+/* MIT License
+ *
+ * Copyright (c) 2018 Jean-Sebastien Fauteux, Michel Rioux, Raphaël Massabot
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "pattern_set.hpp"
+
+#include <algorithm>
+#include <cctype>
+
+namespace Syntax {
+
+  namespace {
+
+    // Position after the bracket or parenthesis closing the one at start, size of the pattern when unbalanced
+    std::size_t skipClass(const std::string& pattern, std::size_t start) {
+      std::size_t i = start + 1;
+      if(i < pattern.size() && pattern[i] == '^') {
+        ++i;
+      }
+      if(i < pattern.size() && pattern[i] == ']') {
+        ++i;
+      }
+      for(; i < pattern.size(); ++i) {
+        if(pattern[i] == '\\') {
+          ++i;
+        } else if(pattern[i] == ']') {
+          return i + 1;
+        }
+      }
+      return pattern.size();
+    }
+
+    std::size_t skipGroup(const std::string& pattern, std::size_t start) {
+      unsigned int depth = 0;
+      for(std::size_t i = start; i < pattern.size(); ++i) {
+        if(pattern[i] == '\\') {
+          ++i;
+        } else if(pattern[i] == '[') {
+          i = skipClass(pattern, i) - 1;
+        } else if(pattern[i] == '(') {
+          ++depth;
+        } else if(pattern[i] == ')' && --depth == 0) {
+          return i + 1;
+        }
+      }
+      return pattern.size();
+    }
+
+    bool hasTopLevelAlternative(const std::string& pattern) {
+      for(std::size_t i = 0; i < pattern.size(); ++i) {
+        if(pattern[i] == '\\') {
+          ++i;
+        } else if(pattern[i] == '[') {
+          i = skipClass(pattern, i) - 1;
+        } else if(pattern[i] == '(') {
+          i = skipGroup(pattern, i) - 1;
+        } else if(pattern[i] == '|') {
+          return true;
+        }
+      }
+      return false;
+    }
+
+    // Length of the escape at start, which is a single literal character when literal is set
+    std::size_t readEscape(const std::string& pattern, std::size_t start, bool& literal) {
+      if(start + 1 >= pattern.size()) {
+        literal = false;
+        return pattern.size() - start;
+      }
+      const char escaped = pattern[start + 1];
+      literal = !std::isalnum(static_cast<unsigned char>(escaped));
+      switch(escaped) {
+        case 'x': return 4;
+        case 'u': return 6;
+        case 'c': return 3;
+        default: break;
+      }
+      std::size_t length = 2;
+      while(std::isdigit(static_cast<unsigned char>(escaped)) && start + length < pattern.size()
+            && std::isdigit(static_cast<unsigned char>(pattern[start + length]))) {
+        ++length;
+      }
+      return length;
+    }
+
+  }
+
+  PatternSet::PatternSet(const std::vector<std::string>& patterns) {
+    std::vector<std::string> literals;
+    literals.reserve(patterns.size());
+    for(const auto& pattern : patterns) {
+      m_regexes.emplace_back(pattern, std::regex::ECMAScript | std::regex::optimize);
+      literals.push_back(findRequiredLiteral(pattern));
+    }
+
+    m_automaton = Core::LiteralAutomaton(literals);
+    for(std::size_t pattern = 0; pattern < patterns.size(); ++pattern) {
+      if(!m_automaton.isAdded(pattern)) {
+        m_alwaysCandidates.push_back(pattern);
+      }
+    }
+  }
+
+  void PatternSet::findCandidates(const std::string& line, std::vector<std::size_t>& candidates) const {
+    candidates = m_alwaysCandidates;
+
+    Core::LiteralAutomaton::State state = 0;
+    for(const char c : line) {
+      state = m_automaton.next(state, static_cast<unsigned char>(c));
+      if(m_automaton.hasOutputs(state)) {
+        candidates.insert(candidates.end(), m_automaton.beginOutputs(state), m_automaton.endOutputs(state));
+      }
+    }
+
+    if(candidates.size() > m_alwaysCandidates.size()) {
+      std::sort(candidates.begin(), candidates.end());
+      candidates.erase(std::unique(candidates.begin(), candidates.end()), candidates.end());
+    }
+  }
+
+  std::string PatternSet::findRequiredLiteral(const std::string& pattern) {
+    // Each alternative could match without the literals of the others
+    if(hasTopLevelAlternative(pattern)) {
+      return "";
+    }
+
+    std::string longest, current;
+    const auto endRun = [&longest, &current]() {
+      if(current.size() > longest.size()) {
+        longest = current;
+      }
+      current.clear();
+    };
+
+    std::size_t i = 0;
+    while(i < pattern.size()) {
+      const char c = pattern[i];
+      char literal = c;
+      if(c == '\\') {
+        bool isLiteral = false;
+        const std::size_t length = readEscape(pattern, i, isLiteral);
+        literal = pattern[i + 1];
+        i += length;
+        if(!isLiteral) {
+          endRun(); // Character class, assertion or back reference
+          continue;
+        }
+      } else if(c == '[' || c == '(' || c == '{') {
+        // Classes and groups are left out, as are quantifiers of groups
+        i = c == '[' ? skipClass(pattern, i) : c == '(' ? skipGroup(pattern, i) : pattern.find('}', i);
+        i = i == std::string::npos ? pattern.size() : i + (c == '{');
+        endRun();
+        continue;
+      } else if(std::string(".^$*+?)]}|").find(c) != std::string::npos) {
+        ++i;
+        endRun();
+        continue;
+      } else {
+        ++i;
+      }
+
+      // Quantifiers of the character
+      const char quantifier = i < pattern.size() ? pattern[i] : '\0';
+      if(quantifier == '*' || quantifier == '?') {
+        endRun();
+      } else if(quantifier == '+') {
+        current += literal;
+        endRun();
+      } else if(quantifier == '{') {
+        if(i + 1 < pattern.size() && pattern[i + 1] >= '1' && pattern[i + 1] <= '9') {
+          current += literal;
+        }
+        endRun();
+      } else {
+        current += literal;
+      }
+    }
+    endRun();
+
+    return longest;
+  }
+
+}
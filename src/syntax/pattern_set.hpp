@@ -0,0 +1,58 @@
+/* MIT License
+ *
+ * Copyright (c) 2018 Jean-Sebastien Fauteux, Michel Rioux, Raphaël Massabot
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <regex>
+#include <string>
+#include <vector>
+
+#include "../core/literal_automaton.hpp"
+
+namespace Syntax {
+
+  // Regexes checked together in a single pass over a line. Each regex is reduced to a literal every one of its matches
+  // has to hold, the literals of all the regexes go in one LiteralAutomaton and a regex only runs on the lines holding
+  // its literal. Regexes without such a literal, alternatives at the top level for instance, run on every line.
+  class PatternSet {
+  public:
+    PatternSet() { }
+    // Throws std::regex_error when a pattern is not a valid ECMAScript regex
+    explicit PatternSet(const std::vector<std::string>& patterns);
+
+    std::size_t size() const { return m_regexes.size(); }
+    const std::regex& getRegex(std::size_t pattern) const { return m_regexes[pattern]; }
+    // Patterns that may match the line, ascending
+    void findCandidates(const std::string& line, std::vector<std::size_t>& candidates) const;
+
+    // Longest text any match of the pattern holds, empty when there is none or the pattern is too complex to tell
+    static std::string findRequiredLiteral(const std::string& pattern);
+
+  private:
+    std::vector<std::regex> m_regexes;
+    Core::LiteralAutomaton m_automaton;
+    std::vector<std::size_t> m_alwaysCandidates; // Patterns without literal in the automaton
+  };
+
+}
@@ -21,11 +21,15 @@
  * SOFTWARE.
  */
 #include "rule.hpp"
+
+#include <functional>
+
+#include "rule_registry.hpp"
 #include "../core/utils.hpp"
 
 namespace Syntax {
   
-  std::map<RuleId, Rule> readRules(const std::map<Syntax::RuleType, std::vector<Syntax::RuleType>> &conflicts, const std::string& rulesFile) {
+  std::map<RuleId, Rule> readRules(const std::string& rulesFile) {
     static long long int currentId = 0;
     std::map<RuleId, Rule> rules;
     
@@ -39,6 +43,7 @@ namespace Syntax {
       {
         const std::string parameter = (jsonRule.find("parameter") != jsonRule.end()) ? jsonRule["parameter"].get<std::string>() : "";
         const std::string appliedTo = (jsonRule.find("appliedTo") != jsonRule.end()) ? jsonRule["appliedTo"].get<std::string>() : "All";
+        const std::string message = (jsonRule.find("message") != jsonRule.end()) ? jsonRule["message"].get<std::string>() : "";
         std::string ruleText = jsonRule["rule"].get<std::string>();
         RuleType ruleType = RuleType_to_enum_class(ruleText);
         
@@ -57,17 +62,15 @@ namespace Syntax {
         Rule rule(++currentId,
                   Core::ScopeType_to_enum_class(appliedTo),
                   ruleType,
-                  parameter);
+                  parameter,
+                  message);
       
-        const auto conflictVectorIt = conflicts.find(rule.getRuleType());
         Syntax::Rule const* ruleInConflict = nullptr;
-        if(conflictVectorIt != conflicts.cend())
+        if(getRuleDefinition(rule.getRuleType()).conflicts != 0)
         {
-          const auto& conflictVector = conflictVectorIt->second;
           for(const auto& rulePair : rules)
           {
-            const auto& conflictIt = std::find(conflictVector.begin(), conflictVector.end(), rulePair.second.getRuleType());
-            if(conflictIt != conflictVector.end())
+            if(areRulesInConflict(rule.getRuleType(), rulePair.second.getRuleType()))
             {
               // One rule is considering to be clashing if it shares a scope with another one
               bool hasClashingScopes = false;
@@ -113,9 +116,18 @@ namespace Syntax {
   bool operator==(const Rule& lhs, const Rule& rhs) {
     return lhs.getRuleType() == rhs.getRuleType()
       && lhs.getParameter() == rhs.getParameter()
+      && lhs.getMessage() == rhs.getMessage()
       && lhs.getScopeType() == rhs.getScopeType();
   }
   
+  std::size_t RuleHash::operator()(const Rule& rule) const {
+    std::size_t seed = std::hash<std::string>()(rule.getParameter());
+    seed ^= std::hash<std::string>()(rule.getMessage()) + 0x9e3779b9 + (seed << 6) + (seed >> 2);
+    seed ^= std::hash<unsigned int>()(static_cast<unsigned int>(rule.getRuleType())) + 0x9e3779b9 + (seed << 6) + (seed >> 2);
+    seed ^= std::hash<unsigned int>()(static_cast<unsigned int>(rule.getScopeType())) + 0x9e3779b9 + (seed << 6) + (seed >> 2);
+    return seed;
+  }
+  
   std::ostream& operator<<(std::ostream& out, const Syntax::Rule& rule) {
     out << "Rule: " << to_string(rule.getRuleType()) << " - Applied To: " << Core::to_string(rule.getScopeType());
     if(rule.hasParameter()) {
@@ -124,11 +136,12 @@ namespace Syntax {
     return out;
   }
   
-  Rule::Rule(RuleId id, Core::ScopeType applyTo, RuleType type, const std::string& optionalParameter)
+  Rule::Rule(RuleId id, Core::ScopeType applyTo, RuleType type, const std::string& optionalParameter, const std::string& optionalMessage)
     : m_id(id)
     , m_applyTo(applyTo)
     , m_type(type)
     , m_parameter(optionalParameter)
+    , m_message(optionalMessage)
   {
   }
   
@@ -153,4 +166,8 @@ namespace Syntax {
     return m_parameter;
   }
 
+  const std::string& Rule::getMessage() const {
+    return m_message;
+  }
+
 }
@@ -61,29 +61,39 @@ namespace Syntax {
                    CurlyBracketsIndentationAlignWithDeclaration,
                    ElseSeparateLineFromCurlyBracketClose,
                    OwnHeaderBeforeStandard,
-                   StandardHeaderBeforeOwn
+                   StandardHeaderBeforeOwn,
+                   Pattern
                   );
   /* END_RULE_DEFINE_ENUM */
   
   class Rule {
   public:
     Rule() { }
-    Rule(RuleId id, Core::ScopeType applyTo, RuleType type, const std::string& optionalParameter = "");
+    Rule(RuleId id, Core::ScopeType applyTo, RuleType type, const std::string& optionalParameter = "", const std::string& optionalMessage = "");
     
     Core::ScopeType getScopeType() const;
     RuleType getRuleType() const;
     RuleId getRuleId() const;
     bool hasParameter() const;
     const std::string& getParameter() const;
+    // Set by the rule file for the rules, like Pattern, without a message of their own
+    const std::string& getMessage() const;
 
   private:
     RuleId m_id;
     Core::ScopeType m_applyTo;
     RuleType m_type;
     std::string m_parameter;
+    std::string m_message;
   };
 
   std::ostream& operator<<(std::ostream& out, const Syntax::Rule& rule);
-  std::map<RuleId, Rule> readRules(const std::map<Syntax::RuleType, std::vector<Syntax::RuleType>> &conflicts, const std::string& rulesFile);
+  // Rules in conflict with an earlier one sharing a scope type are dropped, conflicts come from the rule registry
+  std::map<RuleId, Rule> readRules(const std::string& rulesFile);
   bool operator==(const Rule& lhs, const Rule& rhs);
+
+  // Hashes what operator== compares, the id is left out
+  struct RuleHash {
+    std::size_t operator()(const Rule& rule) const;
+  };
 }
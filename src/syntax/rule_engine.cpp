@@ -0,0 +1,154 @@
+/* MIT License
+ *
+ * Copyright (c) 2018 Jean-Sebastien Fauteux, Michel Rioux, Raphaël Massabot
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <algorithm>
+#include <array>
+
+#include "rule_engine.hpp"
+#include "../core/budget.hpp"
+#include "../core/scope_index.hpp"
+
+namespace Syntax {
+
+  namespace {
+
+    struct ScopeRuleEntry {
+      const ScopeRuleWork* work;
+      Core::ProfileCounters* counters; // Null when not profiling
+    };
+    using RulesByTypeBit = std::array<std::vector<ScopeRuleEntry>, Core::ScopeIndex::TypeBitCount>;
+
+    void visitChildren(const Core::Scope& scope, unsigned int rulesMask, const RulesByTypeBit& rulesByTypeBit, const Core::KeywordHits& hits, Core::MessageStack& messageStack) {
+      for(const auto& child : scope.children) {
+        Core::Budgeting::checkpoint();
+        const unsigned int type = static_cast<unsigned int>(child.type) & rulesMask;
+        if(type != 0) {
+          // A scope has a single type in practice, a rule matching several of its bits only sees it at the lowest one
+          for(unsigned int bit = 0; bit < Core::ScopeIndex::TypeBitCount; ++bit) {
+            if((type & (1u << bit)) == 0) {
+              continue;
+            }
+            const unsigned int lowerBits = type & ((1u << bit) - 1);
+            for(const ScopeRuleEntry& rule : rulesByTypeBit[bit]) {
+              if((lowerBits & static_cast<unsigned int>(rule.work->scopeTypes)) == 0) {
+                if(rule.counters) {
+                  const Core::Profiling::Sample sample(rule.counters);
+                  ++rule.counters->scopesVisited;
+                  rule.work->visit(child, hits, messageStack);
+                } else {
+                  rule.work->visit(child, hits, messageStack);
+                }
+              }
+            }
+          }
+        }
+
+        visitChildren(child, rulesMask, rulesByTypeBit, hits, messageStack);
+      }
+    }
+
+  }
+
+  void runScopeRules(const Core::Scope& rootScope, const ScopeRuleWorkRefVector& rules, const Core::KeywordHits& hits, Core::MessageStack& messageStack,
+                     Core::ProfileCounters* counters) {
+    RulesByTypeBit rulesByTypeBit;
+    unsigned int rulesMask = 0;
+
+    for(std::size_t i = 0; i < rules.size(); ++i) {
+      const ScopeRuleWork& rule = rules[i];
+      if(!rule.visit || !hits.has(rule.keyword)) {
+        continue;
+      }
+
+      const unsigned int scopeTypes = static_cast<unsigned int>(rule.scopeTypes);
+      for(unsigned int bit = 0; bit < Core::ScopeIndex::TypeBitCount; ++bit) {
+        if((scopeTypes & (1u << bit)) != 0) {
+          rulesByTypeBit[bit].push_back({&rule, counters ? &counters[i] : nullptr});
+        }
+      }
+      rulesMask |= scopeTypes;
+    }
+
+    if(rulesMask != 0) {
+      visitChildren(rootScope, rulesMask, rulesByTypeBit, hits, messageStack);
+    }
+  }
+
+  void runLineRules(const Core::Scope& rootScope, const LineRuleWorkRefVector& rules, const Core::KeywordHits& hits, Core::MessageStack& messageStack,
+                    Core::ProfileCounters* counters) {
+    const auto isRunning = [&hits](const LineRuleWork& rule) {
+      return rule.startFile && hits.has(rule.keyword);
+    };
+    if(!rootScope.file || std::none_of(rules.begin(), rules.end(), isRunning)) {
+      return;
+    }
+
+    const Core::LineTable table(*rootScope.file, rootScope);
+
+    // Messages are kept per rule, visiting the keyword lines of a rule apart from the other lines keeps its order.
+    // For the same reason a profiled run can go through the lines once per rule, timing each rule as a whole.
+    std::vector<LineVisitor> visitors;
+    for(std::size_t i = 0; i < rules.size(); ++i) {
+      const LineRuleWork& rule = rules[i];
+      if(!isRunning(rule)) {
+        continue;
+      }
+
+      Core::ProfileCounters* ruleCounters = counters ? &counters[i] : nullptr;
+      const Core::Profiling::Sample sample(ruleCounters);
+      LineVisitor visitor = rule.startFile(table);
+      if(!visitor) {
+        continue;
+      }
+
+      if(rule.keyword != Core::Keyword::None) {
+        const auto& lines = hits.getLines(rule.keyword);
+        for(const unsigned int line : lines) {
+          Core::Budgeting::checkpoint();
+          visitor(line, messageStack);
+        }
+        Core::Profiling::countLinesScanned(lines.size());
+      } else if(ruleCounters) {
+        for(unsigned int line = 0; line < table.size(); ++line) {
+          Core::Budgeting::checkpoint();
+          visitor(line, messageStack);
+        }
+        Core::Profiling::countLinesScanned(table.size());
+      } else {
+        visitors.push_back(std::move(visitor));
+      }
+    }
+
+    if(visitors.empty()) {
+      return;
+    }
+
+    for(unsigned int line = 0; line < table.size(); ++line) {
+      Core::Budgeting::checkpoint();
+      for(auto& visitor : visitors) {
+        visitor(line, messageStack);
+      }
+    }
+  }
+
+}
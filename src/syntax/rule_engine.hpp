@@ -0,0 +1,72 @@
+/* MIT License
+ *
+ * Copyright (c) 2018 Jean-Sebastien Fauteux, Michel Rioux, Raphaël Massabot
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include <functional>
+#include <vector>
+
+#include "rule.hpp"
+#include "../core/scope.hpp"
+#include "../core/keyword_hits.hpp"
+#include "../core/line_table.hpp"
+#include "../core/message_stack.hpp"
+#include "../core/profiler.hpp"
+
+namespace Syntax {
+
+  // How a rule goes through a file: as a whole, scope by scope or line by line.
+  // Pattern rules go line by line too, all of them at once, see SyntaxAnalyser::preparePatternRules.
+  enum class RuleKind { File, Scope, Line, Pattern };
+
+  // Per scope part of a rule, the rule itself is prepared once and then handed every scope of a matching type
+  struct ScopeRuleWork {
+    Core::ScopeType scopeTypes = Core::ScopeType::Unknown;
+    Core::Keyword keyword = Core::Keyword::None; // Files without it are skipped
+    std::function<void(const Core::Scope&, const Core::KeywordHits&, Core::MessageStack&)> visit; // Empty when the rule has nothing to check
+  };
+
+  using ScopeRuleWorkRefVector = std::vector<std::reference_wrapper<const ScopeRuleWork>>;
+
+  // Walks the tree of rootScope once, every scope is handed to all the rules interested in its type.
+  // Each rule still sees the scopes in the order getAllChildrenOfType would give them. Rules whose keyword is not in hits are left out.
+  // When profiling, counters holds one entry per rule.
+  void runScopeRules(const Core::Scope& rootScope, const ScopeRuleWorkRefVector& rules, const Core::KeywordHits& hits, Core::MessageStack& messageStack,
+                     Core::ProfileCounters* counters = nullptr);
+
+  // Per line part of a rule, started for each file so it can carry state from one line to the next
+  using LineVisitor = std::function<void(unsigned int line, Core::MessageStack&)>;
+
+  struct LineRuleWork {
+    Core::Keyword keyword = Core::Keyword::None; // Only the lines holding it are visited
+    std::function<LineVisitor(const Core::LineTable&)> startFile; // Empty when the rule has nothing to check
+  };
+
+  using LineRuleWorkRefVector = std::vector<std::reference_wrapper<const LineRuleWork>>;
+
+  // Builds the line table of the file once and goes through its lines a single time, every line
+  // being handed to all the rules before moving on to the next one. Rules with a keyword only see the lines of hits holding it.
+  void runLineRules(const Core::Scope& rootScope, const LineRuleWorkRefVector& rules, const Core::KeywordHits& hits, Core::MessageStack& messageStack,
+                    Core::ProfileCounters* counters = nullptr);
+
+}
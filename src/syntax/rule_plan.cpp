@@ -0,0 +1,120 @@
+/* MIT License
+ *
+ * Copyright (c) 2018 Jean-Sebastien Fauteux, Michel Rioux, Raphaël Massabot
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "rule_plan.hpp"
+
+#include <unordered_set>
+
+#include "../core/utils.hpp"
+
+namespace Syntax {
+
+  RulePlan::RulePlan(const std::map<RuleId, Syntax::Rule>& rules, SyntaxAnalyser& analyser)
+  {
+    // The first of identical rules is kept, in id order
+    std::unordered_set<Syntax::Rule, RuleHash> seen;
+    seen.reserve(rules.size());
+    m_compiledRules.reserve(rules.size());
+    for(const auto& rulePair : rules)
+    {
+      if(!seen.insert(rulePair.second).second) {
+        continue;
+      }
+
+      // Works keep a reference to their rule, the reserve above ensures the rules do not move
+      m_compiledRules.emplace_back();
+      CompiledRule& compiled = m_compiledRules.back();
+      compiled.rule = rulePair.second;
+      compiled.kind = analyser.prepareRule(compiled.rule, compiled.scopeWork, compiled.lineWork);
+
+      const bool hasWork = compiled.kind == RuleKind::File
+        || (compiled.kind == RuleKind::Scope && compiled.scopeWork.visit)
+        || ((compiled.kind == RuleKind::Line || compiled.kind == RuleKind::Pattern) && compiled.lineWork.startFile);
+      if(!hasWork) {
+        LOG(WARNING) << compiled.rule << " has nothing to check, it will be skipped";
+        m_compiledRules.pop_back();
+      }
+    }
+
+    std::vector<const Syntax::Rule*> patternRules;
+    for(const auto& compiled : m_compiledRules)
+    {
+      switch(compiled.kind)
+      {
+        case RuleKind::File: m_fileRules.push_back(&compiled.rule); break;
+        case RuleKind::Scope:
+          m_scopeRules.push_back(std::cref(compiled.scopeWork));
+          m_scopeRuleTypes.push_back(compiled.rule.getRuleType());
+          m_usesKeywords |= compiled.scopeWork.keyword != Core::Keyword::None;
+          break;
+        case RuleKind::Line:
+          m_lineRules.push_back(std::cref(compiled.lineWork));
+          m_lineRuleTypes.push_back(compiled.rule.getRuleType());
+          m_usesKeywords |= compiled.lineWork.keyword != Core::Keyword::None;
+          break;
+        case RuleKind::Pattern: patternRules.push_back(&compiled.rule); break;
+      }
+    }
+
+    // Pattern rules share a single line work, going through each line once whatever their number
+    if(!patternRules.empty()) {
+      m_patternWork = std::make_unique<LineRuleWork>();
+      analyser.preparePatternRules(patternRules, *m_patternWork);
+      m_lineRules.push_back(std::cref(*m_patternWork));
+      m_lineRuleTypes.push_back(RuleType::Pattern);
+    }
+  }
+
+  bool RulePlan::empty() const {
+    return m_compiledRules.empty();
+  }
+
+  std::size_t RulePlan::size() const {
+    return m_compiledRules.size();
+  }
+
+  bool RulePlan::usesKeywords() const {
+    return m_usesKeywords;
+  }
+
+  const std::vector<const Syntax::Rule*>& RulePlan::getFileRules() const {
+    return m_fileRules;
+  }
+
+  const ScopeRuleWorkRefVector& RulePlan::getScopeRules() const {
+    return m_scopeRules;
+  }
+
+  const LineRuleWorkRefVector& RulePlan::getLineRules() const {
+    return m_lineRules;
+  }
+
+  const std::vector<RuleType>& RulePlan::getScopeRuleTypes() const {
+    return m_scopeRuleTypes;
+  }
+
+  const std::vector<RuleType>& RulePlan::getLineRuleTypes() const {
+    return m_lineRuleTypes;
+  }
+
+}
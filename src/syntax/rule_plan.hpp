@@ -0,0 +1,80 @@
+/* MIT License
+ *
+ * Copyright (c) 2018 Jean-Sebastien Fauteux, Michel Rioux, Raphaël Massabot
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include <map>
+#include <memory>
+#include <vector>
+
+#include "rule.hpp"
+#include "rule_engine.hpp"
+#include "syntax_analyser.hpp"
+
+namespace Syntax {
+
+  // A rule along with its work, see SyntaxAnalyser::prepareRule
+  struct CompiledRule {
+    Syntax::Rule rule;
+    RuleKind kind = RuleKind::File;
+    ScopeRuleWork scopeWork;
+    LineRuleWork lineWork;
+  };
+
+  // Rules compiled once they are read: duplicates are removed, parameters parsed, patterns compiled and scope types
+  // resolved. Rules that cannot work, such as ones with an invalid parameter, are left out.
+  // The plan is not changed afterwards, every thread applying the rules shares it.
+  class RulePlan {
+  public:
+    RulePlan() { }
+    RulePlan(const std::map<RuleId, Syntax::Rule>& rules, SyntaxAnalyser& analyser);
+    
+    // The works refer to the compiled rules, moving keeps them in place but a copy would not
+    RulePlan(RulePlan&&) = default;
+    RulePlan& operator=(RulePlan&&) = default;
+    RulePlan(const RulePlan&) = delete;
+    RulePlan& operator=(const RulePlan&) = delete;
+
+    bool empty() const;
+    std::size_t size() const;
+    // Whether some rules skip the files, or lines, without their keyword
+    bool usesKeywords() const;
+    const std::vector<const Syntax::Rule*>& getFileRules() const;
+    const ScopeRuleWorkRefVector& getScopeRules() const;
+    const LineRuleWorkRefVector& getLineRules() const;
+    // Rule type of each of getScopeRules() and getLineRules()
+    const std::vector<RuleType>& getScopeRuleTypes() const;
+    const std::vector<RuleType>& getLineRuleTypes() const;
+
+  private:
+    std::vector<CompiledRule> m_compiledRules;
+    std::vector<const Syntax::Rule*> m_fileRules;
+    ScopeRuleWorkRefVector m_scopeRules;
+    LineRuleWorkRefVector m_lineRules;
+    std::vector<RuleType> m_scopeRuleTypes;
+    std::vector<RuleType> m_lineRuleTypes;
+    std::unique_ptr<LineRuleWork> m_patternWork; // All the pattern rules, one of m_lineRules
+    bool m_usesKeywords = false;
+  };
+
+}
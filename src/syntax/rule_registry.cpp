@@ -0,0 +1,126 @@
+/* MIT License
+ *
+ * Copyright (c) 2018 Jean-Sebastien Fauteux, Michel Rioux, Raphaël Massabot
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "rule_registry.hpp"
+
+namespace Syntax {
+
+  namespace {
+
+    using Core::Keyword;
+    using Core::ScopeType;
+
+    constexpr ScopeType Named = ScopeType::Namespace | ScopeType::Class | ScopeType::Function | ScopeType::Enum | ScopeType::Variable;
+    constexpr ScopeType Bracketed = ScopeType::Namespace | ScopeType::Class | ScopeType::Function | ScopeType::Conditional;
+
+    // Force consistency between name and method, expects Syntax::RuleType::RULENAME and CPPSyntaxAnalyser::RuleRULENAME
+    #define FILE_RULE(NAME) RuleType::NAME, &CPPSyntaxAnalyser::Rule##NAME, nullptr, nullptr
+    #define SCOPE_RULE(NAME) RuleType::NAME, nullptr, &CPPSyntaxAnalyser::Rule##NAME, nullptr
+    #define LINE_RULE(NAME) RuleType::NAME, nullptr, nullptr, &CPPSyntaxAnalyser::Rule##NAME
+    #define CONFLICTS(NAME) toRuleTypeSet(RuleType::NAME)
+
+    // Indexed by RuleType
+    constexpr RuleDefinition Registry[] = {
+      {FILE_RULE(Unknown), ScopeType::Source, "%rs", 0, Keyword::None},
+      {SCOPE_RULE(NoAuto), ScopeType::Variable | ScopeType::Function | ScopeType::Global, "%rs", 0, Keyword::Auto},
+      {SCOPE_RULE(NoDefine), ScopeType::GlobalDefine, "%rs", 0, Keyword::Define},
+      {SCOPE_RULE(NoMacroFunctions), ScopeType::GlobalDefine, "%rs", 0, Keyword::Define},
+      {SCOPE_RULE(StartWithX), Named, "Expect scopes of type '%rs' to begin with '%rp'",
+        CONFLICTS(StartWithLowerCase) | CONFLICTS(StartWithUpperCase), Keyword::None},
+      {SCOPE_RULE(EndWithX), Named, "Expect scopes of type '%rs' to end with '%rp'", 0, Keyword::None},
+      {LINE_RULE(MaxCharactersPerLine), ScopeType::Source, "%rs", 0, Keyword::None},
+      {SCOPE_RULE(CurlyBracketsOpenSameLine), Bracketed, "%rs", CONFLICTS(CurlyBracketsOpenSeparateLine), Keyword::None},
+      {SCOPE_RULE(CurlyBracketsOpenSeparateLine), Bracketed, "%rs", CONFLICTS(CurlyBracketsOpenSameLine), Keyword::None},
+      {SCOPE_RULE(CurlyBracketsCloseSameLine), Bracketed, "%rs", CONFLICTS(CurlyBracketsCloseSeparateLine), Keyword::None},
+      {SCOPE_RULE(CurlyBracketsCloseSeparateLine), Bracketed, "%rs", CONFLICTS(CurlyBracketsCloseSameLine), Keyword::None},
+      {SCOPE_RULE(AlwaysHaveCurlyBrackets), ScopeType::Conditional, "%rs", 0, Keyword::None},
+      {LINE_RULE(NoConstCast), ScopeType::Source, "%rs", 0, Keyword::ConstCast},
+      {SCOPE_RULE(StartWithLowerCase), Named, "%rs", CONFLICTS(StartWithUpperCase) | CONFLICTS(StartWithX), Keyword::None},
+      {SCOPE_RULE(StartWithUpperCase), Named, "%rs", CONFLICTS(StartWithLowerCase) | CONFLICTS(StartWithX), Keyword::None},
+      {SCOPE_RULE(NameMaxCharacter), Named, "%rs", 0, Keyword::None},
+      {SCOPE_RULE(SingleReturn), ScopeType::Function, "Expect functions to have a single return", 0, Keyword::None},
+      {SCOPE_RULE(NoGoto), ScopeType::Function, "%rs", 0, Keyword::Goto},
+      {SCOPE_RULE(SpaceBetweenOperandsInternal), ScopeType::Function | ScopeType::Conditional, "%rs", 0, Keyword::None},
+      {SCOPE_RULE(NoSpaceBetweenOperandsInternal), ScopeType::Function | ScopeType::Conditional, "%rs", 0, Keyword::None},
+      {SCOPE_RULE(NoCodeAllowedSameLineCurlyBracketsOpen), Bracketed, "%rs", 0, Keyword::None},
+      {SCOPE_RULE(NoCodeAllowedSameLineCurlyBracketsClose), Bracketed, "%rs", 0, Keyword::None},
+      {LINE_RULE(TabIndentation), ScopeType::Source, "Expect indentation to be made using tabs", 0, Keyword::None},
+      {SCOPE_RULE(CurlyBracketsIndentationAlignWithDeclaration), Bracketed,
+        "Expected curly bracket to be aligned with declaration for scope '%rs'", 0, Keyword::None},
+      {SCOPE_RULE(ElseSeparateLineFromCurlyBracketClose), ScopeType::Conditional, "Expected 'else' to be on a seperate line than '{'", 0, Keyword::None},
+      {LINE_RULE(OwnHeaderBeforeStandard), ScopeType::Source, "%rs", CONFLICTS(StandardHeaderBeforeOwn), Keyword::Include},
+      {LINE_RULE(StandardHeaderBeforeOwn), ScopeType::Source, "%rs", CONFLICTS(OwnHeaderBeforeStandard), Keyword::Include},
+      {LINE_RULE(Pattern), ScopeType::All, "%rm", 0, Keyword::None},
+    };
+
+    #undef FILE_RULE
+    #undef SCOPE_RULE
+    #undef LINE_RULE
+    #undef CONFLICTS
+
+    constexpr bool hasSingleWork(const RuleDefinition& definition) {
+      return (definition.fileWork != nullptr) + (definition.scopeWork != nullptr) + (definition.lineWork != nullptr) == 1;
+    }
+
+    // Whole file rules get no keyword hits
+    constexpr bool hasValidKeyword(const RuleDefinition& definition) {
+      return definition.keyword == Keyword::None || definition.fileWork == nullptr;
+    }
+
+    constexpr bool isRegistryOrdered() {
+      for(std::size_t i = 0; i < RuleTypeCount; ++i) {
+        if(Registry[i].type != static_cast<RuleType>(i) || !hasSingleWork(Registry[i]) || !hasValidKeyword(Registry[i])) {
+          return false;
+        }
+      }
+      return true;
+    }
+
+    constexpr bool areConflictsSymmetric() {
+      for(std::size_t i = 0; i < RuleTypeCount; ++i) {
+        for(std::size_t j = 0; j < RuleTypeCount; ++j) {
+          const bool iWithJ = (Registry[i].conflicts & toRuleTypeSet(static_cast<RuleType>(j))) != 0;
+          const bool jWithI = (Registry[j].conflicts & toRuleTypeSet(static_cast<RuleType>(i))) != 0;
+          if(iWithJ != jWithI) {
+            return false;
+          }
+        }
+      }
+      return true;
+    }
+
+    static_assert(sizeof(Registry) / sizeof(Registry[0]) == RuleTypeCount, "Every RuleType needs exactly one entry in the rule registry");
+    static_assert(isRegistryOrdered(), "Rule registry entries have to follow the RuleType order, have a single kind of work and keywords only on scope or line rules");
+    static_assert(areConflictsSymmetric(), "Rule conflicts have to be declared on both rules");
+
+  }
+
+  const RuleDefinition& getRuleDefinition(RuleType type) {
+    return Registry[static_cast<std::size_t>(type)];
+  }
+
+  bool areRulesInConflict(RuleType lhs, RuleType rhs) {
+    return (getRuleDefinition(lhs).conflicts & toRuleTypeSet(rhs)) != 0;
+  }
+
+}
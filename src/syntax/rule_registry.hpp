@@ -0,0 +1,69 @@
+/* MIT License
+ *
+ * Copyright (c) 2018 Jean-Sebastien Fauteux, Michel Rioux, Raphaël Massabot
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include "rule.hpp"
+#include "rule_engine.hpp"
+#include "cpp_syntax_analyser.hpp"
+
+#include "../core/keyword_hits.hpp"
+#include "../core/scope.hpp"
+#include "../core/message_stack.hpp"
+
+namespace Syntax {
+
+  // Has to follow the last value of RuleType, the rule registry is checked against it at compile time
+  constexpr std::size_t RuleTypeCount = static_cast<std::size_t>(RuleType::Pattern) + 1;
+
+  // One bit per RuleType
+  using RuleTypeSet = std::uint32_t;
+  static_assert(RuleTypeCount <= sizeof(RuleTypeSet) * 8, "RuleTypeSet is too small to hold every RuleType");
+
+  constexpr RuleTypeSet toRuleTypeSet(RuleType type) {
+    return RuleTypeSet(1) << static_cast<unsigned int>(type);
+  }
+
+  // Everything known about a rule type, exactly one of the three kinds of work is set
+  struct RuleDefinition {
+    using FileWork = void (CPPSyntaxAnalyser::*)(const Syntax::Rule&, Core::Scope&, Core::MessageStack&);
+    using ScopeWork = void (CPPSyntaxAnalyser::*)(const Syntax::Rule&, ScopeRuleWork&);
+    using LineWork = void (CPPSyntaxAnalyser::*)(const Syntax::Rule&, LineRuleWork&);
+
+    RuleType type;
+    FileWork fileWork;
+    ScopeWork scopeWork;
+    LineWork lineWork;
+    Core::ScopeType defaultScopeTypes; // Used when the rule is applied to All
+    const char* message; // %rp: rule parameter, %rn: rule name, %rs: rule scope, %rm: rule message
+    RuleTypeSet conflicts; // Rules that cannot share a scope with this one
+    Core::Keyword keyword; // Files without it have nothing to report for the rule
+  };
+
+  const RuleDefinition& getRuleDefinition(RuleType type);
+  bool areRulesInConflict(RuleType lhs, RuleType rhs);
+
+}
@@ -25,6 +25,7 @@
 
 #include <map>
 #include "rule.hpp"
+#include "rule_engine.hpp"
 #include "../core/scope.hpp"
 #include "../core/message_stack.hpp"
 
@@ -34,9 +35,14 @@ namespace Syntax {
   public:
     
     virtual std::string getRuleMessage(const Syntax::Rule& rule) = 0;
-    virtual void registerRuleWork(std::map<Syntax::RuleType, std::function<void(Syntax::Rule&, Core::Scope&, Core::MessageStack&)>>& work,
-                                      const std::map<std::string, std::vector<Core::Scope>>& literals = std::map<std::string, std::vector<Core::Scope>>(),
-                                      const std::map<std::string, std::vector<Core::Scope>>& comments = std::map<std::string, std::vector<Core::Scope>>()) = 0;
+    // Scopes within which rules should not report, they have to outlive the analysis
+    virtual void registerRuleWork(const std::map<std::string, std::vector<Core::Scope>>& literals = std::map<std::string, std::vector<Core::Scope>>(),
+                                  const std::map<std::string, std::vector<Core::Scope>>& comments = std::map<std::string, std::vector<Core::Scope>>()) = 0;
+    // Fills the work of scope and line rules, expected to be done once per run. File rules go through applyFileRule.
+    virtual RuleKind prepareRule(const Syntax::Rule& rule, ScopeRuleWork& scopeWork, LineRuleWork& lineWork) = 0;
+    // Single line work checking all the pattern rules in one pass over each line, the rules have to outlive it
+    virtual void preparePatternRules(const std::vector<const Syntax::Rule*>& rules, LineRuleWork& work) = 0;
+    virtual void applyFileRule(const Syntax::Rule& rule, Core::Scope& rootScope, Core::MessageStack& messageStack) = 0;
     virtual ~SyntaxAnalyser();
   };
   
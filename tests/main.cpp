@@ -22,6 +22,7 @@
 */
 
 #define CATCH_CONFIG_MAIN
+#define CATCH_CONFIG_NO_POSIX_SIGNALS
 #include <muflihun/easylogging++.h>
 
 INITIALIZE_EASYLOGGINGPP
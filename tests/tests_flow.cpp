@@ -24,6 +24,7 @@
 #include "catch.hh"
 #include "utils.hpp"
 #include "flow/cpp_flow_analyser.hpp"
+#include "flow/identifier_index.hpp"
 #include "core/message_stack.hpp"
 
 TEST_CASE("Testing null pointer", "[rules-nullpointer]") {
@@ -100,4 +101,281 @@ TEST_CASE("Testing uninitialized variable", "[rules-Uninitializedvariable]") {
     REQUIRE(stack.size() == 1);
     REQUIRE(stack.getMessages().begin()->second.size() == 2);
   }
-}
\ No newline at end of file
+}
+TEST_CASE("Testing flow through conditionals", "[flow-conditionals]") {
+  std::vector<std::string> argv = { "program_name", "-q" };
+  SIFT sift;
+  sift.parseArgv(argv.size(), convert(argv).data());
+  sift.setupLogging();
+  Flow::CPPFlowAnalyser flowAnalyser = Flow::CPPFlowAnalyser();
+
+  auto analyze = [&sift, &flowAnalyser](const std::vector<std::string>& source) {
+    sift.clearState();
+    sift.readSource("dummy_filename", source);
+    sift.extractScopes();
+    Core::MessageStack stack;
+    flowAnalyser.analyzeFlow(sift.getScopes().begin()->second, stack);
+    return stack;
+  };
+
+  SECTION("Assigned in a single branch") {
+    const auto stack = analyze({
+      "int main()",
+      "{",
+      "  int value;",
+      "  int *pointer = NULL;",
+      "  if (argc > 1) {",
+      "    value = 2;",
+      "    pointer = &value;",
+      "  }",
+      "  cout << value << endl;",
+      "  cout << pointer << endl;",
+      "}"
+    });
+    REQUIRE(stack.getMessages().size() == 2);
+    REQUIRE(stack.getMessages().at(1).front().line == 9);
+    REQUIRE(stack.getMessages().at(2).front().line == 8);
+  }
+
+  SECTION("Assigned in every branch") {
+    const auto stack = analyze({
+      "int main()",
+      "{",
+      "  int value;",
+      "  if (argc > 1) {",
+      "    value = 2;",
+      "  } else {",
+      "    value = 3;",
+      "  }",
+      "  cout << value << endl;",
+      "}"
+    });
+    REQUIRE_FALSE(stack.hasMessages());
+  }
+
+  SECTION("Used before being assigned in a loop") {
+    const auto stack = analyze({
+      "int main()",
+      "{",
+      "  int total;",
+      "  for (int i = 0; i < 3; ++i) {",
+      "    cout << total << endl;",
+      "    total = i;",
+      "  }",
+      "}"
+    });
+    REQUIRE(stack.getMessages().size() == 1);
+    REQUIRE(stack.getMessages().at(2).front().line == 4);
+  }
+}
+
+TEST_CASE("Testing identifier index", "[flow-identifierindex]") {
+  Core::File file;
+  file.filename = "dummy_filename";
+  file.lines = {
+    "int main()",
+    "{",
+    "  int value; // value is not used here",
+    "  value = 2;",
+    "  cout << \"value\" << value;",
+    "}"
+  };
+  std::vector<Core::Scope> comments;
+  comments.emplace_back(Core::ScopeType::SingleLineComment);
+  comments.back().lineNumberStart = comments.back().lineNumberEnd = 2;
+  comments.back().characterNumberStart = 13;
+  comments.back().characterNumberEnd = 38;
+  std::vector<Core::Scope> literals;
+  literals.emplace_back(Core::ScopeType::StringLiteral);
+  literals.back().lineNumberStart = literals.back().lineNumberEnd = 4;
+  literals.back().characterNumberStart = 10;
+  literals.back().characterNumberEnd = 16;
+
+  Core::Scope function(Core::ScopeType::FreeFunction);
+  function.lineNumberStart = 0;
+  function.lineNumberEnd = 5;
+  Flow::ScopeIdentifierIndexes indexes(file, comments, literals);
+  const Flow::IdentifierIndex& index = indexes.getIndex(function);
+
+  const auto occurrences = index.getOccurrences("value", 0, 5);
+  std::vector<std::pair<unsigned int, unsigned int>> positions;
+  for (auto it = occurrences.first; it != occurrences.second; ++it) {
+    positions.emplace_back(it->line, it->position);
+  }
+  REQUIRE(positions == (std::vector<std::pair<unsigned int, unsigned int>>{{2, 6}, {3, 2}, {4, 21}}));
+  REQUIRE(std::distance(index.getOccurrences("value", 3, 4).first, index.getOccurrences("value", 3, 4).second) == 1);
+  REQUIRE(index.getOccurrences("used", 0, 5).first == index.getOccurrences("used", 0, 5).second);
+  REQUIRE(&indexes.getIndex(function) == &index);
+}
+
+TEST_CASE("Testing parallel flow verification", "[flow-parallel]") {
+  std::vector<std::string> argv = { "program_name", "-q" };
+  SIFT sift;
+  sift.parseArgv(argv.size(), convert(argv).data());
+  sift.setupLogging();
+
+  // Long enough to be split in a task per function
+  std::vector<std::string> source;
+  for (int i = 0; i < 300; ++i) {
+    const std::string index = std::to_string(i);
+    source.insert(source.end(), {
+      "int function" + index + "()",
+      "{",
+      "  int *pointer" + index + " = NULL;",
+      "  int value" + index + ";",
+      "  cout << pointer" + index + " << endl;",
+      "  cout << value" + index + " << endl;",
+      "}"
+    });
+  }
+
+  sift.clearState();
+  sift.readSource("dummy_filename", source);
+  sift.extractScopes();
+  sift.verifyFlow();
+
+  Core::MessageStack serialStack;
+  Flow::CPPFlowAnalyser().analyzeFlow(sift.getScopes().begin()->second, serialStack);
+
+  const Core::MessageStack& parallelStack = sift.getMessageStacksFlow().at("dummy_filename");
+  const auto& parallelMessages = parallelStack.getMessages();
+  REQUIRE(serialStack.getMessages().size() == 2);
+  REQUIRE(parallelMessages.size() == serialStack.getMessages().size());
+  for (const auto& ruleMessagesPair : serialStack.getMessages()) {
+    const auto& messages = parallelMessages.at(ruleMessagesPair.first);
+    REQUIRE(messages.size() == 300);
+    REQUIRE(messages.size() == ruleMessagesPair.second.size());
+    for (std::size_t i = 0; i < messages.size(); ++i) {
+      REQUIRE(messages[i].line == ruleMessagesPair.second[i].line);
+      REQUIRE(parallelStack.getText(messages[i]) == serialStack.getText(ruleMessagesPair.second[i]));
+    }
+  }
+}
+
+TEST_CASE("Testing function summaries across files", "[flow-summaries]") {
+  // Functions declared with a T* return type are not extracted, the type is aliased here
+  const std::vector<std::string> library = {
+    "IntPointer find(int key)",
+    "{",
+    "  if (key > 0) {",
+    "    return NULL;",
+    "  }",
+    "  return lookup(key);",
+    "}",
+    "void fill(int *out)",
+    "{",
+    "  *out = 3;",
+    "}",
+    "void fillTwice(int *out)",
+    "{",
+    "  fill(out);",
+    "}"
+  };
+  const std::vector<std::string> program = {
+    "int main()",
+    "{",
+    "  int *pointer = find(2);",
+    "  int value;",
+    "  fillTwice(&value);",
+    "  cout << pointer << endl;",
+    "  cout << value << endl;",
+    "}"
+  };
+
+  auto analyze = [&library, &program](std::vector<std::string> argv, SIFT& sift) {
+    sift.parseArgv(argv.size(), convert(argv).data());
+    sift.setupLogging();
+    sift.clearState();
+    sift.readSource("library_filename", library);
+    sift.readSource("program_filename", program);
+    sift.extractScopes();
+    sift.verifyFlow();
+    return sift.getMessageStacksFlow().at("program_filename").getMessages();
+  };
+
+  SECTION("Within each file") {
+    SIFT sift;
+    const auto messages = analyze({ "program_name", "-q" }, sift);
+    REQUIRE(messages.size() == 1);
+    REQUIRE(messages.at(2).front().line == 6);
+  }
+
+  SECTION("With the summaries of every file") {
+    SIFT sift;
+    const auto messages = analyze({ "program_name", "-q", "--summaries" }, sift);
+    REQUIRE(messages.size() == 1);
+    REQUIRE(messages.at(1).front().line == 5);
+  }
+
+  SECTION("Summaries reused from the cache") {
+    REQUIRE(Core::createDirectory("temp-summary-cache"));
+    SIFT first;
+    analyze({ "program_name", "-q", "--summaries", "-c", "temp-summary-cache" }, first);
+    SIFT second;
+    const auto messages = analyze({ "program_name", "-q", "--summaries", "-c", "temp-summary-cache" }, second);
+    REQUIRE(second.getSummariesFromCache().size() == 2);
+    REQUIRE(messages.size() == 1);
+    REQUIRE(messages.at(1).front().line == 5);
+  }
+}
+
+TEST_CASE("Testing function summaries of functions sharing a name", "[flow-summaries-overloads]") {
+  auto analyze = [](const std::vector<std::string>& library, const std::vector<std::string>& program, SIFT& sift) {
+    std::vector<std::string> argv = { "program_name", "-q", "--summaries" };
+    sift.parseArgv(argv.size(), convert(argv).data());
+    sift.setupLogging();
+    sift.clearState();
+    sift.readSource("library_filename", library);
+    sift.readSource("program_filename", program);
+    sift.extractScopes();
+    sift.verifyFlow();
+    return sift.getMessageStacksFlow().at("program_filename").getMessages();
+  };
+
+  SECTION("An overload initializing its parameter says nothing of the others") {
+    SIFT sift;
+    const auto messages = analyze({
+      "void fill(int* out)",
+      "{",
+      "  *out = 1;",
+      "}"
+    }, {
+      "void fill(int* out, int unused)",
+      "{",
+      "  log(unused);",
+      "}",
+      "int main()",
+      "{",
+      "  int value;",
+      "  fill(&value, 2);",
+      "  return value;",
+      "}"
+    }, sift);
+    REQUIRE(messages.size() == 1);
+    REQUIRE(messages.at(2).front().line == 8);
+  }
+
+  SECTION("Every function sharing the key has to initialize the parameter") {
+    const std::vector<std::string> program = {
+      "void fill(int* out)",
+      "{",
+      "  log(out);",
+      "}",
+      "int main()",
+      "{",
+      "  int value;",
+      "  fill(&value);",
+      "  return value;",
+      "}"
+    };
+    SIFT sift;
+    const auto messages = analyze({
+      "void fill(int* out)",
+      "{",
+      "  *out = 1;",
+      "}"
+    }, program, sift);
+    REQUIRE(messages.size() == 1);
+    REQUIRE(messages.at(2).front().line == 8);
+  }
+}
@@ -23,15 +23,27 @@
 
 #include "catch.hh"
 
+#include <atomic>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <vector>
+
+#include <nlohmann/json.hpp>
+
 #include "core/message_stack.hpp"
+#include "core/result_formatters.hpp"
+#include "core/result_writer.hpp"
+#include "core/task_scheduler.hpp"
 
 Core::MessageStack createMessageStack(int size) {
   Core::MessageStack stack;
   for(int i = 0; i < size; ++i) {
     if(i % 2 == 0) {
-      stack.pushMessage(0, {Core::MessageType::Warning, std::to_string(i)});
+      stack.pushMessage(0, Core::MessageType::Warning, std::to_string(i));
     } else {
-      stack.pushMessage(0, {Core::MessageType::Error, std::to_string(i)});
+      stack.pushMessage(0, Core::MessageType::Error, std::to_string(i));
     }
   }
   return stack;
@@ -44,4 +56,263 @@ TEST_CASE("Testing Message Stack", "[message]") {
 
     REQUIRE(stack.getMessages().at(0).size() == 10);
   }
+
+  SECTION("Merging keeps the push order") {
+    auto stack = createMessageStack(2);
+    auto other = createMessageStack(3);
+    other.pushMessage(1, Core::MessageType::Error, "other rule");
+
+    stack.merge(std::move(other));
+
+    const auto& messages = stack.getMessages();
+    REQUIRE(messages.size() == 2);
+    REQUIRE(messages.at(0).size() == 5);
+    REQUIRE(stack.getText(messages.at(0)[1]) == "1");
+    REQUIRE(stack.getText(messages.at(0)[2]) == "0");
+    REQUIRE(stack.getText(messages.at(1)[0]) == "other rule");
+    REQUIRE(messages.at(1).size() == 1);
+    REQUIRE_FALSE(other.hasMessages());
+  }
+
+  SECTION("Messages are read by rule, line and column whatever the push order") {
+    Core::MessageStack stack;
+    stack.pushMessage(2, Core::MessageType::Error, "rule 2 line 1", 1);
+    stack.pushMessage(1, Core::MessageType::Error, "rule 1 line 4", 4);
+    Core::MessageStack other;
+    other.pushMessage(1, Core::MessageType::Error, "rule 1 line 2 column 7", 2, 7);
+    other.pushMessage(1, Core::MessageType::Error, "rule 1 line 2 column 3", 2, 3);
+    other.pushMessage(1, Core::MessageType::Error, "rule 1 line 4 again", 4);
+    stack.merge(std::move(other));
+
+    const Core::MessageStack copy = stack;
+    const Core::MessageStack& original = stack;
+    for(const Core::MessageStack* sorted : {&original, &copy}) {
+      const auto& messages = sorted->getMessages();
+      REQUIRE(sorted->size() == 2);
+      REQUIRE(sorted->countMessages() == 5);
+      REQUIRE(messages.at(1).size() == 4);
+      REQUIRE(sorted->getText(messages.at(1)[0]) == "rule 1 line 2 column 3");
+      REQUIRE(sorted->getText(messages.at(1)[1]) == "rule 1 line 2 column 7");
+      REQUIRE(sorted->getText(messages.at(1)[2]) == "rule 1 line 4");
+      REQUIRE(sorted->getText(messages.at(1)[3]) == "rule 1 line 4 again");
+      REQUIRE(sorted->getText(messages.at(2).front()) == "rule 2 line 1");
+    }
+  }
+
+  SECTION("Texts are rendered from the source and the templates") {
+    const Core::File file{"a.cpp", {"int main() {", "  goto end;"}};
+    Core::MessageStack stack;
+    stack.pushMessage(0, Core::Message::fromSource(Core::MessageType::Error, 1, 0, 1, 2, 4));
+    stack.pushMessage(0, Core::Message::fromSource(Core::MessageType::Error, 1, 0, 1, 0, Core::Message::ToEndOfLine, true));
+    Core::Message expected(Core::MessageType::Error, Core::MessageText::ExpectedLength, 0);
+    expected.length = 106;
+    stack.pushMessage(1, expected, "80");
+    stack.pushMessage(2, Core::Message::fromSourceLines(Core::MessageType::Error, 0, 4, 1, 6));
+    stack.pushMessage(2, Core::Message::fromSourceLines(Core::MessageType::Error, 1, 2, 1, 4));
+    Core::MessageStack other;
+    other.pushMessage(1, Core::Message(Core::MessageType::Error, Core::MessageText::NullPointer, 3), "pointer");
+    stack.merge(std::move(other));
+
+    const auto& messages = stack.getMessages();
+    REQUIRE(stack.getText(messages.at(0)[0], &file) == "goto");
+    REQUIRE(stack.getText(messages.at(0)[1], &file) == "  goto end;\n");
+    REQUIRE(stack.getText(messages.at(1)[0]) == "80 expected - got: 106");
+    REQUIRE(stack.getText(messages.at(1)[1]) == "pointer will throw a NULL pointer exception");
+    REQUIRE(stack.getText(messages.at(2)[0], &file) == "main() {\t  goto\t");
+    REQUIRE(stack.getText(messages.at(2)[1], &file) == "goto\t");
+    REQUIRE(sizeof(Core::Message) <= 32);
+  }
+
+  SECTION("Count only stacks keep no message") {
+    Core::MessageStack stack;
+    stack.setCountOnly(true);
+    stack.pushMessage(0, Core::MessageType::Error, "a", 1);
+    stack.pushMessage(1, Core::Message::fromSource(Core::MessageType::Error, 2, 0, 2));
+    Core::MessageStack other;
+    other.setCountOnly(true);
+    other.pushMessage(0, Core::MessageType::Error, "b", 3);
+    Core::MessageStack merged;
+    merged.merge(std::move(stack));
+    merged.merge(std::move(other));
+
+    REQUIRE(merged.isCountOnly());
+    REQUIRE(merged.hasMessages());
+    REQUIRE(merged.getMessages().empty());
+    REQUIRE(merged.countMessages() == 3);
+    REQUIRE(merged.countMessagesByRule() == std::map<RuleId, std::size_t>{{0, 2}, {1, 1}});
+  }
+}
+
+TEST_CASE("Testing Result Writer", "[result-writer]") {
+  const std::string filename = "temp-results.txt";
+  auto readAll = [&filename]() {
+    std::ifstream file(filename);
+    std::stringstream text;
+    text << file.rdbuf();
+    return text.str();
+  };
+
+  Core::MessageStack first;
+  first.pushMessage(0, Core::MessageType::Error, "first", 4);
+  Core::MessageStack second;
+  second.pushMessage(1, Core::MessageType::Error, "second", 1, 3);
+  const Core::MessageStack empty;
+
+  SECTION("Results are written in sequence order") {
+    {
+      Core::RuleDescriptions rules = {{0, {"Rule", "All", "header"}}};
+      Core::ResultWriter writer(filename, false, false, std::make_unique<Core::TextResultFormatter>("Syntax", rules));
+      REQUIRE(writer.isOpen());
+      writer.push(2, {"c.cpp", nullptr, &second, ""});
+      writer.push(1, {"b.cpp", nullptr, &empty, ""});
+      writer.push(0, {"a.cpp", nullptr, &first, "out of time"});
+      writer.close(12);
+    }
+    REQUIRE(readAll() == "+ a.cpp ----------\n  Rule -- header\n    L5: first\n  BudgetExceeded -- out of time\n"
+                         "+ c.cpp ----------\n    L2, Character: 3: second\n"
+                         "Syntax Ran in 12ms\n");
+  }
+
+  SECTION("Closing writes past missing sequences and appending keeps the file") {
+    {
+      Core::ResultWriter writer(filename, false, false, std::make_unique<Core::TextResultFormatter>("Syntax"));
+      writer.push(3, {"c.cpp", nullptr, &second, ""});
+    }
+    {
+      Core::ResultWriter writer(filename, true, false, std::make_unique<Core::TextResultFormatter>("Flow"));
+      writer.push(0, {"a.cpp", nullptr, nullptr, "never extracted"});
+    }
+    REQUIRE(readAll() == "+ c.cpp ----------\n    L2, Character: 3: second\nSyntax Ran in 0ms\n"
+                         "+ a.cpp ----------\n  BudgetExceeded -- never extracted\nFlow Ran in 0ms\n");
+  }
+
+  SECTION("JSON Lines escape what they write") {
+    Core::MessageStack special;
+    special.pushMessage(0, Core::MessageType::Warning, "\"quoted\"\tand caf\xe9 \xc3\xa9t\xc3\xa9\n", 2);
+    {
+      Core::ResultWriter writer(filename, false, false, std::make_unique<Core::JsonLinesResultFormatter>("Syntax", Core::RuleDescriptions{{0, {"Rule", "All", "header"}}}));
+      writer.push(0, {"a\\b.cpp", nullptr, &special, "out of time"});
+      writer.close(7);
+    }
+    std::stringstream lines(readAll());
+    std::vector<nlohmann::json> objects;
+    std::string line;
+    while(std::getline(lines, line)) {
+      objects.push_back(nlohmann::json::parse(line));
+    }
+    REQUIRE(objects.size() == 3);
+    REQUIRE(objects[0]["file"] == "a\\b.cpp");
+    REQUIRE(objects[0]["rule"] == "Rule");
+    REQUIRE(objects[0]["severity"] == "Warning");
+    REQUIRE(objects[0]["line"] == 3);
+    REQUIRE(objects[0]["message"] == "\"quoted\"\tand caf\xc3\xa9 \xc3\xa9t\xc3\xa9\n");
+    REQUIRE(objects[1]["budgetExceeded"] == "out of time");
+    REQUIRE(objects[2]["executionTimeMs"] == 7);
+  }
+
+  SECTION("SARIF phases append to a single log") {
+    {
+      Core::ResultWriter writer(filename, false, false, std::make_unique<Core::SarifResultFormatter>("Syntax", Core::RuleDescriptions{{0, {"Rule", "All", "header"}}}, true, false));
+      writer.push(0, {"a.cpp", nullptr, &first, ""});
+      writer.push(1, {"b.cpp", nullptr, &empty, "out of time"});
+      writer.close(3);
+    }
+    {
+      Core::ResultWriter writer(filename, true, false, std::make_unique<Core::SarifResultFormatter>("Flow", Core::RuleDescriptions(), false, true));
+      writer.push(0, {"c.cpp", nullptr, &second, ""});
+      writer.close(4);
+    }
+    const nlohmann::json log = nlohmann::json::parse(readAll());
+    REQUIRE(log["version"] == "2.1.0");
+    REQUIRE(log["runs"].size() == 2);
+    const auto& syntax = log["runs"][0];
+    REQUIRE(syntax["tool"]["driver"]["rules"][0]["id"] == "0");
+    REQUIRE(syntax["results"].size() == 1);
+    REQUIRE(syntax["results"][0]["level"] == "error");
+    REQUIRE(syntax["results"][0]["locations"][0]["physicalLocation"]["region"]["startLine"] == 5);
+    REQUIRE(syntax["invocations"][0]["toolExecutionNotifications"][0]["message"]["text"] == "out of time");
+    const auto& flow = log["runs"][1];
+    REQUIRE(flow["results"][0]["ruleId"] == "1");
+    REQUIRE(flow["results"][0]["locations"][0]["physicalLocation"]["region"]["startColumn"] == 4);
+    REQUIRE(flow["invocations"][0]["properties"]["executionTimeMs"] == 4);
+  }
+
+  SECTION("Summaries count per file, rule and directory") {
+    Core::MessageStack counted;
+    counted.setCountOnly(true);
+    counted.pushMessage(0, Core::MessageType::Error, "counted", 1);
+    counted.pushMessage(0, Core::MessageType::Error, "counted", 2);
+    {
+      Core::ResultWriter writer(filename, false, false, std::make_unique<Core::SummaryResultFormatter>("Syntax", Core::RuleDescriptions{{0, {"Rule", "All", "header"}}}, true));
+      writer.push(0, {"src/a.cpp", nullptr, &counted, ""});
+      writer.push(1, {"src/b.cpp", nullptr, &first, ""});
+      writer.push(2, {"c.cpp", nullptr, &empty, "out of time"});
+      writer.close(5);
+    }
+    {
+      Core::ResultWriter writer(filename, true, false, std::make_unique<Core::SummaryResultFormatter>("Flow", Core::RuleDescriptions(), false));
+      writer.push(0, {"c.cpp", nullptr, &second, ""});
+      writer.close(6);
+    }
+    REQUIRE(readAll() == "phase\tkind\tname\tmessages\n"
+                         "Syntax\tfile\tsrc/a.cpp\t2\n"
+                         "Syntax\tfile\tsrc/b.cpp\t1\n"
+                         "Syntax\trule\t0:Rule\t3\n"
+                         "Syntax\tdirectory\tsrc\t3\n"
+                         "Syntax\ttotal\tmessages\t3\n"
+                         "Syntax\ttotal\tfiles\t3\n"
+                         "Syntax\ttotal\tbudgetsExceeded\t1\n"
+                         "Syntax\ttotal\texecutionTimeMs\t5\n"
+                         "Flow\tfile\tc.cpp\t1\n"
+                         "Flow\trule\t1\t1\n"
+                         "Flow\tdirectory\t.\t1\n"
+                         "Flow\ttotal\tmessages\t1\n"
+                         "Flow\ttotal\tfiles\t1\n"
+                         "Flow\ttotal\tbudgetsExceeded\t0\n"
+                         "Flow\ttotal\texecutionTimeMs\t6\n");
+  }
+
+  std::remove(filename.c_str());
+}
+
+TEST_CASE("Testing Task Scheduler", "[task-scheduler]") {
+  SECTION("Every task runs once whatever the thread count") {
+    for(const unsigned int threadCount : {1u, 3u, 16u}) {
+      Core::TaskScheduler scheduler(threadCount);
+      REQUIRE(scheduler.getThreadCount() == threadCount);
+      // The same threads run batch after batch, large or smaller than them
+      for(const std::size_t taskCount : {100u, 2u, 0u, 50u}) {
+        std::vector<std::atomic<int>> runs(taskCount);
+        for(auto& run : runs) {
+          run = 0;
+        }
+        scheduler.run(runs.size(), [&runs](std::size_t i) {
+          ++runs[i];
+        });
+        for(const auto& run : runs) {
+          REQUIRE(run == 1);
+        }
+      }
+    }
+  }
+
+  SECTION("Zero threads means one per core") {
+    REQUIRE(Core::TaskScheduler().getThreadCount() >= 1);
+  }
+
+  SECTION("The first exception is rethrown once every task ran") {
+    Core::TaskScheduler scheduler(4);
+    std::atomic<int> runs(0);
+    REQUIRE_THROWS_AS(scheduler.run(10, [&runs](std::size_t i) {
+      ++runs;
+      if(i == 3) {
+        throw std::runtime_error("task failed");
+      }
+    }), std::runtime_error);
+    REQUIRE(runs == 10);
+    scheduler.run(5, [&runs](std::size_t) {
+      ++runs;
+    });
+    REQUIRE(runs == 15);
+  }
 }
@@ -24,6 +24,12 @@
 #include "catch.hh"
 #include "utils.hpp"
 #include "syntax/rule.hpp"
+#include "syntax/pattern_set.hpp"
+#include "syntax/rule_registry.hpp"
+#include "core/budget.hpp"
+#include "core/baseline.hpp"
+#include <nlohmann/json.hpp>
+#include <fstream>
 
 Syntax::Rule RULE(RuleId ruleId, Syntax::RuleType rule, Core::ScopeType appliedTo, std::string parameter = ""){
   return Syntax::Rule(ruleId, appliedTo, rule, parameter);
@@ -607,3 +613,315 @@ TEST_CASE("Rule conflicts", "[rules-conflicts]") {
     
   }
 }
+
+TEST_CASE("Testing fused rule application", "[rules-engine]") {
+  std::vector<std::string> argv = {"program_name", "-q"};
+  SIFT sift;
+  sift.parseArgv(argv.size(), convert(argv).data());
+  sift.setupLogging();
+
+  const std::vector<std::string> source = {
+    "class lower {",
+    "  void Upper() {",
+    "    auto a = 2;",
+    "    goto end;",
+    "  }",
+    "};"
+  };
+
+  SECTION("Rules sharing a walk give the same messages as alone") {
+    std::map<RuleId, Syntax::Rule> rules = {
+      {1, RULE(1, Syntax::RuleType::StartWithUpperCase, Core::ScopeType::Class)},
+      {2, RULE(2, Syntax::RuleType::StartWithLowerCase, Core::ScopeType::Function)},
+      {3, RULE(3, Syntax::RuleType::NoAuto)},
+      {4, RULE(4, Syntax::RuleType::NoGoto)}
+    };
+
+    const auto fused = doTestWithSource(sift, rules, source).getMessages();
+    REQUIRE(fused.size() == 4);
+
+    for(const auto& rulePair : rules) {
+      SIFT siftAlone; // Message stacks are kept across clearState
+      siftAlone.parseArgv(argv.size(), convert(argv).data());
+      const auto alone = doTestWithSource(siftAlone, {rulePair}, source).getMessages();
+      REQUIRE(alone.at(rulePair.first).size() == fused.at(rulePair.first).size());
+      REQUIRE(alone.at(rulePair.first)[0].line == fused.at(rulePair.first)[0].line);
+    }
+  }
+
+  SECTION("Scopes are dispatched once per interested rule") {
+    Core::File file;
+    file.lines = source;
+    Core::Scope root(Core::ScopeType::Source);
+    root.file = &file;
+    root.children.emplace_back(Core::ScopeType::Class);
+    root.children.back().children.emplace_back(Core::ScopeType::ClassFunction);
+
+    unsigned int classVisits = 0, functionVisits = 0;
+    Syntax::ScopeRuleWork classRule, anyRule;
+    classRule.scopeTypes = Core::ScopeType::Class;
+    classRule.visit = [&classVisits](const Core::Scope&, const Core::KeywordHits&, Core::MessageStack&) { ++classVisits; };
+    anyRule.scopeTypes = Core::ScopeType::Class | Core::ScopeType::Function;
+    anyRule.visit = [&functionVisits](const Core::Scope&, const Core::KeywordHits&, Core::MessageStack&) { ++functionVisits; };
+
+    Core::MessageStack stack;
+    Syntax::runScopeRules(root, {std::cref(classRule), std::cref(anyRule)}, Core::KeywordHits(file), stack);
+    REQUIRE(classVisits == 1);
+    REQUIRE(functionVisits == 2);
+  }
+}
+
+TEST_CASE("Testing rule registry", "[rules-registry]") {
+  using Syntax::RuleType;
+
+  SECTION("Entries are indexed by rule type") {
+    for(const auto& type : Syntax::RuleType_list) {
+      REQUIRE(Syntax::getRuleDefinition(type).type == type);
+    }
+    REQUIRE(Syntax::RuleType_list.size() == Syntax::RuleTypeCount);
+  }
+
+  SECTION("Conflicts go both ways") {
+    REQUIRE(Syntax::areRulesInConflict(RuleType::StartWithX, RuleType::StartWithLowerCase));
+    REQUIRE(Syntax::areRulesInConflict(RuleType::StartWithLowerCase, RuleType::StartWithX));
+    REQUIRE(Syntax::areRulesInConflict(RuleType::CurlyBracketsOpenSameLine, RuleType::CurlyBracketsOpenSeparateLine));
+    REQUIRE_FALSE(Syntax::areRulesInConflict(RuleType::CurlyBracketsOpenSameLine, RuleType::CurlyBracketsCloseSeparateLine));
+    REQUIRE_FALSE(Syntax::areRulesInConflict(RuleType::NoGoto, RuleType::NoGoto));
+  }
+}
+
+TEST_CASE("Testing compiled rule plan", "[rules-plan]") {
+  std::vector<std::string> argv = {"program_name", "-q"};
+  SIFT sift;
+  sift.parseArgv(argv.size(), convert(argv).data());
+
+  SECTION("Duplicates are compiled once") {
+    sift.setupRules({
+      {1, RULE(1, Syntax::RuleType::NoGoto)},
+      {2, RULE(2, Syntax::RuleType::NoGoto)},
+      {3, RULE(3, Syntax::RuleType::NoGoto, Core::ScopeType::ClassFunction)},
+      {4, RULE(4, Syntax::RuleType::MaxCharactersPerLine, Core::ScopeType::All, "80")}
+    });
+    const auto& plan = sift.getRulePlan();
+    REQUIRE(plan.size() == 3);
+    REQUIRE(plan.getScopeRules().size() == 2);
+    REQUIRE(plan.getLineRules().size() == 1);
+    REQUIRE(plan.getFileRules().empty());
+  }
+
+  SECTION("Rules with an invalid parameter are left out") {
+    sift.setupRules({
+      {1, RULE(1, Syntax::RuleType::NameMaxCharacter, Core::ScopeType::All, "many")},
+      {2, RULE(2, Syntax::RuleType::Unknown)}
+    });
+    const auto& plan = sift.getRulePlan();
+    REQUIRE(plan.size() == 1);
+    REQUIRE(plan.getFileRules().size() == 1);
+    REQUIRE(plan.getFileRules()[0]->getRuleId() == 2);
+  }
+}
+
+TEST_CASE("Testing rule profiling", "[rules-profile]") {
+  std::vector<std::string> argv = {"program_name", "-q"};
+  SIFT sift;
+  sift.parseArgv(argv.size(), convert(argv).data());
+  sift.setupLogging();
+
+  const std::vector<std::string> source = {
+    "void f() {",
+    "  goto end;",
+    "  auto a = 2;",
+    "}"
+  };
+
+  SECTION("Profiling is off by default") {
+    REQUIRE(sift.getProfile() == nullptr);
+  }
+
+  SECTION("Work and messages are counted per rule type") {
+    sift.setProfileFilename("profile.json");
+    doTestWithSource(sift, {
+      {1, RULE(1, Syntax::RuleType::NoGoto)},
+      {2, RULE(2, Syntax::RuleType::MaxCharactersPerLine, Core::ScopeType::All, "80")}
+    }, source);
+
+    REQUIRE(sift.getProfile() != nullptr);
+    const auto json = nlohmann::json::parse(sift.getProfile()->toJson(PROFILE_TOP_COUNT));
+    const auto& syntax = json["syntax"];
+    REQUIRE(syntax["rules"]["NoGoto"]["messages"] == 1);
+    REQUIRE(syntax["rules"]["NoGoto"]["scopesVisited"] > 0);
+    REQUIRE(syntax["rules"]["MaxCharactersPerLine"]["linesScanned"] == source.size());
+    REQUIRE(syntax["total"]["messages"] == 1);
+    REQUIRE(json["extraction"]["total"]["linesScanned"] == source.size());
+    REQUIRE(json["extraction"]["total"]["regexEvaluations"] > 0);
+  }
+}
+
+TEST_CASE("Testing file budgets", "[rules-budget]") {
+  std::vector<std::string> argv = {"program_name", "-q"};
+  SIFT sift;
+  sift.parseArgv(argv.size(), convert(argv).data());
+  sift.setupLogging();
+
+  const std::vector<std::string> source = {
+    "void a() {",
+    "  goto end;",
+    "}",
+    "void b() {",
+    "  goto end;",
+    "}",
+    "void c() {",
+    "  goto end;",
+    "}",
+    "void d() {",
+    "  goto end;",
+    "}"
+  };
+  const std::map<RuleId, Syntax::Rule> rules = {{1, RULE(1, Syntax::RuleType::NoGoto)}};
+
+  SECTION("No limit by default") {
+    const auto& stack = doTestWithSource(sift, rules, source);
+    REQUIRE(stack.countMessages() == 4);
+    REQUIRE(sift.getBudgetsExceeded().empty());
+  }
+
+  SECTION("Rules stop once the file has too many messages") {
+    Core::FileBudgetLimits limits;
+    limits.messages = 1;
+    sift.setBudgetLimits(limits);
+    const auto& stack = doTestWithSource(sift, rules, source);
+    REQUIRE(stack.countMessages() == 2);
+    REQUIRE(sift.getBudgetsExceeded().count("dummy_filename") == 1);
+
+    sift.setBudgetLimits(Core::FileBudgetLimits());
+    doTestWithSource(sift, rules, source);
+    REQUIRE(sift.getBudgetsExceeded().empty());
+  }
+
+  SECTION("Budgets are shared by the tasks of a file") {
+    Core::FileBudget budget(std::chrono::milliseconds(0), 1);
+    Core::MessageStack first, second;
+    Core::Budgeting::Guard firstGuard(&budget, &first);
+    Core::Budgeting::Guard secondGuard(&budget, &second);
+    first.pushMessage(1, Core::MessageType::Error, "a", 0);
+    firstGuard.check();
+    second.pushMessage(1, Core::MessageType::Error, "b", 1);
+    REQUIRE_THROWS_AS(Core::Budgeting::checkpoint(), Core::BudgetExceeded);
+    REQUIRE(budget.isExceeded());
+    REQUIRE_THROWS_AS(firstGuard.check(), Core::BudgetExceeded);
+  }
+}
+
+TEST_CASE("Testing baselines", "[rules-baseline]") {
+  std::vector<std::string> argv = {"program_name", "-q"};
+  SIFT sift;
+  sift.parseArgv(argv.size(), convert(argv).data());
+  sift.setupLogging();
+
+  const std::map<RuleId, Syntax::Rule> rules = {{1, RULE(1, Syntax::RuleType::NoGoto)}};
+  const std::string filename = "baseline_test.txt";
+
+  SECTION("No baseline by default") {
+    REQUIRE(sift.getBaseline() == nullptr);
+    REQUIRE_FALSE(sift.loadBaseline("missing_baseline.txt"));
+    REQUIRE(sift.getBaseline() == nullptr);
+  }
+
+  SECTION("A corrupted baseline is not loaded") {
+    std::ofstream(filename) << "SIFTBASELINE 1\nnot-hex\n";
+    REQUIRE_FALSE(sift.loadBaseline(filename));
+    REQUIRE(sift.getBaseline() == nullptr);
+    std::remove(filename.c_str());
+  }
+
+  SECTION("Known violations are left out wherever they moved") {
+    sift.setWriteBaselineFilename(filename);
+    REQUIRE(doTestWithSource(sift, rules, std::vector<std::string>{"void a() {", "  goto end;", "}"}).countMessages() == 1);
+    sift.writeBaseline();
+
+    SIFT other;
+    other.parseArgv(argv.size(), convert(argv).data());
+    REQUIRE(other.loadBaseline(filename));
+    REQUIRE(other.getBaseline()->size() == 1);
+    const auto& stack = doTestWithSource(other, rules, std::vector<std::string>{
+      "void b() {",
+      "  goto start;",
+      "}",
+      "void a() {",
+      "  goto  end;",
+      "}"
+    });
+    REQUIRE(stack.countMessages() == 1);
+    REQUIRE(stack.getMessages().at(1)[0].sourceLine == 1);
+    REQUIRE(other.getBaseline()->getMatchCount() == 1);
+    std::remove(filename.c_str());
+  }
+
+  SECTION("Fingerprints ignore whitespace only") {
+    REQUIRE(Core::Baseline::hashText("goto end;") == Core::Baseline::hashText("  goto  end ;"));
+    REQUIRE(Core::Baseline::hashText("goto end;") != Core::Baseline::hashText("goto start;"));
+  }
+}
+
+TEST_CASE("Testing pattern rules", "[rules-pattern]") {
+  std::vector<std::string> argv = {"program_name", "-q"};
+  SIFT sift;
+  sift.parseArgv(argv.size(), convert(argv).data());
+  sift.setupLogging();
+
+  const std::vector<std::string> source = {
+    "// printf in a comment",
+    "void f() {",
+    "  printf(\"malloc in a literal\");",
+    "  char* p = (char*)malloc(10);",
+    "}",
+    "int printf_count = 0;"
+  };
+
+  SECTION("Required literals") {
+    using Syntax::PatternSet;
+    REQUIRE(PatternSet::findRequiredLiteral(R"(\bprintf\s*\()") == "printf");
+    REQUIRE(PatternSet::findRequiredLiteral(R"(std::endl)") == "std::endl");
+    REQUIRE(PatternSet::findRequiredLiteral(R"(colou?r)") == "colo");
+    REQUIRE(PatternSet::findRequiredLiteral(R"(a+bcd)") == "bcd");
+    REQUIRE(PatternSet::findRequiredLiteral(R"(x\.y[0-9]{2}zz)") == "x.y");
+    REQUIRE(PatternSet::findRequiredLiteral(R"(malloc|calloc)") == "");
+    REQUIRE(PatternSet::findRequiredLiteral(R"((malloc|calloc)\()") == "(");
+    REQUIRE(PatternSet::findRequiredLiteral(R"(.*)") == "");
+  }
+
+  SECTION("Only lines holding a literal are candidates") {
+    const Syntax::PatternSet patterns({R"(\bprintf\b)", R"(malloc\s*\()", R"(new|delete)"});
+    std::vector<std::size_t> candidates;
+    patterns.findCandidates("int a = 0;", candidates);
+    REQUIRE(candidates == std::vector<std::size_t>{2});
+    patterns.findCandidates("printf(\"%p\", malloc(1));", candidates);
+    REQUIRE(candidates == std::vector<std::size_t>({0, 1, 2}));
+  }
+
+  SECTION("Patterns are checked together on code only") {
+    const auto& stack = doTestWithSource(sift, {
+      {1, Syntax::Rule(1, Core::ScopeType::All, Syntax::RuleType::Pattern, R"(\bprintf\b)", "Use the logger")},
+      {2, Syntax::Rule(2, Core::ScopeType::Function, Syntax::RuleType::Pattern, R"(\bmalloc\s*\()", "Use new")},
+      {3, Syntax::Rule(3, Core::ScopeType::Class, Syntax::RuleType::Pattern, R"(malloc)", "Never reported")}
+    }, source);
+    REQUIRE(sift.getRulePlan().getLineRules().size() == 1);
+
+    const auto& messages = stack.getMessages();
+    REQUIRE(messages.at(1).size() == 1);
+    REQUIRE(messages.at(1)[0].line == 2);
+    REQUIRE(messages.at(2).size() == 1);
+    REQUIRE(messages.at(2)[0].line == 3);
+    REQUIRE(messages.count(3) == 0);
+  }
+
+  SECTION("Invalid patterns are left out") {
+    SIFT siftInvalid;
+    siftInvalid.parseArgv(argv.size(), convert(argv).data());
+    siftInvalid.setupRules({
+      {1, Syntax::Rule(1, Core::ScopeType::All, Syntax::RuleType::Pattern, "(unclosed", "Invalid")},
+      {2, Syntax::Rule(2, Core::ScopeType::All, Syntax::RuleType::Pattern, "", "Empty")}
+    });
+    REQUIRE(siftInvalid.getRulePlan().empty());
+  }
+}
@@ -25,6 +25,10 @@
 #include "utils.hpp"
 
 #include "core/scope.hpp"
+#include "core/scope_index.hpp"
+#include "core/scope_cache.hpp"
+#include "core/line_table.hpp"
+#include "core/keyword_hits.hpp"
 #include "core/cpp_scope_extractor.hpp"
 
 TEST_CASE("Scope Children", "[scope]") {
@@ -130,3 +134,229 @@ TEST_CASE("Scope Extraction", "[scope-extraction]") {
     REQUIRE(root.scope.children[1].isOfType(ScopeType::Variable));
   }
 }
+
+TEST_CASE("Scope Queries", "[scope-queries]") {
+  using namespace Core;
+  CppScopeExtractor extractor;
+  setupLoggingForTest();
+
+  const std::vector<std::string> content = {
+    "class TestCase {",
+    "  int a;",
+    "  void run() {",
+    "    if(a) {",
+    "    }",
+    "  }",
+    "};"
+  };
+
+  ScopeTestWrapper root(content);
+  REQUIRE(extractor.extractScopesFromFile(root.file, root.scope));
+  extractor.constructTree(root.scope);
+
+  SECTION("Children are returned by reference") {
+    const auto functions = root.scope.getAllChildrenOfType(ScopeType::Function);
+    REQUIRE(functions.size() == 1);
+    REQUIRE(&functions[0].get() == &root.scope.children[2]);
+  }
+
+  SECTION("Visiting children by type mask") {
+    unsigned int visited = 0;
+    root.scope.forEachChildOfType(ScopeType::Class | ScopeType::Conditional, [&visited](const Scope& scope) {
+      REQUIRE(scope.isOfType(ScopeType::Class | ScopeType::Conditional));
+      ++visited;
+    });
+    REQUIRE(visited == 2);
+  }
+
+  SECTION("Scope lines are views into the file") {
+    const Scope& conditional = root.scope.getAllChildrenOfType(ScopeType::Conditional)[0];
+    const auto lines = conditional.getScopeLines();
+    REQUIRE(lines.size() == 2);
+    REQUIRE(lines[0].str() == "if(a) {");
+    REQUIRE(lines[0].data() == root.file.lines[3].data() + 4);
+    REQUIRE(lines[1].str() == "    ");
+  }
+
+  SECTION("Type index built with the tree") {
+    REQUIRE(root.scope.typeIndex);
+    REQUIRE(root.scope.typeIndex->size() == root.scope.children.size());
+
+    const auto scopes = root.scope.getAllChildrenOfType(ScopeType::Conditional | ScopeType::Class | ScopeType::Function);
+    REQUIRE(scopes.size() == 3);
+    REQUIRE(scopes[0].get().isOfType(ScopeType::Class));
+    REQUIRE(scopes[1].get().isOfType(ScopeType::Function));
+    REQUIRE(scopes[2].get().isOfType(ScopeType::Conditional));
+    REQUIRE(root.scope.typeIndex->getScopesOfType(ScopeType::Enum).empty());
+  }
+
+  SECTION("Moving a tree keeps parent links") {
+    Scope moved = std::move(root.scope);
+    REQUIRE(moved.children[0].parent == &moved);
+    for(const auto& child : moved.children) {
+      REQUIRE(child.parent != &root.scope);
+    }
+    REQUIRE(moved.getAllChildrenOfType(ScopeType::Function).size() == 1);
+  }
+}
+
+TEST_CASE("Scope Cache", "[scope-cache]") {
+  using namespace Core;
+  CppScopeExtractor extractor;
+  setupLoggingForTest();
+
+  const std::vector<std::string> content = {
+    "#define VALUE 2",
+    "// Comment",
+    "class TestCase {",
+    "  void run() {",
+    "    if(a) { const char* s = \"text\"; }",
+    "  }",
+    "};"
+  };
+
+  ScopeTestWrapper extracted(content);
+  extracted.file.filename = "cached_filename";
+  REQUIRE(extractor.extractScopesFromFile(extracted.file, extracted.scope));
+  extractor.constructTree(extracted.scope);
+
+  REQUIRE(createDirectory("temp-scope-cache"));
+  ScopeCache cache("temp-scope-cache");
+  REQUIRE(cache.store(extracted.file, extracted.scope,
+                      extractor.getStringLiterals().at("cached_filename"),
+                      extractor.getComments().at("cached_filename"),
+                      extractor.getDefines().at("cached_filename")));
+
+  ScopeTestWrapper loaded(content);
+  loaded.file.filename = "cached_filename";
+  std::vector<Scope> stringLiterals, comments, defines;
+
+  SECTION("Restores the constructed tree") {
+    REQUIRE(cache.load(loaded.file, loaded.scope, stringLiterals, comments, defines));
+    REQUIRE(loaded.scope.name == "cached_filename");
+    REQUIRE(loaded.scope.typeIndex);
+    REQUIRE(loaded.scope.children.size() == extracted.scope.children.size());
+
+    for(unsigned int i = 0; i < extracted.scope.children.size(); ++i) {
+      const Scope& expected = extracted.scope.children[i];
+      const Scope& actual = loaded.scope.children[i];
+      REQUIRE(actual == expected);
+      REQUIRE(actual.type == expected.type);
+      REQUIRE(actual.name == expected.name);
+      REQUIRE(actual.file == &loaded.file);
+      REQUIRE(actual.getDepth() == expected.getDepth());
+    }
+    REQUIRE(loaded.scope.getAllChildrenOfType(ScopeType::Function).size() == 1);
+  }
+
+  SECTION("Restores literal, comment and define spans") {
+    REQUIRE(cache.load(loaded.file, loaded.scope, stringLiterals, comments, defines));
+    REQUIRE(stringLiterals.size() == 1);
+    REQUIRE(stringLiterals[0] == extractor.getStringLiterals().at("cached_filename")[0]);
+    REQUIRE(comments.size() == 1);
+    REQUIRE(comments[0].isOfType(ScopeType::SingleLineComment));
+    REQUIRE(defines.size() == 1);
+    REQUIRE(defines[0].lineNumberStart == 0);
+  }
+
+  SECTION("Changed content misses the cache") {
+    loaded.file.lines[0] = "#define VALUE 3";
+    REQUIRE_FALSE(cache.load(loaded.file, loaded.scope, stringLiterals, comments, defines));
+  }
+}
+
+TEST_CASE("Line Table", "[line-table]") {
+  using namespace Core;
+  CppScopeExtractor extractor;
+  setupLoggingForTest();
+
+  const std::vector<std::string> content = {
+    "#include <vector>",
+    "",
+    "\t  int a; /* trailing */",
+    "  // comment",
+    "\tint f() {",
+    "\t}"
+  };
+
+  ScopeTestWrapper root(content);
+  root.file.filename = "line_table_filename";
+  REQUIRE(extractor.extractScopesFromFile(root.file, root.scope));
+  extractor.constructTree(root.scope);
+
+  const LineTable table(root.file, root.scope);
+  REQUIRE(table.size() == content.size());
+
+  SECTION("Describes every line") {
+    REQUIRE(table[0].has(LineInfo::Preprocessor));
+    REQUIRE(table[1].has(LineInfo::Blank));
+    REQUIRE(table[2].indentation == LineInfo::Indentation::Mixed);
+    REQUIRE(table[2].leadingTabs == 1);
+    REQUIRE(table[2].indentWidth == 3);
+    REQUIRE(table[2].length == content[2].size());
+    REQUIRE(table[3].has(LineInfo::CommentOnly));
+    REQUIRE(table[3].firstNonSpace == 2);
+    REQUIRE(table[4].indentation == LineInfo::Indentation::Tabs);
+    REQUIRE(table[4].has(LineInfo::OpenBrace));
+    REQUIRE(table[5].has(LineInfo::CloseBrace));
+  }
+
+  SECTION("Indexes comments by line") {
+    REQUIRE(table.getComments().size() == 2);
+    REQUIRE(table[2].has(LineInfo::WithinComment));
+    REQUIRE(table[3].has(LineInfo::WithinComment));
+    REQUIRE_FALSE(table[4].has(LineInfo::WithinComment));
+
+    Scope inComment;
+    inComment.lineNumberStart = inComment.lineNumberEnd = 3;
+    inComment.characterNumberStart = inComment.characterNumberEnd = 6;
+    REQUIRE(table.findFirstCommentHolding(inComment) == 1);
+    REQUIRE(table.countCommentsHolding(inComment) == 1);
+
+    Scope outOfComment;
+    outOfComment.lineNumberStart = outOfComment.lineNumberEnd = 2;
+    outOfComment.characterNumberStart = outOfComment.characterNumberEnd = 4;
+    REQUIRE(table.findFirstCommentHolding(outOfComment) == table.getComments().size());
+    REQUIRE(table.countCommentsHolding(outOfComment) == 0);
+  }
+}
+
+TEST_CASE("Keyword Hits", "[keyword-hits]") {
+  using namespace Core;
+
+  File file;
+  file.lines = {
+    "#include <vector>",
+    "auto x = const_cast<int*>(p); // goto",
+    "int automatic = 0;",
+    "#define A 1",
+    "",
+    "#include \"own.hpp\""
+  };
+  const KeywordHits hits(file);
+
+  SECTION("Records every line holding a keyword once") {
+    REQUIRE(hits.getLines(Keyword::Include) == std::vector<unsigned int>({0, 5}));
+    REQUIRE(hits.getLines(Keyword::Auto) == std::vector<unsigned int>({1, 2}));
+    REQUIRE(hits.getLines(Keyword::ConstCast) == std::vector<unsigned int>({1}));
+    REQUIRE(hits.getLines(Keyword::Goto) == std::vector<unsigned int>({1}));
+    REQUIRE(hits.getLines(Keyword::Define) == std::vector<unsigned int>({3}));
+  }
+
+  SECTION("Narrows to a range of lines") {
+    const auto range = hits.getLines(Keyword::Auto, 2, 4);
+    REQUIRE(std::distance(range.first, range.second) == 1);
+    REQUIRE(*range.first == 2);
+    const auto none = hits.getLines(Keyword::Include, 1, 4);
+    REQUIRE(none.first == none.second);
+  }
+
+  SECTION("Tells which keywords are missing") {
+    File plain;
+    plain.lines = {"int main() { return 0; }"};
+    const KeywordHits plainHits(plain);
+    REQUIRE_FALSE(plainHits.has(Keyword::Goto));
+    REQUIRE_FALSE(plainHits.has(Keyword::Include));
+    REQUIRE(plainHits.has(Keyword::None));
+  }
+}
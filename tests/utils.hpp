@@ -23,7 +23,7 @@ inline std::vector<char*> convert(std::vector<std::string>& base)
 }
 
 // Execute a unit test with the source filename and the .json rules file
-inline const Core::MessageStack doTestWithFile(SIFT& pfe, const std::string rulesFile, const std::string sourceFile)
+inline const Core::MessageStack& doTestWithFile(SIFT& pfe, const std::string rulesFile, const std::string sourceFile)
 {
   pfe.clearState();
   pfe.setupRules(rulesFile);
@@ -35,7 +35,7 @@ inline const Core::MessageStack doTestWithFile(SIFT& pfe, const std::string rule
 }
 
 // Execute a unit test with the source filename and the rules as a map
-inline const Core::MessageStack doTestWithFile(SIFT& pfe, std::map<RuleId, Syntax::Rule> rules, const std::string& sourceFile)
+inline const Core::MessageStack& doTestWithFile(SIFT& pfe, std::map<RuleId, Syntax::Rule> rules, const std::string& sourceFile)
 {
   pfe.clearState();
   pfe.setupRules(rules);
@@ -47,7 +47,7 @@ inline const Core::MessageStack doTestWithFile(SIFT& pfe, std::map<RuleId, Synta
 }
 
 // Execute a unit test with the source passed in as a vector of strings and the rules as a map
-inline const Core::MessageStack doTestWithSource(SIFT& pfe, std::map<RuleId, Syntax::Rule> rules, const std::vector<std::string>& source)
+inline const Core::MessageStack& doTestWithSource(SIFT& pfe, std::map<RuleId, Syntax::Rule> rules, const std::vector<std::string>& source)
 {
   pfe.clearState();
   pfe.setupRules(rules);
@@ -59,7 +59,7 @@ inline const Core::MessageStack doTestWithSource(SIFT& pfe, std::map<RuleId, Syn
 }
 
 // Test a single line of code
-inline const Core::MessageStack doTestWithSource(SIFT& pfe, std::map<RuleId, Syntax::Rule> rules, const std::string& sourceLine){
+inline const Core::MessageStack& doTestWithSource(SIFT& pfe, std::map<RuleId, Syntax::Rule> rules, const std::string& sourceLine){
   std::vector<std::string> source = {sourceLine};
   return doTestWithSource(pfe, rules, source);
 }